@@ -0,0 +1,366 @@
+#include "FIXAcceptor.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <iostream>
+
+namespace {
+    // epoll user data: 0 is the listening socket, 1 the wake-up eventfd,
+    // anything else is a session id offset by sessionTagBase
+    constexpr uint64_t listenTag = 0;
+    constexpr uint64_t wakeTag = 1;
+    constexpr uint64_t sessionTagBase = 2;
+    constexpr int maxEvents = 256;
+    constexpr size_t readChunk = 64 * 1024;
+    constexpr size_t matchingBatch = 256;
+    constexpr size_t sessionQueueCapacity = 4096;
+}
+
+FIXAcceptor::FIXAcceptor(FIXEngine* _engine, uint16_t _port, int ioThreadCount,
+                         size_t _maxSessions, size_t queueCapacity)
+    : engine(_engine), port(_port), maxSessions(_maxSessions),
+      sessions(new std::unique_ptr<Session>[_maxSessions]), freeSessionIds(_maxSessions), inbound(queueCapacity) {
+    if (ioThreadCount < 1) ioThreadCount = 1;
+    for (int i = 0; i < ioThreadCount; ++i) {
+        // Every session is queued for flushing at most once at a time, and
+        // released at most once
+        ioThreads.push_back(std::make_unique<IOThread>(2 * maxSessions));
+    }
+    pendingWake.assign(ioThreads.size(), 0);
+
+    // Fills against resting orders report to the resting order's session
+    engine->setReportSink([this](int sessionId, std::string_view report) {
+        deliver(sessionId, std::string(report));
+    });
+}
+
+FIXAcceptor::~FIXAcceptor() {
+    stop();
+}
+
+bool FIXAcceptor::start() {
+    if (running.load()) return true;
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "FIXAcceptor: socket() failed: " << errno << std::endl;
+        return false;
+    }
+    int enable = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0) {
+        std::cerr << "FIXAcceptor: cannot listen on port " << port << ": " << errno << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    socklen_t addrLen = sizeof(addr);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &addrLen);
+    port = ntohs(addr.sin_port);
+
+    for (size_t i = 0; i < ioThreads.size(); ++i) {
+        IOThread& io = *ioThreads[i];
+        io.epollFd = epoll_create1(EPOLL_CLOEXEC);
+        io.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = wakeTag;
+        epoll_ctl(io.epollFd, EPOLL_CTL_ADD, io.wakeFd, &ev);
+
+        if (i == 0) {
+            ev.data.u64 = listenTag;
+            epoll_ctl(io.epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+        }
+    }
+
+    running.store(true);
+    matchingThread = std::thread(&FIXAcceptor::runMatchingThread, this);
+    for (size_t i = 0; i < ioThreads.size(); ++i) {
+        ioThreads[i]->thread = std::thread(&FIXAcceptor::runIOThread, this, static_cast<int>(i));
+    }
+    return true;
+}
+
+void FIXAcceptor::stop() {
+    if (!running.exchange(false)) return;
+
+    for (auto& io : ioThreads) wake(*io);
+    for (auto& io : ioThreads) {
+        if (io->thread.joinable()) io->thread.join();
+    }
+    if (matchingThread.joinable()) matchingThread.join();
+
+    for (size_t i = 0; i < maxSessions; ++i) {
+        Session* session = sessions[i].get();
+        if (session && !session->closed.load()) {
+            close(session->fd);
+            session->closed.store(true);
+        }
+    }
+    sessionCount.store(0);
+
+    for (auto& io : ioThreads) {
+        close(io->epollFd);
+        close(io->wakeFd);
+        io->epollFd = io->wakeFd = -1;
+    }
+    close(listenFd);
+    listenFd = -1;
+}
+
+void FIXAcceptor::wake(IOThread& io) {
+    uint64_t one = 1;
+    ssize_t ignored = write(io.wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void FIXAcceptor::runIOThread(int index) {
+    IOThread& io = *ioThreads[index];
+    epoll_event events[maxEvents];
+
+    while (running.load(std::memory_order_relaxed)) {
+        int n = epoll_wait(io.epollFd, events, maxEvents, 100);
+        for (int i = 0; i < n; ++i) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == listenTag) {
+                acceptConnections();
+            } else if (tag == wakeTag) {
+                uint64_t count;
+                ssize_t ignored = read(io.wakeFd, &count, sizeof(count));
+                (void)ignored;
+                int sessionId;
+                while (io.flushQueue.tryPop(sessionId)) {
+                    if (sessionId < 0) {
+                        // Queued after every flush of that session, so nothing
+                        // refers to its slot any more
+                        freeSessionIds.tryPush(-1 - sessionId);
+                        continue;
+                    }
+                    flushSession(io, *sessions[sessionId]);
+                }
+            } else {
+                Session& session = *sessions[tag - sessionTagBase];
+                if (session.closed.load(std::memory_order_relaxed)) continue;
+
+                uint32_t flags = events[i].events;
+                if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    readSession(io, session);
+                }
+                if ((flags & EPOLLOUT) && !session.closed.load(std::memory_order_relaxed)) {
+                    flushSession(io, session);
+                }
+            }
+        }
+    }
+}
+
+void FIXAcceptor::acceptConnections() {
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN or transient error, wait for the next event
+
+        int id;
+        if (!freeSessionIds.tryPop(id)) {
+            if (nextSessionId >= maxSessions) {
+                std::cerr << "FIXAcceptor: session limit reached, refusing connection" << std::endl;
+                close(fd);
+                continue;
+            }
+            id = static_cast<int>(nextSessionId++);
+        }
+
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        int ioIndex = nextIOThread;
+        nextIOThread = (nextIOThread + 1) % static_cast<int>(ioThreads.size());
+
+        sessions[id] = std::make_unique<Session>(fd, id, ioIndex, sessionQueueCapacity);
+        sessionCount.fetch_add(1, std::memory_order_relaxed);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = sessionTagBase + static_cast<uint64_t>(id);
+        epoll_ctl(ioThreads[ioIndex]->epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void FIXAcceptor::readSession(IOThread& io, Session& session) {
+    char buffer[readChunk];
+    bool peerClosed = false;
+    for (;;) {
+        ssize_t received = recv(session.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            session.inBuffer.append(buffer, static_cast<size_t>(received));
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (received < 0 && errno == EINTR) continue;
+        peerClosed = true;  // orderly shutdown or hard error
+        break;
+    }
+
+    // Frame and decode on this thread so the matching thread only matches
+    size_t offset = 0;
+    for (;;) {
+        std::string_view pending(session.inBuffer.data() + offset, session.inBuffer.size() - offset);
+        size_t length = FIXMessage::frameLength(pending);
+        if (length == 0) break;
+        if (length == std::string::npos) {
+            std::cerr << "FIXAcceptor: malformed frame on session " << session.id << std::endl;
+            closeSession(io, session);
+            return;
+        }
+
+        Inbound item;
+        item.sessionId = session.id;
+        item.msg.parse(pending.substr(0, length));
+        offset += length;
+
+        while (!inbound.tryPush(std::move(item))) {
+            if (!running.load(std::memory_order_relaxed)) return;
+            std::this_thread::yield();
+        }
+    }
+    session.inBuffer.erase(0, offset);
+
+    if (peerClosed) closeSession(io, session);
+}
+
+void FIXAcceptor::flushSession(IOThread& io, Session& session) {
+    // Clear the flag before draining: a report pushed after this point either
+    // gets drained below or schedules another flush
+    session.flushScheduled.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::string report;
+    while (session.outbound.tryPop(report)) {
+        session.outBuffer += report;
+    }
+    if (session.closed.load(std::memory_order_relaxed)) {
+        session.outBuffer.clear();
+        return;
+    }
+
+    size_t sent = 0;
+    while (sent < session.outBuffer.size()) {
+        ssize_t n = send(session.fd, session.outBuffer.data() + sent,
+                         session.outBuffer.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            closeSession(io, session);
+            return;
+        }
+    }
+    session.outBuffer.erase(0, sent);
+
+    // Only ask for EPOLLOUT while the socket is backed up
+    bool backedUp = !session.outBuffer.empty();
+    if (backedUp != session.waitingForWritable) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        if (backedUp) ev.events |= EPOLLOUT;
+        ev.data.u64 = sessionTagBase + static_cast<uint64_t>(session.id);
+        epoll_ctl(io.epollFd, EPOLL_CTL_MOD, session.fd, &ev);
+        session.waitingForWritable = backedUp;
+    }
+}
+
+void FIXAcceptor::closeSession(IOThread& io, Session& session) {
+    if (session.closed.exchange(true)) return;
+    epoll_ctl(io.epollFd, EPOLL_CTL_DEL, session.fd, nullptr);
+    close(session.fd);
+    session.inBuffer.clear();
+    session.outBuffer.clear();
+    sessionCount.fetch_sub(1, std::memory_order_relaxed);
+
+    // Behind the session's last message, so the matching thread lets go of
+    // the slot only once it is done with the session
+    Inbound marker;
+    marker.sessionId = session.id;
+    marker.closed = true;
+    while (!inbound.tryPush(std::move(marker))) {
+        if (!running.load(std::memory_order_relaxed)) return;
+        std::this_thread::yield();
+    }
+}
+
+void FIXAcceptor::releaseSession(int sessionId) {
+    engine->resetSession(sessionId);
+    // Back through the owning I/O thread's flush queue, behind any flush
+    // still queued for the session; that thread then frees the slot
+    int ioThread = sessions[sessionId]->ioThread;
+    ioThreads[ioThread]->flushQueue.tryPush(-1 - sessionId);
+    pendingWake[ioThread] = 1;
+}
+
+void FIXAcceptor::deliver(int sessionId, std::string&& report) {
+    if (sessionId < 0 || static_cast<size_t>(sessionId) >= maxSessions || !sessions[sessionId]) return;
+    Session& session = *sessions[sessionId];
+    if (report.empty() || session.closed.load(std::memory_order_relaxed)) return;
+
+    while (!session.outbound.tryPush(std::move(report))) {
+        if (!running.load(std::memory_order_relaxed) || session.closed.load()) return;
+        std::this_thread::yield();
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!session.flushScheduled.exchange(true)) {
+        ioThreads[session.ioThread]->flushQueue.tryPush(session.id);
+        pendingWake[session.ioThread] = 1;
+    }
+}
+
+void FIXAcceptor::runMatchingThread() {
+    Inbound item;
+
+    while (running.load(std::memory_order_relaxed)) {
+        size_t processed = 0;
+        while (processed < matchingBatch && inbound.tryPop(item)) {
+            if (item.closed) {
+                releaseSession(item.sessionId);
+                continue;
+            }
+            ++processed;
+            std::string report;
+            try {
+                report = engine->processMessage(item.msg, item.sessionId);
+            } catch (const std::exception& e) {
+                std::cerr << "FIXAcceptor: engine error on session " << item.sessionId
+                          << ": " << e.what() << std::endl;
+                continue;
+            }
+            deliver(item.sessionId, std::move(report));
+        }
+        messagesProcessed.fetch_add(processed, std::memory_order_relaxed);
+
+        // One wake-up per I/O thread per batch rather than per report
+        for (size_t i = 0; i < pendingWake.size(); ++i) {
+            if (pendingWake[i]) {
+                wake(*ioThreads[i]);
+                pendingWake[i] = 0;
+            }
+        }
+        if (processed == 0) std::this_thread::yield();
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef FIXACCEPTOR_HPP
+#define FIXACCEPTOR_HPP
+
+#include "FIXEngine.hpp"
+#include "FIXMessage.hpp"
+#include "../Matching_Engine/MPSCQueue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// TCP acceptor for many concurrent FIX sessions (Linux, epoll).
+//
+// I/O threads own the sockets: they read, frame and decode inbound messages
+// and push them into one lock-free MPSC queue. A single matching thread is the
+// only caller of the FIXEngine (and therefore of the Book) and hands every
+// execution report to the I/O thread that owns the session it belongs to,
+// including fills on resting orders entered by other sessions.
+class FIXAcceptor {
+public:
+    FIXAcceptor(FIXEngine* engine, uint16_t port, int ioThreadCount = 2,
+                size_t maxSessions = 1024, size_t queueCapacity = 1 << 16);
+    ~FIXAcceptor();
+
+    FIXAcceptor(const FIXAcceptor&) = delete;
+    FIXAcceptor& operator=(const FIXAcceptor&) = delete;
+
+    // Bind, listen and spawn the I/O and matching threads
+    bool start();
+    void stop();
+
+    // Bound port (useful when constructed with port 0)
+    uint16_t getPort() const { return port; }
+    size_t getSessionCount() const { return sessionCount.load(std::memory_order_relaxed); }
+    uint64_t getMessagesProcessed() const { return messagesProcessed.load(std::memory_order_relaxed); }
+
+private:
+    struct Session {
+        int fd;
+        int id;
+        int ioThread;
+        std::string inBuffer;
+        std::string outBuffer;
+        bool waitingForWritable = false;
+        std::atomic<bool> closed{false};
+        std::atomic<bool> flushScheduled{false};
+        MPSCQueue<std::string> outbound;
+
+        Session(int _fd, int _id, int _ioThread, size_t capacity)
+            : fd(_fd), id(_id), ioThread(_ioThread), outbound(capacity) {}
+    };
+
+    struct Inbound {
+        int sessionId = -1;
+        bool closed = false;  // no message: the session closed after its last one
+        FIXMessage msg;
+    };
+
+    struct IOThread {
+        int epollFd = -1;
+        int wakeFd = -1;
+        std::thread thread;
+        // Sessions with reports waiting to be sent, and (as -1 - id) closed
+        // sessions whose slot the matching thread has let go of
+        MPSCQueue<int> flushQueue;
+
+        explicit IOThread(size_t capacity) : flushQueue(capacity) {}
+    };
+
+    FIXEngine* engine;
+    uint16_t port;
+    int listenFd = -1;
+    size_t maxSessions;
+
+    std::vector<std::unique_ptr<IOThread>> ioThreads;
+    std::unique_ptr<std::unique_ptr<Session>[]> sessions;
+    std::atomic<size_t> sessionCount{0};
+    size_t nextSessionId = 0;  // first slot never used yet
+    MPSCQueue<int> freeSessionIds;  // closed slots ready for reuse
+    int nextIOThread = 0;
+
+    MPSCQueue<Inbound> inbound;
+    std::thread matchingThread;
+    std::vector<char> pendingWake;  // matching thread only: I/O threads to wake
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> messagesProcessed{0};
+
+    void runIOThread(int index);
+    void runMatchingThread();
+    void deliver(int sessionId, std::string&& report);
+
+    void acceptConnections();
+    void readSession(IOThread& io, Session& session);
+    void flushSession(IOThread& io, Session& session);
+    void closeSession(IOThread& io, Session& session);
+    void releaseSession(int sessionId);
+    void wake(IOThread& io);
+};
+
+#endif
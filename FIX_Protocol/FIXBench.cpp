@@ -0,0 +1,206 @@
+#include "FIXEngine.hpp"
+#include "FIXMessage.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Throughput and latency benchmark for the FIX layer.
+// Usage: FIXBench [messages] [seed]
+//
+// Generates a realistic NewOrderSingle / OrderCancelRequest /
+// OrderCancelReplaceRequest flow against live ClOrdIDs, then times encoding,
+// parsing and engine handling separately, one message at a time.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        char msgType;
+        char side;
+        char ordType;
+        int clOrdID;
+        int origClOrdID;
+        int qty;
+        int price;
+    };
+
+    std::vector<Request> generateFlow(size_t count, std::mt19937& gen) {
+        std::uniform_int_distribution<> percent(0, 99);
+        std::uniform_int_distribution<> offsetDist(0, 9);
+        std::uniform_int_distribution<> qtyDist(1, 100);
+
+        std::vector<Request> flow;
+        flow.reserve(count);
+        std::vector<int> live;
+        int nextClOrdID = 1;
+
+        while (flow.size() < count) {
+            int roll = percent(gen);
+            bool buy = percent(gen) < 50;
+            char side = buy ? FIXMessage::Buy : FIXMessage::Sell;
+
+            if (roll < 60 || live.empty()) {
+                // 5% market orders, the rest limits in overlapping bands
+                char ordType = roll < 3 ? FIXMessage::Market : FIXMessage::Limit;
+                int price = buy ? 95 + offsetDist(gen) : 96 + offsetDist(gen);
+                flow.push_back(Request{FIXMessage::NewOrderSingle, side, ordType,
+                                       nextClOrdID, 0, qtyDist(gen), price});
+                if (ordType == FIXMessage::Limit) live.push_back(nextClOrdID);
+                ++nextClOrdID;
+                continue;
+            }
+
+            std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+            size_t index = pick(gen);
+            int origClOrdID = live[index];
+            if (roll < 85) {
+                flow.push_back(Request{FIXMessage::OrderCancelRequest, side, FIXMessage::Limit,
+                                       nextClOrdID++, origClOrdID, 0, 0});
+                live[index] = live.back();
+                live.pop_back();
+            } else {
+                int price = buy ? 95 + offsetDist(gen) : 96 + offsetDist(gen);
+                flow.push_back(Request{FIXMessage::OrderCancelReplaceRequest, side, FIXMessage::Limit,
+                                       nextClOrdID, origClOrdID, qtyDist(gen), price});
+                live[index] = nextClOrdID++;
+            }
+        }
+        return flow;
+    }
+
+    void setClOrdID(FIXMessage& msg, int tag, int id) {
+        char buffer[16] = {'C', '-'};
+        auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer), id);
+        msg.setField(tag, std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+    }
+
+    void buildMessage(FIXMessage& msg, const Request& request, int seqNum) {
+        msg.clear();
+        msg.setField(FIXMessage::BeginString, "FIX.4.2");
+        msg.setMsgType(request.msgType);
+        msg.setField(FIXMessage::SenderCompID, "BENCH");
+        msg.setField(FIXMessage::TargetCompID, "SERVER");
+        msg.setField(FIXMessage::MsgSeqNum, seqNum);
+        setClOrdID(msg, FIXMessage::ClOrdID, request.clOrdID);
+        if (request.msgType != FIXMessage::NewOrderSingle) {
+            setClOrdID(msg, FIXMessage::OrigClOrdID, request.origClOrdID);
+        }
+        msg.setField(FIXMessage::Symbol, "AAPL");
+        msg.setField(FIXMessage::Side, request.side);
+        if (request.msgType != FIXMessage::OrderCancelRequest) {
+            msg.setField(FIXMessage::OrderQty, request.qty);
+            msg.setField(FIXMessage::OrdType, request.ordType);
+            if (request.ordType != FIXMessage::Market) {
+                msg.setField(FIXMessage::Price, static_cast<double>(request.price));
+            }
+        }
+    }
+
+    double percentile(const std::vector<uint32_t>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        return sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1))];
+    }
+
+    void printStage(const char* name, std::vector<uint32_t>& latencies, double seconds) {
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << std::left << std::setw(8) << name << std::right
+                  << std::setw(12) << static_cast<uint64_t>(latencies.size() / seconds) << " msg/s"
+                  << "   p50 " << std::setw(6) << percentile(latencies, 0.50)
+                  << "  p99 " << std::setw(6) << percentile(latencies, 0.99)
+                  << "  p99.9 " << std::setw(6) << percentile(latencies, 0.999)
+                  << "  max " << std::setw(8) << (latencies.empty() ? 0 : latencies.back())
+                  << " ns" << std::endl;
+    }
+
+    uint32_t elapsedNanos(Clock::time_point start, Clock::time_point end) {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 1000000;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 42;
+
+    std::mt19937 gen(seed);
+    std::vector<Request> flow = generateFlow(count, gen);
+
+    std::vector<uint32_t> latencies;
+    latencies.reserve(count);
+    FIXMessage msg;
+
+    // Encode: build each message in a reused FIXMessage and append it to the wire
+    std::string wire;
+    wire.reserve(count * 128);
+    std::vector<size_t> offsets;
+    offsets.reserve(count + 1);
+    auto stageStart = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        offsets.push_back(wire.size());
+        auto start = Clock::now();
+        buildMessage(msg, flow[i], static_cast<int>(i + 1));
+        msg.encodeTo(wire);
+        latencies.push_back(elapsedNanos(start, Clock::now()));
+    }
+    offsets.push_back(wire.size());
+    double encodeSeconds = std::chrono::duration<double>(Clock::now() - stageStart).count();
+
+    std::cout << count << " messages, " << wire.size() / count << " bytes average" << std::endl;
+    printStage("encode", latencies, encodeSeconds);
+
+    // Parse: decode every frame into a reused FIXMessage
+    std::string_view stream(wire);
+    latencies.clear();
+    stageStart = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        auto start = Clock::now();
+        msg.parse(stream.substr(offsets[i], offsets[i + 1] - offsets[i]));
+        latencies.push_back(elapsedNanos(start, Clock::now()));
+    }
+    printStage("parse", latencies, std::chrono::duration<double>(Clock::now() - stageStart).count());
+
+    // Engine: decoded message in, encoded reports out (parsing not timed)
+    {
+        Book book;
+        FIXEngine engine(&book);
+        std::string output;
+        latencies.clear();
+        double engineSeconds = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            msg.parse(stream.substr(offsets[i], offsets[i + 1] - offsets[i]));
+            output.clear();
+            auto start = Clock::now();
+            engine.processMessage(msg, output);
+            auto end = Clock::now();
+            latencies.push_back(elapsedNanos(start, end));
+            engineSeconds += std::chrono::duration<double>(end - start).count();
+        }
+        printStage("engine", latencies, engineSeconds);
+    }
+
+    // End to end: the whole wire through processBatch on a fresh book
+    {
+        Book book;
+        FIXEngine engine(&book);
+        std::string output;
+        output.reserve(wire.size() * 3);
+        auto start = Clock::now();
+        size_t consumed = engine.processBatch(wire, output);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (consumed != wire.size()) {
+            std::cerr << "processBatch stopped at byte " << consumed << std::endl;
+            return 1;
+        }
+        std::cout << std::left << std::setw(8) << "batch" << std::right
+                  << std::setw(12) << static_cast<uint64_t>(count / seconds) << " msg/s   "
+                  << output.size() / count << " report bytes per message" << std::endl;
+    }
+    return 0;
+}
@@ -3,7 +3,7 @@
 #include <iostream>
 #include <string>
 
-void printFIXMessage(const std::string& label, const std::string& fixMsg) {
+void printSingleFIXMessage(const std::string& label, const std::string& fixMsg) {
     std::cout << "\n" << label << ":\n";
     std::cout << "Raw: ";
     for (char c : fixMsg) {
@@ -39,10 +39,24 @@ void printFIXMessage(const std::string& label, const std::string& fixMsg) {
         }
         std::cout << "  ExecType: " << execTypeStr << "\n";
     }
+    if (msg.hasField(FIXMessage::LastShares))
+        std::cout << "  LastShares: " << msg.getField(FIXMessage::LastShares)
+                  << " @ " << msg.getField(FIXMessage::LastPx) << "\n";
     if (msg.hasField(FIXMessage::Text))
         std::cout << "  Text: " << msg.getField(FIXMessage::Text) << "\n";
 }
 
+// A response can carry several reports (ack, fills, ...), print each one
+void printFIXMessage(const std::string& label, const std::string& fixMsg) {
+    std::string_view pending(fixMsg);
+    size_t length;
+    while ((length = FIXMessage::frameLength(pending)) != 0 && length != std::string::npos) {
+        printSingleFIXMessage(label, std::string(pending.substr(0, length)));
+        pending.remove_prefix(length);
+    }
+    if (!pending.empty()) printSingleFIXMessage(label, std::string(pending));
+}
+
 void runFIXDemo() {
     std::cout << "=== FIX Protocol Demo ===" << std::endl;
     
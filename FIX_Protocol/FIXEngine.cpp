@@ -4,147 +4,399 @@
 #include <iomanip>
 
 FIXEngine::FIXEngine(Book* _book) 
-    : book(_book), senderCompID("SERVER"), targetCompID("CLIENT"), msgSeqNum(1) {
+    : singleBook(_book), ownedSymbols(std::make_unique<BookManager>()),
+      senderCompID("SERVER"), targetCompID("CLIENT"), msgSeqNum(1) {
+    books = ownedSymbols.get();
+    orders.push_back(OrderInfo{-1, -1, 0, '\0', '\0', 0, 0, 0, ""});  // order ids start at 1
 }
 
-std::string FIXEngine::processMessage(const std::string& rawMessage) {
-    FIXMessage msg(rawMessage);
-    
+FIXEngine::FIXEngine(BookManager* _books)
+    : books(_books), senderCompID("SERVER"), targetCompID("CLIENT"), msgSeqNum(1) {
+    orders.push_back(OrderInfo{-1, -1, 0, '\0', '\0', 0, 0, 0, ""});
+}
+
+std::string FIXEngine::processMessage(const std::string& rawMessage, int sessionId) {
+    std::string output;
+    inbound.parse(rawMessage);
+    processMessage(inbound, output, sessionId);
+    return output;
+}
+
+std::string FIXEngine::processMessage(const FIXMessage& msg, int sessionId) {
+    std::string output;
+    processMessage(msg, output, sessionId);
+    return output;
+}
+
+void FIXEngine::processMessage(const FIXMessage& msg, std::string& output, int sessionId) {
     if (!msg.hasField(FIXMessage::MsgType)) {
-        return createReject("", "Missing MsgType");
+        appendReject(output, "", "Missing MsgType");
+        return;
     }
     
     char msgType = msg.getMsgType();
     
     switch (msgType) {
         case FIXMessage::NewOrderSingle:
-            return handleNewOrder(msg);
+            handleNewOrder(msg, output, sessionId);
+            break;
         case FIXMessage::OrderCancelRequest:
-            return handleCancelRequest(msg);
+            handleCancelRequest(msg, output, sessionId);
+            break;
         case FIXMessage::OrderCancelReplaceRequest:
-            return handleCancelReplaceRequest(msg);
+            handleCancelReplaceRequest(msg, output, sessionId);
+            break;
         default:
-            return createReject(msg.getField(FIXMessage::ClOrdID), 
-                              "Unsupported message type");
+            appendReject(output, msg.getField(FIXMessage::ClOrdID), "Unsupported message type");
     }
 }
 
+size_t FIXEngine::processBatch(std::string_view input, std::string& output, int sessionId) {
+    size_t offset = 0;
+    while (offset < input.size()) {
+        size_t length = FIXMessage::frameLength(input.substr(offset));
+        if (length == 0) break;
+        if (length == std::string::npos) {
+            appendReject(output, "", "Malformed message framing");
+            return std::string::npos;
+        }
+        
+        if (inbound.parse(input.substr(offset, length))) {
+            processMessage(inbound, output, sessionId);
+        } else {
+            appendReject(output, "", "Malformed message");
+        }
+        offset += length;
+    }
+    return offset;
+}
+
+double FIXEngine::averagePrice(const OrderInfo& info) {
+    return info.cumQty > 0 ? static_cast<double>(info.notional) / info.cumQty : 0.0;
+}
+
+FIXEngine::SessionState& FIXEngine::sessionState(int sessionId) {
+    if (static_cast<size_t>(sessionId) >= sessions.size()) {
+        sessions.resize(sessionId + 1);
+    }
+    return sessions[sessionId];
+}
+
+int FIXEngine::sessionSymbol(SessionState& session, std::string_view symbol) {
+    if (session.lastSymbolId >= 0 && symbol == session.lastSymbol) {
+        return session.lastSymbolId;
+    }
+    int symbolId = books->internSymbol(symbol);
+    if (symbolId >= 0) {
+        session.lastSymbol.assign(symbol);
+        session.lastSymbolId = symbolId;
+    }
+    return symbolId;
+}
+
+std::string_view FIXEngine::symbolName(int symbolId) const {
+    return symbolId < 0 ? std::string_view() : std::string_view(books->getSymbol(symbolId));
+}
+
+FIXEngine::BookSlot& FIXEngine::bookSlot(int symbolId) {
+    size_t index = singleBook ? 0 : static_cast<size_t>(symbolId);
+    if (index >= bookSlots.size()) {
+        bookSlots.resize(index + 1);
+    }
+    BookSlot& slot = bookSlots[index];
+    if (!slot.book) {
+        slot.book = singleBook ? singleBook : books->getBook(symbolId);
+        slot.orderIDs.push_back(0);  // book order ids start at 1
+    }
+    return slot;
+}
+
+int FIXEngine::lookupOrderID(int sessionId, std::string_view clOrdID) const {
+    if (sessionId < 0 || static_cast<size_t>(sessionId) >= sessions.size()) return -1;
+    const int* orderID = sessions[sessionId].clOrdIDs.find(clOrdID);
+    return orderID ? *orderID : -1;
+}
+
+void FIXEngine::resetSession(int sessionId) {
+    if (sessionId < 0 || static_cast<size_t>(sessionId) >= sessions.size()) return;
+    // Every order the session entered is in its ClOrdID map
+    sessions[sessionId].clOrdIDs.forEach([this](std::string_view, int orderID) {
+        orders[orderID].sessionId = -1;
+    });
+    sessions[sessionId] = SessionState{};
+}
+
 std::string FIXEngine::handleNewOrder(const FIXMessage& msg) {
-    std::string clOrdID = msg.getField(FIXMessage::ClOrdID);
+    std::string output;
+    handleNewOrder(msg, output, 0);
+    return output;
+}
+
+std::string FIXEngine::handleCancelRequest(const FIXMessage& msg) {
+    std::string output;
+    handleCancelRequest(msg, output, 0);
+    return output;
+}
+
+std::string FIXEngine::handleCancelReplaceRequest(const FIXMessage& msg) {
+    std::string output;
+    handleCancelReplaceRequest(msg, output, 0);
+    return output;
+}
+
+void FIXEngine::handleNewOrder(const FIXMessage& msg, std::string& output, int sessionId) {
+    const std::string& clOrdID = msg.getField(FIXMessage::ClOrdID);
     char side = msg.getFieldAsChar(FIXMessage::Side);
     int orderQty = msg.getFieldAsInt(FIXMessage::OrderQty);
     char ordType = msg.getFieldAsChar(FIXMessage::OrdType);
-    std::string symbol = msg.getField(FIXMessage::Symbol);
+    const std::string& symbol = msg.getField(FIXMessage::Symbol);
     
-    if (clOrdID.empty() || orderQty <= 0) {
-        return createReject(clOrdID, "Invalid order parameters");
+    if (clOrdID.empty() || orderQty <= 0 || orderQty > maxOrderQty) {
+        appendReject(output, clOrdID, "Invalid order parameters");
+        return;
+    }
+    if (clOrdID.size() > InlineStringMap::maxKeyLength) {
+        appendReject(output, clOrdID, "ClOrdID too long");
+        return;
+    }
+    SessionState& session = sessionState(sessionId);
+    // A single-book engine takes orders without a Symbol, as it always has;
+    // they trade on its book under symbol id -1
+    bool unnamed = singleBook && symbol.empty();
+    int symbolId = unnamed ? -1 : sessionSymbol(session, symbol);
+    if (symbolId < 0 && !unnamed) {
+        appendReject(output, clOrdID, "Invalid symbol");
+        return;
     }
     
+    double price = 0.0;
+    double stopPx = 0.0;
+    switch (ordType) {
+        case FIXMessage::Market:
+            break;
+        case FIXMessage::Limit:
+            price = msg.getFieldAsDouble(FIXMessage::Price);
+            if (!validPrice(price)) {
+                appendReject(output, clOrdID, "Invalid limit price");
+                return;
+            }
+            break;
+        case FIXMessage::Stop:
+            stopPx = msg.getFieldAsDouble(FIXMessage::StopPx);
+            if (!validPrice(stopPx)) {
+                appendReject(output, clOrdID, "Invalid stop price");
+                return;
+            }
+            break;
+        case FIXMessage::StopLimit:
+            price = msg.getFieldAsDouble(FIXMessage::Price);
+            stopPx = msg.getFieldAsDouble(FIXMessage::StopPx);
+            if (!validPrice(price) || !validPrice(stopPx)) {
+                appendReject(output, clOrdID, "Invalid stop-limit prices");
+                return;
+            }
+            break;
+        default:
+            appendReject(output, clOrdID, "Unsupported order type");
+            return;
+    }
+    
+    int orderID = static_cast<int>(orders.size());
+    if (!session.clOrdIDs.insert(clOrdID, orderID)) {
+        appendReject(output, clOrdID, "Duplicate ClOrdID");
+        return;
+    }
+    BookSlot& slot = bookSlot(symbolId);
+    Book* book = slot.book;
+    int localId = static_cast<int>(slot.orderIDs.size());
+    slot.orderIDs.push_back(orderID);
+    orders.push_back(OrderInfo{sessionId, symbolId, localId, ordType, side, orderQty, 0, 0, clOrdID});
+    
     bool buyOrSell = (side == FIXMessage::Buy);
-    int orderID = std::stoi(clOrdID); // Use ClOrdID as OrderID for simplicity
     
     try {
         switch (ordType) {
-            case FIXMessage::Market: {
-                book->marketOrder(orderID, buyOrSell, orderQty);
-                return createExecutionReport(orderID, FIXMessage::Fill, '2', 
-                                            0, orderQty, 0.0, clOrdID, side, 
-                                            orderQty, symbol).encode();
-            }
-            case FIXMessage::Limit: {
-                double price = msg.getFieldAsDouble(FIXMessage::Price);
-                if (price <= 0) {
-                    return createReject(clOrdID, "Invalid limit price");
-                }
-                book->addLimitOrder(orderID, buyOrSell, orderQty, static_cast<int>(price));
-                return createExecutionReport(orderID, FIXMessage::New, '0',
-                                            orderQty, 0, 0.0, clOrdID, side,
-                                            orderQty, symbol).encode();
-            }
-            case FIXMessage::Stop: {
-                double stopPx = msg.getFieldAsDouble(FIXMessage::StopPx);
-                if (stopPx <= 0) {
-                    return createReject(clOrdID, "Invalid stop price");
-                }
-                book->addStopOrder(orderID, buyOrSell, orderQty, static_cast<int>(stopPx));
-                return createExecutionReport(orderID, FIXMessage::New, '0',
-                                            orderQty, 0, 0.0, clOrdID, side,
-                                            orderQty, symbol).encode();
-            }
-            case FIXMessage::StopLimit: {
-                double price = msg.getFieldAsDouble(FIXMessage::Price);
-                double stopPx = msg.getFieldAsDouble(FIXMessage::StopPx);
-                if (price <= 0 || stopPx <= 0) {
-                    return createReject(clOrdID, "Invalid stop-limit prices");
-                }
-                book->addStopLimitOrder(orderID, buyOrSell, orderQty, 
+            case FIXMessage::Market:
+                book->marketOrder(localId, buyOrSell, orderQty);
+                break;
+            case FIXMessage::Limit:
+                book->addLimitOrder(localId, buyOrSell, orderQty, static_cast<int>(price));
+                break;
+            case FIXMessage::Stop:
+                book->addStopOrder(localId, buyOrSell, orderQty, static_cast<int>(stopPx));
+                break;
+            case FIXMessage::StopLimit:
+                book->addStopLimitOrder(localId, buyOrSell, orderQty, 
                                        static_cast<int>(price), static_cast<int>(stopPx));
-                return createExecutionReport(orderID, FIXMessage::New, '0',
-                                            orderQty, 0, 0.0, clOrdID, side,
-                                            orderQty, symbol).encode();
-            }
-            default:
-                return createReject(clOrdID, "Unsupported order type");
+                break;
         }
     } catch (const std::exception& e) {
-        return createReject(clOrdID, std::string("Order failed: ") + e.what());
+        appendReject(output, clOrdID, std::string("Order failed: ") + e.what());
+        return;
+    }
+    
+    // Acknowledge, then report what the book actually did
+    appendExecutionReport(output, orderID, FIXMessage::New, '0',
+                          orderQty, 0, 0.0, clOrdID, side,
+                          orderQty, symbol);
+    reportFills(output, sessionId, slot);
+    
+    // Market orders (and stops that triggered straight away) never rest, so
+    // whatever the book could not fill is cancelled
+    OrderInfo& info = orders[orderID];
+    int leavesQty = info.orderQty - info.cumQty;
+    if (leavesQty > 0 && book->searchOrderMap(localId) == nullptr) {
+        appendExecutionReport(output, orderID, FIXMessage::Canceled, '4',
+                              0, info.cumQty, averagePrice(info), clOrdID, side,
+                              orderQty, symbol);
     }
 }
 
-std::string FIXEngine::handleCancelRequest(const FIXMessage& msg) {
-    std::string clOrdID = msg.getField(FIXMessage::ClOrdID);
-    std::string origClOrdID = msg.getField(FIXMessage::OrigClOrdID);
+void FIXEngine::reportFills(std::string& output, int sessionId, const BookSlot& slot) {
+    auto engineOrderID = [&slot](int localId) {
+        return (localId > 0 && static_cast<size_t>(localId) < slot.orderIDs.size()) ? slot.orderIDs[localId] : 0;
+    };
+    for (const Fill& fill : slot.book->getFills()) {
+        // Stops triggered inside this call appear as takers too
+        if (int takerID = engineOrderID(fill.takerId)) {
+            reportFill(orders[takerID], takerID, fill, output, sessionId);
+        }
+        if (int makerID = engineOrderID(fill.makerId)) {
+            reportFill(orders[makerID], makerID, fill, output, sessionId);
+        }
+    }
+}
+
+void FIXEngine::reportFill(OrderInfo& info, int orderID, const Fill& fill, std::string& output, int sessionId) {
+    info.cumQty += fill.shares;
+    info.notional += static_cast<long long>(fill.price) * fill.shares;
+    int leavesQty = info.orderQty - info.cumQty;
+    char execType = leavesQty > 0 ? FIXMessage::PartialFill : FIXMessage::Fill;
+    
+    fillExecutionReport(outbound, orderID, execType, execType,
+                        leavesQty, info.cumQty, averagePrice(info),
+                        info.clOrdID, info.side, info.orderQty, symbolName(info.symbolId));
+    outbound.setField(FIXMessage::LastShares, fill.shares);
+    outbound.setField(FIXMessage::LastPx, static_cast<double>(fill.price));
+    emitOutbound(output, sessionId, info.sessionId);
+}
+
+void FIXEngine::emitOutbound(std::string& output, int currentSession, int targetSession) {
+    if (targetSession == currentSession || !reportSink) {
+        outbound.encodeTo(output);
+        return;
+    }
+    if (targetSession < 0) return;  // its session has closed
+    routedReport.clear();
+    outbound.encodeTo(routedReport);
+    reportSink(targetSession, routedReport);
+}
+
+void FIXEngine::handleCancelRequest(const FIXMessage& msg, std::string& output, int sessionId) {
+    const std::string& clOrdID = msg.getField(FIXMessage::ClOrdID);
+    const std::string& origClOrdID = msg.getField(FIXMessage::OrigClOrdID);
     char side = msg.getFieldAsChar(FIXMessage::Side);
-    std::string symbol = msg.getField(FIXMessage::Symbol);
     
     if (origClOrdID.empty()) {
-        return createReject(clOrdID, "Missing OrigClOrdID");
+        appendReject(output, clOrdID, "Missing OrigClOrdID");
+        return;
     }
     
-    try {
-        int orderID = std::stoi(origClOrdID);
-        // Try canceling as limit order first, if fails try stop orders
-        try {
-            book->cancelLimitOrder(orderID);
-        } catch (...) {
-            try {
-                book->cancelStopOrder(orderID);
-            } catch (...) {
-                book->cancelStopLimitOrder(orderID);
-            }
-        }
-        
-        return createExecutionReport(orderID, FIXMessage::Canceled, '4',
-                                    0, 0, 0.0, clOrdID, side, 0, symbol).encode();
-    } catch (const std::exception& e) {
-        return createReject(clOrdID, std::string("Cancel failed: ") + e.what());
+    int orderID = lookupOrderID(sessionId, origClOrdID);
+    if (orderID < 0) {
+        appendReject(output, clOrdID, "Unknown OrigClOrdID");
+        return;
+    }
+    const OrderInfo& info = orders[orderID];
+    Book* book = bookSlot(info.symbolId).book;
+    if (book->searchOrderMap(info.localId) == nullptr) {
+        appendReject(output, clOrdID, "Order is no longer active");
+        return;
     }
+    
+    switch (info.ordType) {
+        case FIXMessage::Stop:
+            book->cancelStopOrder(info.localId);
+            break;
+        case FIXMessage::StopLimit:
+            book->cancelStopLimitOrder(info.localId);
+            break;
+        default:
+            book->cancelLimitOrder(info.localId);
+    }
+    
+    appendExecutionReport(output, orderID, FIXMessage::Canceled, '4',
+                          0, info.cumQty, averagePrice(info), clOrdID, side,
+                          info.orderQty, symbolName(info.symbolId));
 }
 
-std::string FIXEngine::handleCancelReplaceRequest(const FIXMessage& msg) {
-    std::string clOrdID = msg.getField(FIXMessage::ClOrdID);
-    std::string origClOrdID = msg.getField(FIXMessage::OrigClOrdID);
+void FIXEngine::handleCancelReplaceRequest(const FIXMessage& msg, std::string& output, int sessionId) {
+    const std::string& clOrdID = msg.getField(FIXMessage::ClOrdID);
+    const std::string& origClOrdID = msg.getField(FIXMessage::OrigClOrdID);
     char side = msg.getFieldAsChar(FIXMessage::Side);
     int orderQty = msg.getFieldAsInt(FIXMessage::OrderQty);
     double price = msg.getFieldAsDouble(FIXMessage::Price);
-    std::string symbol = msg.getField(FIXMessage::Symbol);
+    double stopPx = msg.getFieldAsDouble(FIXMessage::StopPx);
     
-    if (origClOrdID.empty() || orderQty <= 0 || price <= 0) {
-        return createReject(clOrdID, "Invalid modify parameters");
+    if (origClOrdID.empty() || orderQty <= 0 || orderQty > maxOrderQty) {
+        appendReject(output, clOrdID, "Invalid modify parameters");
+        return;
+    }
+    if (clOrdID.size() > InlineStringMap::maxKeyLength) {
+        appendReject(output, clOrdID, "ClOrdID too long");
+        return;
     }
     
-    try {
-        int orderID = std::stoi(origClOrdID);
-        bool buyOrSell = (side == FIXMessage::Buy);
-        
-        book->modifyLimitOrder(orderID, orderQty, static_cast<int>(price));
-        
-        return createExecutionReport(orderID, FIXMessage::Replaced, '5',
-                                    orderQty, 0, 0.0, clOrdID, side,
-                                    orderQty, symbol).encode();
-    } catch (const std::exception& e) {
-        return createReject(clOrdID, std::string("Modify failed: ") + e.what());
+    int orderID = lookupOrderID(sessionId, origClOrdID);
+    if (orderID < 0) {
+        appendReject(output, clOrdID, "Unknown OrigClOrdID");
+        return;
+    }
+    OrderInfo& info = orders[orderID];
+    BookSlot& slot = bookSlot(info.symbolId);
+    Book* book = slot.book;
+    const Order* order = book->searchOrderMap(info.localId);
+    if (order == nullptr) {
+        appendReject(output, clOrdID, "Order is no longer active");
+        return;
+    }
+    
+    // A stop-limit that has triggered rests as a limit, and is replaced as one
+    char ordType = book->isRestingLimit(*order) ? FIXMessage::Limit : info.ordType;
+    bool validPrices = (ordType == FIXMessage::Stop) ? validPrice(stopPx)
+                     : (ordType == FIXMessage::StopLimit) ? (validPrice(price) && validPrice(stopPx))
+                     : validPrice(price);
+    if (!validPrices) {
+        appendReject(output, clOrdID, "Invalid modify parameters");
+        return;
+    }
+    
+    // The replacement keeps its order id and is reachable by either ClOrdID
+    InlineStringMap& clOrdIDs = sessionState(sessionId).clOrdIDs;
+    if (!clOrdID.empty() && clOrdID != origClOrdID && !clOrdIDs.insert(clOrdID, orderID)) {
+        appendReject(output, clOrdID, "Duplicate ClOrdID");
+        return;
+    }
+    
+    switch (ordType) {
+        case FIXMessage::Stop:
+            book->modifyStopOrder(info.localId, orderQty, static_cast<int>(stopPx));
+            break;
+        case FIXMessage::StopLimit:
+            book->modifyStopLimitOrder(info.localId, orderQty, static_cast<int>(price), static_cast<int>(stopPx));
+            break;
+        default:
+            book->modifyLimitOrder(info.localId, orderQty, static_cast<int>(price));
     }
+    
+    // OrderQty on a replace is the new open quantity
+    info.orderQty = info.cumQty + orderQty;
+    if (!clOrdID.empty()) info.clOrdID = clOrdID;
+    appendExecutionReport(output, orderID, FIXMessage::Replaced, '5',
+                          orderQty, info.cumQty, averagePrice(info), clOrdID, side,
+                          info.orderQty, symbolName(info.symbolId));
+    // Moving a limit can trigger resting stops
+    reportFills(output, sessionId, slot);
 }
 
 FIXMessage FIXEngine::createExecutionReport(int orderID, char execType, char ordStatus,
@@ -152,22 +404,22 @@ FIXMessage FIXEngine::createExecutionReport(int orderID, char execType, char ord
                                            const std::string& clOrdID, char side,
                                            int orderQty, const std::string& symbol) {
     FIXMessage msg;
+    fillExecutionReport(msg, orderID, execType, ordStatus, leavesQty, cumQty, avgPx,
+                        clOrdID, side, orderQty, symbol);
+    return msg;
+}
+
+void FIXEngine::fillExecutionReport(FIXMessage& msg, int orderID, char execType, char ordStatus,
+                                    int leavesQty, int cumQty, double avgPx,
+                                    std::string_view clOrdID, char side,
+                                    int orderQty, std::string_view symbol) {
+    msg.clear();
+    msg.setField(FIXMessage::BeginString, "FIX.4.2");
     msg.setMsgType(FIXMessage::ExecutionReport);
     msg.setField(FIXMessage::SenderCompID, senderCompID);
     msg.setField(FIXMessage::TargetCompID, targetCompID);
     msg.setField(FIXMessage::MsgSeqNum, msgSeqNum++);
-    
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::tm tm;
-    #ifdef _WIN32
-        localtime_s(&tm, &time);
-    #else
-        localtime_r(&time, &tm);
-    #endif
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y%m%d-%H:%M:%S");
-    msg.setField(FIXMessage::SendingTime, oss.str());
+    msg.setField(FIXMessage::SendingTime, currentSendingTime());
     
     msg.setField(FIXMessage::OrderID, orderID);
     msg.setField(FIXMessage::ClOrdID, clOrdID);
@@ -179,33 +431,49 @@ FIXMessage FIXEngine::createExecutionReport(int orderID, char execType, char ord
     msg.setField(FIXMessage::CumQty, cumQty);
     msg.setField(FIXMessage::AvgPx, avgPx);
     msg.setField(FIXMessage::Symbol, symbol);
-    
-    return msg;
 }
 
-std::string FIXEngine::createReject(const std::string& clOrdID, const std::string& reason) {
-    FIXMessage msg;
-    msg.setMsgType(FIXMessage::Reject);
-    msg.setField(FIXMessage::SenderCompID, senderCompID);
-    msg.setField(FIXMessage::TargetCompID, targetCompID);
-    msg.setField(FIXMessage::MsgSeqNum, msgSeqNum++);
-    
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::tm tm;
-    #ifdef _WIN32
-        localtime_s(&tm, &time);
-    #else
-        localtime_r(&time, &tm);
-    #endif
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y%m%d-%H:%M:%S");
-    msg.setField(FIXMessage::SendingTime, oss.str());
+void FIXEngine::appendExecutionReport(std::string& output, int orderID, char execType, char ordStatus,
+                                      int leavesQty, int cumQty, double avgPx,
+                                      std::string_view clOrdID, char side,
+                                      int orderQty, std::string_view symbol) {
+    fillExecutionReport(outbound, orderID, execType, ordStatus, leavesQty, cumQty, avgPx,
+                        clOrdID, side, orderQty, symbol);
+    outbound.encodeTo(output);
+}
+
+void FIXEngine::appendReject(std::string& output, std::string_view clOrdID, std::string_view reason) {
+    outbound.clear();
+    outbound.setField(FIXMessage::BeginString, "FIX.4.2");
+    outbound.setMsgType(FIXMessage::Reject);
+    outbound.setField(FIXMessage::SenderCompID, senderCompID);
+    outbound.setField(FIXMessage::TargetCompID, targetCompID);
+    outbound.setField(FIXMessage::MsgSeqNum, msgSeqNum++);
+    outbound.setField(FIXMessage::SendingTime, currentSendingTime());
     
     if (!clOrdID.empty()) {
-        msg.setField(FIXMessage::ClOrdID, clOrdID);
+        outbound.setField(FIXMessage::ClOrdID, clOrdID);
     }
-    msg.setField(FIXMessage::Text, reason);
+    outbound.setField(FIXMessage::Text, reason);
     
-    return msg.encode();
+    outbound.encodeTo(output);
+}
+
+// SendingTime only changes once a second, so format it once a second
+const std::string& FIXEngine::currentSendingTime() {
+    auto now = std::chrono::system_clock::now();
+    auto time = std::chrono::system_clock::to_time_t(now);
+    if (time != sendingTimeSecond) {
+        std::tm tm;
+        #ifdef _WIN32
+            localtime_s(&tm, &time);
+        #else
+            localtime_r(&time, &tm);
+        #endif
+        char buffer[32];
+        size_t length = std::strftime(buffer, sizeof(buffer), "%Y%m%d-%H:%M:%S", &tm);
+        sendingTime.assign(buffer, length);
+        sendingTimeSecond = time;
+    }
+    return sendingTime;
 }
@@ -3,15 +3,55 @@
 
 #include "FIXMessage.hpp"
 #include "../Limit_Order_Book/Book.hpp"
+#include "../Limit_Order_Book/BookManager.hpp"
+#include "../Limit_Order_Book/InlineStringMap.hpp"
+#include <memory>
 #include <string>
+#include <string_view>
+#include <ctime>
 #include <functional>
 
 class FIXEngine {
 public:
+    // Every symbol trades on the one book
     FIXEngine(Book* book);
+    // Each symbol (tag 55) trades on its own book, created on first use
+    FIXEngine(BookManager* books);
     
-    // Process incoming FIX message and return execution report
-    std::string processMessage(const std::string& rawMessage);
+    // Symbol table; in single-book mode it only interns names
+    BookManager* getBookManager() const { return books; }
+    
+    // Process incoming FIX message and return execution report.
+    // ClOrdIDs are scoped to sessionId, so different sessions may reuse them.
+    std::string processMessage(const std::string& rawMessage, int sessionId = 0);
+    
+    // Process a message that has already been decoded (e.g. on an I/O thread)
+    std::string processMessage(const FIXMessage& msg, int sessionId = 0);
+    
+    // Append the reports for msg to output instead of returning a new string
+    void processMessage(const FIXMessage& msg, std::string& output, int sessionId = 0);
+    
+    // Process every complete framed message in input, in order, appending all
+    // reports to output (one buffer, one write). Returns the bytes consumed; a
+    // trailing partial message is left for the next call. A stream that is not
+    // framed FIX gets a Reject appended and returns std::string::npos.
+    size_t processBatch(std::string_view input, std::string& output, int sessionId = 0);
+    
+    // Engine-assigned order id for a session's ClOrdID, or -1. In single-book
+    // mode this is also the id of the order in the book.
+    int lookupOrderID(int sessionId, std::string_view clOrdID) const;
+    
+    // Forget a closed session before its id is given to a new one: its
+    // ClOrdIDs and cached symbol go, and its orders still resting in the book
+    // no longer report to the id (with a sink installed, their reports are
+    // dropped).
+    void resetSession(int sessionId);
+    
+    // Fills can produce reports for resting orders owned by other sessions.
+    // With a sink installed those reports go to the sink; without one every
+    // report is appended to the caller's output.
+    using ReportSink = std::function<void(int sessionId, std::string_view report)>;
+    void setReportSink(ReportSink sink) { reportSink = std::move(sink); }
     
     // Create execution report for order events
     FIXMessage createExecutionReport(int orderID, char execType, char ordStatus,
@@ -19,7 +59,7 @@ public:
                                       const std::string& clOrdID, char side,
                                       int orderQty, const std::string& symbol);
     
-    // Handle different message types
+    // Handle different message types (on session 0)
     std::string handleNewOrder(const FIXMessage& msg);
     std::string handleCancelRequest(const FIXMessage& msg);
     std::string handleCancelReplaceRequest(const FIXMessage& msg);
@@ -28,12 +68,85 @@ public:
     void setTargetCompID(const std::string& id) { targetCompID = id; }
     
 private:
-    Book* book;
+    Book* singleBook = nullptr;
+    BookManager* books;
+    std::unique_ptr<BookManager> ownedSymbols;
     std::string senderCompID;
     std::string targetCompID;
     int msgSeqNum;
     
-    std::string createReject(const std::string& clOrdID, const std::string& reason);
+    // Scratch messages reused across calls so the steady state does not allocate
+    FIXMessage inbound;
+    FIXMessage outbound;
+    std::string sendingTime;
+    std::time_t sendingTimeSecond = -1;
+    
+    // Order ids are assigned here, densely from 1, rather than taken from
+    // the client. Each session maps its ClOrdIDs to those ids.
+    struct OrderInfo {
+        int sessionId;
+        int symbolId;
+        int localId;  // id of the order inside its book
+        char ordType;
+        char side;
+        int orderQty;
+        int cumQty;
+        long long notional;  // sum of price * shares over fills, for AvgPx
+        std::string clOrdID;
+    };
+    std::vector<OrderInfo> orders;  // indexed by engine order id
+    
+    // Each book numbers its own orders densely from 1, so a book's order index
+    // only grows with that book's flow. orderIDs maps them back to engine ids.
+    struct BookSlot {
+        Book* book = nullptr;
+        std::vector<int> orderIDs;
+    };
+    std::vector<BookSlot> bookSlots;  // indexed by symbol id (one slot in single-book mode)
+    BookSlot& bookSlot(int symbolId);
+    
+    // A session usually trades one symbol at a time, so the last symbol it
+    // used is cached and the symbol table is only consulted when it changes
+    struct SessionState {
+        InlineStringMap clOrdIDs;
+        std::string lastSymbol;
+        int lastSymbolId = -1;
+    };
+    std::vector<SessionState> sessions;  // indexed by session id
+    
+    SessionState& sessionState(int sessionId);
+    int sessionSymbol(SessionState& session, std::string_view symbol);
+    // Symbol echoed in reports: empty for an order a single-book engine took
+    // without one
+    std::string_view symbolName(int symbolId) const;
+    static double averagePrice(const OrderInfo& info);
+    
+    // Book prices and quantities are ints; larger inputs are rejected
+    static constexpr double maxPrice = 1e9;
+    static constexpr int maxOrderQty = 1000000000;
+    static bool validPrice(double price) { return price > 0 && price <= maxPrice; }
+    
+    ReportSink reportSink;
+    std::string routedReport;
+    
+    void reportFills(std::string& output, int sessionId, const BookSlot& slot);
+    void reportFill(OrderInfo& info, int orderID, const Fill& fill, std::string& output, int sessionId);
+    void emitOutbound(std::string& output, int currentSession, int targetSession);
+    
+    void handleNewOrder(const FIXMessage& msg, std::string& output, int sessionId);
+    void handleCancelRequest(const FIXMessage& msg, std::string& output, int sessionId);
+    void handleCancelReplaceRequest(const FIXMessage& msg, std::string& output, int sessionId);
+    
+    void fillExecutionReport(FIXMessage& msg, int orderID, char execType, char ordStatus,
+                             int leavesQty, int cumQty, double avgPx,
+                             std::string_view clOrdID, char side,
+                             int orderQty, std::string_view symbol);
+    void appendExecutionReport(std::string& output, int orderID, char execType, char ordStatus,
+                               int leavesQty, int cumQty, double avgPx,
+                               std::string_view clOrdID, char side,
+                               int orderQty, std::string_view symbol);
+    void appendReject(std::string& output, std::string_view clOrdID, std::string_view reason);
+    const std::string& currentSendingTime();
 };
 
 #endif
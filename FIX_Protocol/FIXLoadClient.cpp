@@ -0,0 +1,200 @@
+#include "FIXMessage.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Localhost load generator for FIXServer.
+// Usage: FIXLoadClient [port] [connections] [messagesPerConnection] [window]
+//
+// Every connection keeps up to `window` NewOrderSingle messages in flight and
+// the first report carrying a ClOrdID closes that order's round trip.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int idsPerConnection = 1000000;
+
+    struct Connection {
+        int fd = -1;
+        int index = 0;
+        int sent = 0;
+        int acknowledged = 0;
+        std::string inBuffer;
+        std::string outBuffer;
+        std::vector<Clock::time_point> sendTimes;
+        std::vector<bool> answered;
+    };
+
+    int connectTo(uint16_t port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        return fd;
+    }
+
+    std::string buildOrder(int clOrdID, int seqNum, std::mt19937& gen) {
+        std::uniform_int_distribution<> sideDist(0, 1);
+        std::uniform_int_distribution<> offsetDist(0, 9);
+        std::uniform_int_distribution<> qtyDist(1, 100);
+
+        bool buy = sideDist(gen);
+        FIXMessage order;
+        order.setMsgType(FIXMessage::NewOrderSingle);
+        order.setField(FIXMessage::SenderCompID, "LOADGEN");
+        order.setField(FIXMessage::TargetCompID, "SERVER");
+        order.setField(FIXMessage::MsgSeqNum, seqNum);
+        order.setField(FIXMessage::ClOrdID, clOrdID);
+        order.setField(FIXMessage::Symbol, "AAPL");
+        order.setField(FIXMessage::Side, buy ? FIXMessage::Buy : FIXMessage::Sell);
+        order.setField(FIXMessage::OrderQty, qtyDist(gen));
+        order.setField(FIXMessage::OrdType, FIXMessage::Limit);
+        // Overlapping bands so a share of the flow crosses the spread
+        order.setField(FIXMessage::Price, static_cast<double>(buy ? 95 + offsetDist(gen) : 96 + offsetDist(gen)));
+        return order.encode();
+    }
+
+    bool flush(Connection& conn) {
+        while (!conn.outBuffer.empty()) {
+            ssize_t n = send(conn.fd, conn.outBuffer.data(), conn.outBuffer.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.outBuffer.erase(0, static_cast<size_t>(n));
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                return true;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+        return sorted[index];
+    }
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = argc > 1 ? static_cast<uint16_t>(std::atoi(argv[1])) : 9878;
+    int connectionCount = argc > 2 ? std::atoi(argv[2]) : 100;
+    int messagesPerConnection = argc > 3 ? std::atoi(argv[3]) : 10000;
+    int window = argc > 4 ? std::atoi(argv[4]) : 16;
+
+    if (messagesPerConnection >= idsPerConnection || connectionCount * static_cast<long long>(idsPerConnection) > 2000000000LL) {
+        std::cerr << "Too many messages or connections for the ClOrdID space" << std::endl;
+        return 1;
+    }
+
+    std::vector<Connection> connections(connectionCount);
+    for (int i = 0; i < connectionCount; ++i) {
+        Connection& conn = connections[i];
+        conn.index = i;
+        conn.fd = connectTo(port);
+        if (conn.fd < 0) {
+            std::cerr << "Failed to connect to port " << port << std::endl;
+            return 1;
+        }
+        conn.sendTimes.resize(messagesPerConnection);
+        conn.answered.assign(messagesPerConnection, false);
+    }
+
+    std::mt19937 gen(42);
+    std::vector<double> latenciesUs;
+    latenciesUs.reserve(static_cast<size_t>(connectionCount) * messagesPerConnection);
+    std::vector<pollfd> pollFds(connectionCount);
+    int finished = 0;
+    char buffer[64 * 1024];
+
+    auto start = Clock::now();
+    while (finished < connectionCount) {
+        for (int i = 0; i < connectionCount; ++i) {
+            Connection& conn = connections[i];
+            while (conn.sent < messagesPerConnection && conn.sent - conn.acknowledged < window) {
+                int clOrdID = (i + 1) * idsPerConnection + conn.sent;
+                conn.outBuffer += buildOrder(clOrdID, conn.sent + 1, gen);
+                conn.sendTimes[conn.sent] = Clock::now();
+                ++conn.sent;
+            }
+            if (!flush(conn)) {
+                std::cerr << "Connection " << i << " lost" << std::endl;
+                return 1;
+            }
+            pollFds[i].fd = conn.fd;
+            pollFds[i].events = POLLIN | (conn.outBuffer.empty() ? 0 : POLLOUT);
+            pollFds[i].revents = 0;
+        }
+
+        if (poll(pollFds.data(), pollFds.size(), 1000) <= 0) continue;
+
+        for (int i = 0; i < connectionCount; ++i) {
+            if (!(pollFds[i].revents & POLLIN)) continue;
+            Connection& conn = connections[i];
+            ssize_t n = recv(conn.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (n <= 0) {
+                if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                std::cerr << "Server closed connection " << i << std::endl;
+                return 1;
+            }
+            conn.inBuffer.append(buffer, static_cast<size_t>(n));
+
+            size_t offset = 0;
+            for (;;) {
+                std::string_view pending(conn.inBuffer.data() + offset, conn.inBuffer.size() - offset);
+                size_t length = FIXMessage::frameLength(pending);
+                if (length == 0) break;
+                if (length == std::string::npos) {
+                    std::cerr << "Malformed report on connection " << i << std::endl;
+                    return 1;
+                }
+                FIXMessage report(std::string(pending.substr(0, length)));
+                offset += length;
+
+                int clOrdID = report.getFieldAsInt(FIXMessage::ClOrdID);
+                int seq = clOrdID - (i + 1) * idsPerConnection;
+                if (seq < 0 || seq >= conn.sent || conn.answered[seq]) continue;  // e.g. resting-order fills
+
+                conn.answered[seq] = true;
+                ++conn.acknowledged;
+                auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - conn.sendTimes[seq]);
+                latenciesUs.push_back(static_cast<double>(latency.count()) / 1000.0);
+                if (conn.acknowledged == messagesPerConnection) ++finished;
+            }
+            conn.inBuffer.erase(0, offset);
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (Connection& conn : connections) close(conn.fd);
+
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    std::cout << "Connections: " << connectionCount << ", messages: " << latenciesUs.size()
+              << ", window: " << window << std::endl;
+    std::cout << "Elapsed: " << elapsed << " s, throughput: "
+              << static_cast<uint64_t>(latenciesUs.size() / elapsed) << " messages/sec" << std::endl;
+    std::cout << "Round trip (us) p50: " << percentile(latenciesUs, 0.50)
+              << ", p99: " << percentile(latenciesUs, 0.99)
+              << ", p99.9: " << percentile(latenciesUs, 0.999)
+              << ", max: " << (latenciesUs.empty() ? 0.0 : latenciesUs.back()) << std::endl;
+    return 0;
+}
@@ -2,6 +2,9 @@
 #include <chrono>
 #include <iomanip>
 #include <ctime>
+#include <charconv>
+#include <cstdio>
+#include <cmath>
 
 FIXMessage::FIXMessage() {
     // Set default FIX version
@@ -12,46 +15,86 @@ FIXMessage::FIXMessage(const std::string& rawMessage) {
     parse(rawMessage);
 }
 
-void FIXMessage::setField(int tag, const std::string& value) {
-    fields[tag] = value;
+FIXMessage::Field* FIXMessage::findField(int tag) {
+    for (size_t i = 0; i < fieldCount; ++i) {
+        if (fields[i].tag == tag) return &fields[i];
+    }
+    return nullptr;
+}
+
+const FIXMessage::Field* FIXMessage::findField(int tag) const {
+    for (size_t i = 0; i < fieldCount; ++i) {
+        if (fields[i].tag == tag) return &fields[i];
+    }
+    return nullptr;
+}
+
+// Existing field, else a recycled slot, else a new one
+std::string& FIXMessage::fieldSlot(int tag) {
+    if (Field* field = findField(tag)) return field->value;
+    if (fieldCount == fields.size()) {
+        fields.push_back(Field{tag, std::string()});
+    }
+    Field& field = fields[fieldCount++];
+    field.tag = tag;
+    return field.value;
+}
+
+void FIXMessage::clear() {
+    fieldCount = 0;
+}
+
+void FIXMessage::setField(int tag, std::string_view value) {
+    fieldSlot(tag).assign(value.data(), value.size());
 }
 
 void FIXMessage::setField(int tag, int value) {
-    fields[tag] = std::to_string(value);
+    char buffer[16];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    fieldSlot(tag).assign(buffer, result.ptr);
 }
 
 void FIXMessage::setField(int tag, double value) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(2) << value;
-    fields[tag] = oss.str();
+    char buffer[64];
+    int length = std::snprintf(buffer, sizeof(buffer), "%.2f", value);
+    fieldSlot(tag).assign(buffer, static_cast<size_t>(length));
 }
 
 void FIXMessage::setField(int tag, char value) {
-    fields[tag] = std::string(1, value);
+    fieldSlot(tag).assign(1, value);
 }
 
-std::string FIXMessage::getField(int tag) const {
-    auto it = fields.find(tag);
-    return (it != fields.end()) ? it->second : "";
+const std::string& FIXMessage::getField(int tag) const {
+    static const std::string empty;
+    const Field* field = findField(tag);
+    return field ? field->value : empty;
 }
 
+// Malformed or out-of-range values read as 0 rather than throwing, so
+// handlers reject them through their usual parameter checks
 int FIXMessage::getFieldAsInt(int tag) const {
-    std::string value = getField(tag);
-    return value.empty() ? 0 : std::stoi(value);
+    const std::string& value = getField(tag);
+    int result = 0;
+    const char* end = value.data() + value.size();
+    auto parsed = std::from_chars(value.data(), end, result);
+    return (parsed.ec == std::errc() && parsed.ptr == end) ? result : 0;
 }
 
 double FIXMessage::getFieldAsDouble(int tag) const {
-    std::string value = getField(tag);
-    return value.empty() ? 0.0 : std::stod(value);
+    const std::string& value = getField(tag);
+    double result = 0.0;
+    const char* end = value.data() + value.size();
+    auto parsed = std::from_chars(value.data(), end, result, std::chars_format::fixed);
+    return (parsed.ec == std::errc() && parsed.ptr == end && std::isfinite(result)) ? result : 0.0;
 }
 
 char FIXMessage::getFieldAsChar(int tag) const {
-    std::string value = getField(tag);
+    const std::string& value = getField(tag);
     return value.empty() ? '\0' : value[0];
 }
 
 bool FIXMessage::hasField(int tag) const {
-    return fields.find(tag) != fields.end();
+    return findField(tag) != nullptr;
 }
 
 char FIXMessage::getMsgType() const {
@@ -82,68 +125,128 @@ std::string FIXMessage::getCurrentTimestamp() const {
 }
 
 std::string FIXMessage::encode() const {
-    std::ostringstream body;
+    std::string message;
+    encodeTo(message);
+    return message;
+}
+
+void FIXMessage::encodeTo(std::string& output) const {
+    auto isBodyField = [](int tag) {
+        return tag != BeginString && tag != BodyLength && tag != CheckSum;
+    };
+    auto appendInt = [&output](size_t value) {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        output.append(buffer, result.ptr);
+    };
     
-    // Build body (all fields except BeginString, BodyLength, and CheckSum)
-    for (const auto& [tag, value] : fields) {
-        if (tag != BeginString && tag != BodyLength && tag != CheckSum) {
-            body << tag << '=' << value << SOH;
+    // Body (all fields except BeginString, BodyLength, and CheckSum), sized
+    // up front so the header can be written before it
+    size_t bodyLength = 0;
+    for (size_t i = 0; i < fieldCount; ++i) {
+        const Field& field = fields[i];
+        if (isBodyField(field.tag)) {
+            char buffer[16];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), field.tag);
+            bodyLength += static_cast<size_t>(result.ptr - buffer) + field.value.size() + 2;
         }
     }
     
-    std::string bodyStr = body.str();
-    
-    // Build header with BodyLength
-    std::ostringstream header;
-    header << BeginString << '=' << getField(BeginString) << SOH;
-    header << BodyLength << '=' << bodyStr.length() << SOH;
-    
-    // Calculate checksum
-    std::string message = header.str() + bodyStr;
-    std::string checksum = calculateChecksum(message);
-    
-    // Complete message
-    std::ostringstream fullMessage;
-    fullMessage << message << CheckSum << '=' << checksum << SOH;
+    size_t start = output.size();
+    output += "8=";
+    output += getField(BeginString);
+    output += SOH;
+    output += "9=";
+    appendInt(bodyLength);
+    output += SOH;
+    for (size_t i = 0; i < fieldCount; ++i) {
+        const Field& field = fields[i];
+        if (isBodyField(field.tag)) {
+            appendInt(static_cast<size_t>(field.tag));
+            output += '=';
+            output += field.value;
+            output += SOH;
+        }
+    }
     
-    return fullMessage.str();
+    unsigned int sum = 0;
+    for (size_t i = start; i < output.size(); ++i) {
+        sum += static_cast<unsigned char>(output[i]);
+    }
+    sum %= 256;
+    char checksum[8] = {'1', '0', '=',
+                        static_cast<char>('0' + sum / 100),
+                        static_cast<char>('0' + (sum / 10) % 10),
+                        static_cast<char>('0' + sum % 10),
+                        SOH, '\0'};
+    output.append(checksum, 7);
 }
 
-bool FIXMessage::parse(const std::string& rawMessage) {
-    fields.clear();
+bool FIXMessage::parse(std::string_view rawMessage) {
+    clear();
     
     size_t pos = 0;
     while (pos < rawMessage.length()) {
         // Find the '=' separator
         size_t equalPos = rawMessage.find('=', pos);
-        if (equalPos == std::string::npos) break;
+        if (equalPos == std::string_view::npos) break;
         
         // Extract tag
-        std::string tagStr = rawMessage.substr(pos, equalPos - pos);
-        int tag = std::stoi(tagStr);
+        int tag = 0;
+        auto result = std::from_chars(rawMessage.data() + pos, rawMessage.data() + equalPos, tag);
+        if (result.ec != std::errc() || result.ptr != rawMessage.data() + equalPos || tag <= 0) {
+            return false;
+        }
         
         // Find the SOH delimiter
         size_t sohPos = rawMessage.find(SOH, equalPos);
-        if (sohPos == std::string::npos) sohPos = rawMessage.length();
+        if (sohPos == std::string_view::npos) sohPos = rawMessage.length();
         
         // Extract value
-        std::string value = rawMessage.substr(equalPos + 1, sohPos - equalPos - 1);
-        fields[tag] = value;
+        setField(tag, rawMessage.substr(equalPos + 1, sohPos - equalPos - 1));
         
         pos = sohPos + 1;
     }
     
-    return !fields.empty();
+    return fieldCount > 0;
 }
 
-std::string FIXMessage::calculateChecksum(const std::string& message) const {
-    int sum = 0;
-    for (char c : message) {
-        sum += static_cast<unsigned char>(c);
+size_t FIXMessage::frameLength(std::string_view buffer) {
+    // 8=FIX.x.y<SOH>9=<len><SOH> ... body ... 10=nnn<SOH>
+    static constexpr size_t maxHeaderLength = 32;
+    static constexpr size_t checksumLength = 7;
+
+    if (buffer.size() < 2) return 0;
+    if (buffer[0] != '8' || buffer[1] != '=') return std::string::npos;
+
+    size_t beginEnd = buffer.find(SOH);
+    if (beginEnd == std::string_view::npos) {
+        return buffer.size() > maxHeaderLength ? std::string::npos : 0;
     }
-    sum %= 256;
-    
-    std::ostringstream oss;
-    oss << std::setfill('0') << std::setw(3) << sum;
-    return oss.str();
+
+    size_t pos = beginEnd + 1;
+    if (buffer.size() < pos + 2) return 0;
+    if (buffer[pos] != '9' || buffer[pos + 1] != '=') return std::string::npos;
+    pos += 2;
+
+    size_t bodyLength = 0;
+    size_t digits = 0;
+    while (pos < buffer.size() && buffer[pos] != SOH) {
+        char c = buffer[pos];
+        if (c < '0' || c > '9' || ++digits > 7) return std::string::npos;
+        bodyLength = bodyLength * 10 + static_cast<size_t>(c - '0');
+        ++pos;
+    }
+    if (pos >= buffer.size()) {
+        return pos > maxHeaderLength ? std::string::npos : 0;
+    }
+    if (digits == 0) return std::string::npos;
+
+    size_t checksumStart = pos + 1 + bodyLength;
+    size_t total = checksumStart + checksumLength;
+    if (buffer.size() < total) return 0;
+    if (buffer.compare(checksumStart, 3, "10=") != 0 || buffer[total - 1] != SOH) {
+        return std::string::npos;
+    }
+    return total;
 }
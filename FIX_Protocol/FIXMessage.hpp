@@ -2,9 +2,9 @@
 #define FIXMESSAGE_HPP
 
 #include <string>
-#include <unordered_map>
 #include <sstream>
 #include <vector>
+#include <string_view>
 
 class FIXMessage {
 public:
@@ -32,6 +32,8 @@ public:
     static constexpr int LeavesQty = 151;
     static constexpr int CumQty = 14;
     static constexpr int AvgPx = 6;
+    static constexpr int LastShares = 32;
+    static constexpr int LastPx = 31;
     static constexpr int Text = 58;
     static constexpr int OrigClOrdID = 41;
     
@@ -63,12 +65,12 @@ public:
     FIXMessage();
     FIXMessage(const std::string& rawMessage);
     
-    void setField(int tag, const std::string& value);
+    void setField(int tag, std::string_view value);
     void setField(int tag, int value);
     void setField(int tag, double value);
     void setField(int tag, char value);
     
-    std::string getField(int tag) const;
+    const std::string& getField(int tag) const;
     int getFieldAsInt(int tag) const;
     double getFieldAsDouble(int tag) const;
     char getFieldAsChar(int tag) const;
@@ -76,15 +78,35 @@ public:
     bool hasField(int tag) const;
     
     std::string encode() const;
-    bool parse(const std::string& rawMessage);
+    // Append the encoded message to output without intermediate strings
+    void encodeTo(std::string& output) const;
+    bool parse(std::string_view rawMessage);
+    
+    // Drop all fields but keep their storage for the next message
+    void clear();
     
     char getMsgType() const;
     void setMsgType(char type);
     
+    // Length of the complete message at the front of a byte stream, 0 if more
+    // bytes are needed, or std::string::npos if the stream is not framed FIX.
+    static size_t frameLength(std::string_view buffer);
+    
 private:
-    std::unordered_map<int, std::string> fields;
+    struct Field {
+        int tag;
+        std::string value;
+    };
+    
+    // Fields in insertion order. Slots past fieldCount are spare storage that
+    // clear()/parse() recycle, so a reused message stops allocating.
+    std::vector<Field> fields;
+    size_t fieldCount = 0;
+    
+    Field* findField(int tag);
+    const Field* findField(int tag) const;
+    std::string& fieldSlot(int tag);
     
-    std::string calculateChecksum(const std::string& message) const;
     std::string getCurrentTimestamp() const;
     static constexpr char SOH = '\x01'; // FIX field delimiter
 };
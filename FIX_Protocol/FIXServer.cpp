@@ -0,0 +1,54 @@
+#include "FIXAcceptor.hpp"
+#include "FIXEngine.hpp"
+#include "../Limit_Order_Book/BookManager.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+// Usage: FIXServer [port] [ioThreads]
+namespace {
+    std::atomic<bool> stopRequested{false};
+
+    void handleSignal(int) {
+        stopRequested.store(true);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = argc > 1 ? static_cast<uint16_t>(std::atoi(argv[1])) : 9878;
+    int ioThreads = argc > 2 ? std::atoi(argv[2]) : 2;
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    // One book per symbol, created as symbols first trade
+    BookManager books;
+    FIXEngine engine(&books);
+    FIXAcceptor acceptor(&engine, port, ioThreads);
+
+    if (!acceptor.start()) {
+        return 1;
+    }
+    std::cout << "FIX acceptor listening on port " << acceptor.getPort()
+              << " with " << ioThreads << " I/O threads" << std::endl;
+
+    uint64_t lastCount = 0;
+    while (!stopRequested.load()) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        uint64_t count = acceptor.getMessagesProcessed();
+        if (count != lastCount) {
+            std::cout << "sessions: " << acceptor.getSessionCount()
+                      << ", messages/sec: " << (count - lastCount) << std::endl;
+            lastCount = count;
+        }
+    }
+
+    acceptor.stop();
+    std::cout << "Processed " << acceptor.getMessagesProcessed() << " messages on "
+              << books.getActiveBookCount() << " books" << std::endl;
+    return 0;
+}
@@ -371,4 +371,48 @@ void GenerateOrders::createInitialOrders(int numberOfOrders, int centreOfBook)
 
     file.close();
     std::cout << "Orders written to initialOrders.txt successfully!" << std::endl;
-}
\ No newline at end of file
+}
+
+std::vector<OrderCommand> generateCommandLog(int symbols, size_t count, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> symbolDist(0, symbols - 1);
+    std::uniform_int_distribution<> percent(0, 99);
+    std::uniform_int_distribution<> sharesDist(1, 100);
+    std::normal_distribution<> priceDist(300, 10);
+
+    std::vector<int> nextOrderId(symbols, 1);
+    std::vector<std::vector<int>> live(symbols);
+    std::vector<OrderCommand> log;
+    log.reserve(count);
+
+    while (log.size() < count) {
+        OrderCommand command;
+        command.symbolId = symbolDist(gen);
+        std::vector<int>& orders = live[command.symbolId];
+        int roll = percent(gen);
+
+        if (roll < 60 || orders.empty()) {
+            command.type = OrderCommand::AddLimit;
+            command.orderId = nextOrderId[command.symbolId]++;
+            command.buyOrSell = percent(gen) < 50;
+            command.shares = sharesDist(gen);
+            command.limitPrice = static_cast<int>(priceDist(gen));
+            orders.push_back(command.orderId);
+        } else if (roll < 85) {
+            std::uniform_int_distribution<size_t> pick(0, orders.size() - 1);
+            size_t index = pick(gen);
+            command.type = OrderCommand::CancelLimit;
+            command.orderId = orders[index];
+            orders[index] = orders.back();
+            orders.pop_back();
+        } else {
+            command.type = OrderCommand::Market;
+            command.orderId = nextOrderId[command.symbolId]++;
+            command.buyOrSell = percent(gen) < 50;
+            command.shares = sharesDist(gen);
+        }
+        log.push_back(command);
+    }
+    return log;
+}
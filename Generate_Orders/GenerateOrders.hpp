@@ -3,6 +3,9 @@
 
 #include <random>
 #include <fstream>
+#include <vector>
+
+#include "../Process_Orders/OrderCommand.hpp"
 
 class Book;
 
@@ -34,4 +37,9 @@ public:
     void createOrders(int numberOfOrders);
 };
 
+// Synthetic multi-symbol command log for replay benchmarks, generated in
+// memory: 60% limit adds, 25% cancels of live orders, 15% market orders,
+// spread uniformly over symbol ids [0, symbols). Order ids are per symbol.
+std::vector<OrderCommand> generateCommandLog(int symbols, size_t count, unsigned seed);
+
 #endif
\ No newline at end of file
@@ -6,68 +6,125 @@
 #include <random>
 #include <iterator>
 #include <cassert>
+#include <stdexcept>
+
+namespace {
+    // Orders ahead whose index slots appendLevel() prefetches
+    constexpr size_t indexPrefetchDistance = 32;
+}
+
 //Test
 Book::Book() = default;
 // When deleting the book need to ensure all used memory is freed
 Book::~Book()
 {
-    for (auto& pair: orderMap) {
-        delete pair.second;
+    for (Order* order : orderIndex) {
+        if (order) orderPool.destroy(order);
+    }
+    for (auto* limits : {&buyLimits, &sellLimits, &stopBuyLimits, &stopSellLimits}) {
+        for (Limit* level : *limits) {
+            limitPool.destroy(level);
+        }
     }
 }
 
-Limit& Book::getOrCreateLimit(std::vector<Limit>& limits, int price, bool descending, bool createIfNotFound) {
+void Book::reserve(size_t orders, size_t priceLevels, size_t maxOrderId) {
+    // Index slots are written now, so their pages are touched on this thread
+    size_t ids = std::max(orders, maxOrderId) + 1;
+    if (orderIndex.size() < ids) orderIndex.resize(ids, nullptr);
+    orderPool.reserve(orders);
+    limitPool.reserve(priceLevels * 2);
+    buyLimits.reserve(priceLevels);
+    sellLimits.reserve(priceLevels);
+}
+
+void Book::removeLevelIfEmpty(Limit* level) {
+    if (!level->isEmpty()) return;
+    for (auto* side : {&buyLimits, &sellLimits, &stopBuyLimits, &stopSellLimits}) {
+        auto it = std::find(side->begin(), side->end(), level);
+        if (it != side->end()) {
+            removeEmptyLimit(*side, std::distance(side->begin(), it));
+            return;
+        }
+    }
+}
+
+void Book::beginEvent() {
+    executedOrdersCount = 0;
+    fills.clear();
+    eventLevels.clear();
+    orderEvents.clear();
+}
+
+bool Book::isRestingLimit(const Order& order) const {
+    const Limit* level = order.parentLimit;
+    return level && findLimit(order.getBuyOrSell(), level->getLimitPrice()) == level;
+}
+
+Limit& Book::getOrCreateLimit(std::vector<Limit*>& limits, int price, bool descending, bool createIfNotFound) {
     if (limits.empty()) {
         if (!createIfNotFound) {
             throw std::runtime_error("Limit not found and createIfNotFound = false");
         }
-        limits.emplace_back(price);
-        return limits.back();
+        limits.push_back(limitPool.create(price));
+        return *limits.back();
     }
 
-    auto cmp = [descending](const Limit& l, int p) {
-        return descending ? (l.getLimitPrice() > p) : (l.getLimitPrice() < p);
+    auto cmp = [descending](const Limit* l, int p) {
+        return descending ? (l->getLimitPrice() > p) : (l->getLimitPrice() < p);
     };
     auto it = std::lower_bound(limits.begin(), limits.end(), price, cmp);
-    if (it != limits.end() && it->getLimitPrice() == price) {
-        return *it;
+    if (it != limits.end() && (*it)->getLimitPrice() == price) {
+        return **it;
     }
 
     if (!createIfNotFound) {
         throw std::runtime_error("Limit not found");
     }
-    return *limits.insert(it, Limit(price));
+    return **limits.insert(it, limitPool.create(price));
+}
+
+const Limit* Book::findLimit(bool buySide, int price) const {
+    const std::vector<Limit*>& limits = buySide ? buyLimits : sellLimits;
+    auto cmp = [buySide](const Limit* l, int p) {
+        return buySide ? (l->getLimitPrice() > p) : (l->getLimitPrice() < p);
+    };
+    auto it = std::lower_bound(limits.begin(), limits.end(), price, cmp);
+    return (it != limits.end() && (*it)->getLimitPrice() == price) ? *it : nullptr;
 }
 
-void Book::removeEmptyLimit(std::vector<Limit>& limits, size_t index) {
+void Book::removeEmptyLimit(std::vector<Limit*>& limits, size_t index) {
     if (index < limits.size()) {
+        limitPool.destroy(limits[index]);
         limits.erase(limits.begin() + index);
     }
 }
 
 int Book::crossLimitOrder(int orderId, bool buyOrSell, int shares, int LimitPrice) {
-    std::vector<Limit>& opposite = buyOrSell ? sellLimits : buyLimits;
+    std::vector<Limit*>& opposite = buyOrSell ? sellLimits : buyLimits;
     size_t i = 0;
     while (shares > 0 && i < opposite.size()) {
-        Limit& level = opposite[i];
+        Limit& level = *opposite[i];
         int priceLevel = level.getLimitPrice();
         if ((buyOrSell && priceLevel > LimitPrice) || (!buyOrSell && priceLevel < LimitPrice)) {
             break;
         }
+        touchLevel(!buyOrSell, priceLevel);
 
         Order* current = level.getHeadOrder();
         while (current && shares > 0) {
             int fillSize = std::min(shares, current->getShares());
             current->partiallyFillOrder(fillSize);
-            level.partiallyFillTotalVolume(fillSize);
             shares -= fillSize;
             executedOrdersCount++;
+            fills.push_back(Fill{current->getOrderId(), orderId, level.getLimitPrice(), fillSize, buyOrSell});
+            recordOrderEvent(OrderEvent::Execute, !buyOrSell, current->getOrderId(), fillSize, level.getLimitPrice(), orderId);
 
             if (current->getShares() == 0) {
                 Order* next = current->nextOrder;
                 level.removeOrder(current);
-                orderMap.erase(current->getOrderId());
-                delete current;
+                unindexOrder(current->getOrderId());
+                orderPool.destroy(current);
                 current = next;
             } else {
                 current = current->nextOrder;
@@ -84,8 +141,8 @@ int Book::crossLimitOrder(int orderId, bool buyOrSell, int shares, int LimitPric
 }
 
 int Book::crossStopOrder(int orderId, bool buyOrSell, int shares, int stopPrice) {
-    Limit* bestAsk = sellLimits.empty() ? nullptr : &sellLimits.front();
-    Limit* bestBid = buyLimits.empty() ? nullptr : &buyLimits.front();
+    Limit* bestAsk = sellLimits.empty() ? nullptr : sellLimits.front();
+    Limit* bestBid = buyLimits.empty() ? nullptr : buyLimits.front();
 
     if (buyOrSell) { // Buy stop
         if (bestAsk && stopPrice <= bestAsk->getLimitPrice()) {
@@ -111,8 +168,8 @@ int Book::crossMarketLimitOrder(Order* order) {
 
 // Immediate check for stop-limit trigger
 int Book::crossStopLimit(int orderId, bool buyOrSell, int shares, int limitPrice, int stopPrice) {
-    Limit* bestAsk = sellLimits.empty() ? nullptr : &sellLimits.front();
-    Limit* bestBid = buyLimits.empty() ? nullptr : &buyLimits.front();
+    Limit* bestAsk = sellLimits.empty() ? nullptr : sellLimits.front();
+    Limit* bestBid = buyLimits.empty() ? nullptr : buyLimits.front();
 
     if (buyOrSell) {
         if (bestAsk && stopPrice <= bestAsk->getLimitPrice()) {
@@ -130,25 +187,27 @@ int Book::crossStopLimit(int orderId, bool buyOrSell, int shares, int limitPrice
 }
 
 void Book::executeMarketOrder(int orderId, bool buyOrSell, int shares) {
-    std::vector<Limit>& opposite = buyOrSell ? sellLimits : buyLimits;
+    std::vector<Limit*>& opposite = buyOrSell ? sellLimits : buyLimits;
 
     size_t i = 0;
     while (shares > 0 && i < opposite.size()) {
-        Limit& level = opposite[i];
+        Limit& level = *opposite[i];
+        touchLevel(!buyOrSell, level.getLimitPrice());
         Order* current = level.getHeadOrder();
 
         while (current && shares > 0) {
             int fillSize = std::min(shares, current->getShares());
             current->partiallyFillOrder(fillSize);
-            level.partiallyFillTotalVolume(fillSize);
             shares -= fillSize;
             executedOrdersCount++;
+            fills.push_back(Fill{current->getOrderId(), orderId, level.getLimitPrice(), fillSize, buyOrSell});
+            recordOrderEvent(OrderEvent::Execute, !buyOrSell, current->getOrderId(), fillSize, level.getLimitPrice(), orderId);
 
             if (current->getShares() == 0) {
                 Order* next = current->nextOrder;
                 level.removeOrder(current);
-                orderMap.erase(current->getOrderId());
-                delete current;
+                unindexOrder(current->getOrderId());
+                orderPool.destroy(current);
                 current = next;
             } else {
                 current = current->nextOrder;
@@ -168,23 +227,23 @@ void Book::convertStopLimitToLimit(Order* order, bool buyOrSell) {
 
     if (remaining > 0) {
         order->setShares(remaining);
-        std::vector<Limit>& side = buyOrSell ? buyLimits : sellLimits;
+        std::vector<Limit*>& side = buyOrSell ? buyLimits : sellLimits;
         Limit& level = getOrCreateLimit(side, order->getLimit(), buyOrSell);
         level.appendOrder(order);
+        touchLevel(buyOrSell, order->getLimit());
+        recordOrderEvent(OrderEvent::Add, buyOrSell, order->getOrderId(), remaining, order->getLimit());
     } else {
         // Fully filled
-        orderMap.erase(order->getOrderId());
-        delete order;
+        unindexOrder(order->getOrderId());
+        orderPool.destroy(order);
     }
 }
 
 void Book::triggerStopOrders() {
-    Limit* bestAsk = sellLimits.empty() ? nullptr : &sellLimits.front();
-    Limit* bestBid = buyLimits.empty() ? nullptr : &buyLimits.front();
-
-    // Trigger buy stops
+    // Trigger buy stops (best prices are re-read as triggered orders consume levels)
     while (!stopBuyLimits.empty()) {
-        Limit& level = stopBuyLimits.front();
+        Limit* bestAsk = sellLimits.empty() ? nullptr : sellLimits.front();
+        Limit& level = *stopBuyLimits.front();
         if (bestAsk == nullptr || level.getLimitPrice() > bestAsk->getLimitPrice()) break;
 
         Order* head = level.getHeadOrder();
@@ -193,23 +252,24 @@ void Book::triggerStopOrders() {
 
         if (head->getLimit() == 0) {
             // Stop market
-            executeMarketOrder(0, true, head->getShares());
-            orderMap.erase(head->getOrderId());
-            delete head;
+            executeMarketOrder(head->getOrderId(), true, head->getShares());
+            unindexOrder(head->getOrderId());
+            orderPool.destroy(head);
         } else {
             // Stop-limit
             convertStopLimitToLimit(head, true);
         }
 
         if (level.isEmpty()) {
-            stopBuyLimits.erase(stopBuyLimits.begin());
+            removeEmptyLimit(stopBuyLimits, 0);
         }
         head = next;
     }
 
     // Trigger sell stops
     while (!stopSellLimits.empty()) {
-        Limit& level = stopSellLimits.front();
+        Limit* bestBid = buyLimits.empty() ? nullptr : buyLimits.front();
+        Limit& level = *stopSellLimits.front();
         if (bestBid == nullptr || level.getLimitPrice() < bestBid->getLimitPrice()) break;
 
         Order* head = level.getHeadOrder();
@@ -217,37 +277,41 @@ void Book::triggerStopOrders() {
         level.removeOrder(head);
 
         if (head->getLimit() == 0) {
-            executeMarketOrder(0, false, head->getShares());
-            orderMap.erase(head->getOrderId());
-            delete head;
+            executeMarketOrder(head->getOrderId(), false, head->getShares());
+            unindexOrder(head->getOrderId());
+            orderPool.destroy(head);
         } else {
             convertStopLimitToLimit(head, false);
         }
 
         if (level.isEmpty()) {
-            stopSellLimits.erase(stopSellLimits.begin());
+            removeEmptyLimit(stopSellLimits, 0);
         }
         head = next;
     }
 }
 
 void Book::marketOrder(int orderId, bool buyOrSell, int shares) {
-    executedOrdersCount = 0;
+    beginEvent();
+    checkOrderId(orderId);
     executeMarketOrder(orderId, buyOrSell, shares);
     triggerStopOrders();
 }
 
 void Book::addLimitOrder(int orderId, bool buyOrSell, int shares, int limitPrice) {
-    executedOrdersCount = 0;
+    beginEvent();
+    checkNewOrderId(orderId);
     int remaining = crossLimitOrder(orderId, buyOrSell, shares, limitPrice);
 
     if (remaining > 0) {
-        Order* newOrder = new Order(orderId, buyOrSell, remaining, limitPrice);
-        orderMap[orderId] = newOrder;
+        Order* newOrder = orderPool.create(orderId, buyOrSell, remaining, limitPrice);
+        indexOrder(orderId, newOrder);
 
-        std::vector<Limit>& side = buyOrSell ? buyLimits : sellLimits;
+        std::vector<Limit*>& side = buyOrSell ? buyLimits : sellLimits;
         Limit& level = getOrCreateLimit(side, limitPrice, buyOrSell);
         level.appendOrder(newOrder);
+        touchLevel(buyOrSell, limitPrice);
+        recordOrderEvent(OrderEvent::Add, buyOrSell, orderId, remaining, limitPrice);
     }
 
     if (remaining < shares) {
@@ -256,74 +320,142 @@ void Book::addLimitOrder(int orderId, bool buyOrSell, int shares, int limitPrice
 }
 
 void Book::cancelLimitOrder(int orderId) {
-    executedOrdersCount = 0;
+    beginEvent();
     Order* order = searchOrderMap(orderId);
     if (!order || !order->parentLimit) return;
 
     Limit* level = order->parentLimit;
+    // Stop and stop-limit cancels come through here as well; only resting
+    // limit orders are visible
+    if ((tracksLevels() || trackOrderEvents) && isRestingLimit(*order)) {
+        touchLevel(order->getBuyOrSell(), level->getLimitPrice());
+        recordOrderEvent(OrderEvent::Delete, order->getBuyOrSell(), orderId, order->getShares(), level->getLimitPrice());
+    }
     level->removeOrder(order);
-    orderMap.erase(orderId);
-    delete order;
-
-    if (level->isEmpty()) {
-        std::vector<Limit>* side = nullptr;
-
-        if (std::find_if(buyLimits.begin(), buyLimits.end(), 
-                         [level](const Limit& l) { return &l == level; }) != buyLimits.end()) {
-            side = &buyLimits;
-        } else if (std::find_if(sellLimits.begin(), sellLimits.end(), 
-                                [level](const Limit& l) { return &l == level; }) != sellLimits.end()) {
-            side = &sellLimits;
-        }
+    unindexOrder(orderId);
+    orderPool.destroy(order);
 
-        if (side) {
-            auto it = std::find_if(side->begin(), side->end(), 
-                                   [level](const Limit& l) { return &l == level; });
-            removeEmptyLimit(*side, std::distance(side->begin(), it));
-        }
-    }
+    removeLevelIfEmpty(level);
 }
 
 void Book::modifyLimitOrder(int orderId, int newShares, int newLimit) {
-    executedOrdersCount = 0;
+    beginEvent();
+    checkShares(newShares);
     Order* order = searchOrderMap(orderId);
     if (!order || !order->parentLimit) return;
 
     Limit* oldLevel = order->parentLimit;
     bool isBuy = order->getBuyOrSell();
+    // A stop modified through here becomes visible for the first time
+    bool wasVisible = trackOrderEvents && isRestingLimit(*order);
 
     // Remove from old level (keep object alive)
+    touchLevel(isBuy, oldLevel->getLimitPrice());
     oldLevel->removeOrder(order);
 
-    // Clean up empty level
-    if (oldLevel->isEmpty()) {
-        std::vector<Limit>& oldSide = isBuy ? buyLimits : sellLimits;
-        auto it = std::find_if(oldSide.begin(), oldSide.end(), [oldLevel](const Limit& l) { return &l == oldLevel; });
-        if (it != oldSide.end()) {
-            removeEmptyLimit(oldSide, std::distance(oldSide.begin(), it));
-        }
-    }
+    // Clean up empty level (a stop's, when a stop is modified through here)
+    removeLevelIfEmpty(oldLevel);
 
     // Update using existing method
     order->modifyOrder(newShares, newLimit);
 
     // Add to new level
-    std::vector<Limit>& newSide = isBuy ? buyLimits : sellLimits;
+    std::vector<Limit*>& newSide = isBuy ? buyLimits : sellLimits;
     Limit& newLevel = getOrCreateLimit(newSide, newLimit, isBuy);
     newLevel.appendOrder(order);
+    touchLevel(isBuy, newLimit);
+    recordOrderEvent(wasVisible ? OrderEvent::Replace : OrderEvent::Add, isBuy, orderId, order->getShares(), newLimit);
 
     triggerStopOrders();
 }
 
+bool Book::insertRestingOrder(int orderId, bool buyOrSell, int shares, int limitPrice) {
+    beginEvent();
+    if (!isValidOrderId(orderId) || shares <= 0 || searchOrderMap(orderId)) return false;
+
+    Order* newOrder = orderPool.create(orderId, buyOrSell, shares, limitPrice);
+    indexOrder(orderId, newOrder);
+    std::vector<Limit*>& side = buyOrSell ? buyLimits : sellLimits;
+    Limit& level = getOrCreateLimit(side, limitPrice, buyOrSell);
+    level.appendOrder(newOrder);
+    touchLevel(buyOrSell, limitPrice);
+    recordOrderEvent(OrderEvent::Add, buyOrSell, orderId, shares, limitPrice);
+    return true;
+}
+
+bool Book::executeRestingOrder(int orderId, int shares, int takerId) {
+    beginEvent();
+    Order* order = searchOrderMap(orderId);
+    if (!order || !isRestingLimit(*order) || shares <= 0 || shares > order->getShares()) return false;
+
+    Limit* level = order->parentLimit;
+    bool isBuy = order->getBuyOrSell();
+    int price = level->getLimitPrice();
+    touchLevel(isBuy, price);
+    order->partiallyFillOrder(shares);
+    executedOrdersCount++;
+    fills.push_back(Fill{orderId, takerId, price, shares, !isBuy});
+    recordOrderEvent(OrderEvent::Execute, isBuy, orderId, shares, price, takerId);
+
+    if (order->getShares() == 0) {
+        level->removeOrder(order);
+        unindexOrder(orderId);
+        orderPool.destroy(order);
+        if (level->isEmpty()) {
+            // Executions are almost always at the front of the book
+            std::vector<Limit*>& side = isBuy ? buyLimits : sellLimits;
+            auto it = std::find(side.begin(), side.end(), level);
+            removeEmptyLimit(side, std::distance(side.begin(), it));
+        }
+    }
+    return true;
+}
+
+bool Book::appendLevel(bool stop, bool buyOrSell, int price, const RestingOrder* orders, size_t count) {
+    std::vector<Limit*>& side = stop ? (buyOrSell ? stopBuyLimits : stopSellLimits) : (buyOrSell ? buyLimits : sellLimits);
+    if (count == 0) return false;
+    if (!side.empty()) {
+        int worst = side.back()->getLimitPrice();
+        if (buyOrSell ? price >= worst : price <= worst) return false;
+    }
+
+    Limit* level = limitPool.create(price);
+    for (size_t i = 0; i < count; ++i) {
+        // Ids in a queue are scattered over the index; the ids ahead are
+        // known, so fetch their slots while earlier orders are placed
+        if (i + indexPrefetchDistance < count) {
+            int ahead = orders[i + indexPrefetchDistance].orderId;
+            if (ahead >= 0 && static_cast<size_t>(ahead) < orderIndex.size()) __builtin_prefetch(&orderIndex[ahead], 1);
+        }
+        const RestingOrder& resting = orders[i];
+        if (!isValidOrderId(resting.orderId) || resting.shares <= 0 || searchOrderMap(resting.orderId)) {
+            // Undo the orders already placed
+            while (Order* order = level->getHeadOrder()) {
+                level->removeOrder(order);
+                unindexOrder(order->getOrderId());
+                orderPool.destroy(order);
+            }
+            limitPool.destroy(level);
+            return false;
+        }
+        Order* order = orderPool.create(resting.orderId, buyOrSell, resting.shares, stop ? resting.limitPrice : price);
+        indexOrder(resting.orderId, order);
+        level->appendOrder(order);
+    }
+    side.push_back(level);
+    return true;
+}
+
 void Book::addStopOrder(int orderId, bool buyOrSell, int shares, int stopPrice) {
-    executedOrdersCount = 0;
+    beginEvent();
+    checkNewOrderId(orderId);
     int remaining = crossStopOrder(orderId, buyOrSell, shares, stopPrice);
 
     if (remaining > 0) {
-        Order* newOrder = new Order(orderId, buyOrSell, remaining, 0); // limit = 0 for market stop
-        orderMap[orderId] = newOrder;
+        Order* newOrder = orderPool.create(orderId, buyOrSell, remaining, 0); // limit = 0 for market stop
+        indexOrder(orderId, newOrder);
 
-        std::vector<Limit>& side = buyOrSell ? stopBuyLimits : stopSellLimits;
+        std::vector<Limit*>& side = buyOrSell ? stopBuyLimits : stopSellLimits;
         Limit& level = getOrCreateLimit(side, stopPrice, buyOrSell);
         level.appendOrder(newOrder);
     }
@@ -334,7 +466,8 @@ void Book::cancelStopOrder(int orderId) {
 }
 
 void Book::modifyStopOrder(int orderId, int newShares, int newStopPrice) {
-    executedOrdersCount = 0;
+    beginEvent();
+    checkShares(newShares);
     Order* order = searchOrderMap(orderId);
     if (!order || !order->parentLimit) return;
 
@@ -343,30 +476,25 @@ void Book::modifyStopOrder(int orderId, int newShares, int newStopPrice) {
 
     oldLevel->removeOrder(order);
 
-    if (oldLevel->isEmpty()) {
-        std::vector<Limit>& oldSide = isBuy ? stopBuyLimits : stopSellLimits;
-        auto it = std::find_if(oldSide.begin(), oldSide.end(), [oldLevel](const Limit& l) { return &l == oldLevel; });
-        if (it != oldSide.end()) {
-            removeEmptyLimit(oldSide, std::distance(oldSide.begin(), it));
-        }
-    }
+    removeLevelIfEmpty(oldLevel);
 
     order->modifyOrder(newShares, newStopPrice);  // stop price goes into limit field
 
-    std::vector<Limit>& newSide = isBuy ? stopBuyLimits : stopSellLimits;
+    std::vector<Limit*>& newSide = isBuy ? stopBuyLimits : stopSellLimits;
     Limit& newLevel = getOrCreateLimit(newSide, newStopPrice, isBuy);
     newLevel.appendOrder(order);
 }
 
 void Book::addStopLimitOrder(int orderId, bool buyOrSell, int shares, int limitPrice, int stopPrice) {
-    executedOrdersCount = 0;
+    beginEvent();
+    checkNewOrderId(orderId);
     int remaining = crossStopLimit(orderId, buyOrSell, shares, limitPrice, stopPrice);
 
     if (remaining > 0) {
-        Order* newOrder = new Order(orderId, buyOrSell, remaining, limitPrice);
-        orderMap[orderId] = newOrder;
+        Order* newOrder = orderPool.create(orderId, buyOrSell, remaining, limitPrice);
+        indexOrder(orderId, newOrder);
 
-        std::vector<Limit>& side = buyOrSell ? stopBuyLimits : stopSellLimits;
+        std::vector<Limit*>& side = buyOrSell ? stopBuyLimits : stopSellLimits;
         Limit& level = getOrCreateLimit(side, stopPrice, buyOrSell);
         level.appendOrder(newOrder);
     }
@@ -377,7 +505,8 @@ void Book::cancelStopLimitOrder(int orderId) {
 }
 
 void Book::modifyStopLimitOrder(int orderId, int newShares, int newLimitPrice, int newStopPrice) {
-    executedOrdersCount = 0;
+    beginEvent();
+    checkShares(newShares);
     Order* order = searchOrderMap(orderId);
     if (!order || !order->parentLimit) return;
 
@@ -386,50 +515,80 @@ void Book::modifyStopLimitOrder(int orderId, int newShares, int newLimitPrice, i
 
     oldLevel->removeOrder(order);
 
-    if (oldLevel->isEmpty()) {
-        std::vector<Limit>& oldSide = isBuy ? stopBuyLimits : stopSellLimits;
-        auto it = std::find_if(oldSide.begin(), oldSide.end(), [oldLevel](const Limit& l) { return &l == oldLevel; });
-        if (it != oldSide.end()) {
-            removeEmptyLimit(oldSide, std::distance(oldSide.begin(), it));
-        }
-    }
+    removeLevelIfEmpty(oldLevel);
 
     order->modifyOrder(newShares, newLimitPrice);
 
-    std::vector<Limit>& newSide = isBuy ? stopBuyLimits : stopSellLimits;
+    std::vector<Limit*>& newSide = isBuy ? stopBuyLimits : stopSellLimits;
     Limit& newLevel = getOrCreateLimit(newSide, newStopPrice, isBuy);
     newLevel.appendOrder(order);
 }
 
+void Book::checkOrderId(int orderId) const {
+    if (!isValidOrderId(orderId)) throw std::invalid_argument("Order id out of range");
+}
+
+void Book::checkNewOrderId(int orderId) const {
+    checkOrderId(orderId);
+    if (orderIndex.size() > static_cast<size_t>(orderId) && orderIndex[orderId]) {
+        throw std::invalid_argument("Order id already in use");
+    }
+}
+
+void Book::checkShares(int shares) {
+    if (shares <= 0) throw std::invalid_argument("Order shares must be positive");
+}
+
+void Book::indexOrder(int orderId, Order* order) {
+    assert(isValidOrderId(orderId));
+    if (static_cast<size_t>(orderId) >= orderIndex.size()) {
+        orderIndex.resize(std::max<size_t>(orderId + 1, orderIndex.size() * 2), nullptr);
+    }
+    orderIndex[orderId] = order;
+}
+
+void Book::unindexOrder(int orderId) {
+    if (orderId >= 0 && static_cast<size_t>(orderId) < orderIndex.size()) {
+        orderIndex[orderId] = nullptr;
+    }
+}
+
+int Book::getMaxOrderId() const {
+    for (size_t id = orderIndex.size(); id-- > 0;) {
+        if (orderIndex[id]) return static_cast<int>(id);
+    }
+    return 0;
+}
+
 Order* Book::searchOrderMap(int orderId) const {
-    auto it = orderMap.find(orderId);
-    return it != orderMap.end() ? it->second : nullptr;
+    if (orderId < 0 || static_cast<size_t>(orderId) >= orderIndex.size()) return nullptr;
+    return orderIndex[orderId];
 }
 
 void Book::printBookEdges() const {
-    int bestBid = buyLimits.empty() ? 0 : buyLimits.front().getLimitPrice();
-    int bestAsk = sellLimits.empty() ? 0 : sellLimits.front().getLimitPrice();
+    int bestBid = buyLimits.empty() ? 0 : buyLimits.front()->getLimitPrice();
+    int bestAsk = sellLimits.empty() ? 0 : sellLimits.front()->getLimitPrice();
     std::cout << "Best Bid: " << bestBid << " | Best Ask: " << bestAsk << std::endl;
 }
 
 void Book::printOrderBook() const {
     std::cout << "=== BUY SIDE (best to worst) ===\n";
     for (const auto& level : buyLimits) {
-        level.print();
-        level.printForward();
+        level->print();
+        level->printForward();
     }
 
     std::cout << "\n=== SELL SIDE (best to worst) ===\n";
     for (const auto& level : sellLimits) {
-        level.print();
-        level.printForward();
+        level->print();
+        level->printForward();
     }
 
     std::cout << "\n=== STOP BUY LEVELS ===\n";
-    for (const auto& level : stopBuyLimits) level.print();
+    for (const auto& level : stopBuyLimits) level->print();
 
     std::cout << "\n=== STOP SELL LEVELS ===\n";
-    for (const auto& level : stopSellLimits) level.print();
+    for (const auto& level : stopSellLimits) level->print();
 }
 
 void Book::printOrder(int orderId) const {
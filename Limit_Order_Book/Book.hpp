@@ -1,23 +1,87 @@
 #ifndef BOOK_HPP
 #define BOOK_HPP
 
-#include <unordered_map>
+#include <algorithm>
 #include <vector>
 #include <random>
 #include <unordered_set>
 
 #include "Limit.hpp"
+#include "ObjectPool.hpp"
 #include "Order.hpp"
 
+// One trade between a resting (maker) order and an incoming (taker) order
+struct Fill {
+    int makerId;
+    int takerId;
+    int price;
+    int shares;
+    bool takerBuys;  // aggressor side
+};
+
+// A change to one resting (visible) limit order, for order-by-order feeds.
+// Stop orders are not visible until they trigger and rest as limits.
+struct OrderEvent {
+    enum Type : uint8_t {
+        Add,      // order rests at price with shares
+        Execute,  // resting order traded shares at price against takerId
+        Delete,   // order cancelled
+        Replace   // order moved to price with shares, at the back of the queue
+    };
+
+    Type type;
+    bool buySide;
+    int orderId;
+    int shares;
+    int price;
+    int takerId;  // Execute only
+};
+
+// One order of a level being restored in bulk, in queue order
+struct RestingOrder {
+    int orderId;
+    int shares;
+    int limitPrice;  // stop ladders: the stop-limit price, 0 for a stop market
+};
+
+// A buy or sell price level that an order call may have changed
+struct TouchedLevel {
+    bool buySide;
+    int price;
+};
+
 class Book {
 private:
-    std::vector<Limit> buyLimits;
-    std::vector<Limit> sellLimits;
-    std::vector<Limit> stopBuyLimits;
-    std::vector<Limit> stopSellLimits;
-    std::unordered_map<int, Order*> orderMap;
-    Limit& getOrCreateLimit(std::vector<Limit>& limits, int price, bool descending, bool createIfNotFound = true);
-    void removeEmptyLimit(std::vector<Limit>& limits, size_t index);
+    // Orders and levels come from the book's own pools, so their memory is
+    // placed by (and local to) the thread that runs the book. The pools grow
+    // with the book, so thousands of idle symbols stay cheap.
+    ObjectPool<Order> orderPool{1024};
+    ObjectPool<Limit> limitPool{256};
+
+    // Sorted best-first. Limits live in limitPool so that inserting or erasing
+    // a price level never moves the Limit an Order's parentLimit points at.
+    std::vector<Limit*> buyLimits;
+    std::vector<Limit*> sellLimits;
+    std::vector<Limit*> stopBuyLimits;
+    std::vector<Limit*> stopSellLimits;
+    // Order ids are dense, so orders are indexed directly by id. Ids outside
+    // [0, orderIdLimit] are refused so a bad id cannot grow the index
+    // without bound.
+    std::vector<Order*> orderIndex;
+    int orderIdLimit = defaultOrderIdLimit;
+    bool isValidOrderId(int orderId) const { return orderId >= 0 && orderId <= orderIdLimit; }
+    // Throw std::invalid_argument for an id the index will not take, for a
+    // new order's id already in use, and for a modify to no shares. Each
+    // would leave a state a snapshot cannot restore.
+    void checkOrderId(int orderId) const;
+    void checkNewOrderId(int orderId) const;
+    static void checkShares(int shares);
+    void indexOrder(int orderId, Order* order);
+    void unindexOrder(int orderId);
+    Limit& getOrCreateLimit(std::vector<Limit*>& limits, int price, bool descending, bool createIfNotFound = true);
+    void removeEmptyLimit(std::vector<Limit*>& limits, size_t index);
+    // Remove level from whichever ladder holds it once it has no orders
+    void removeLevelIfEmpty(Limit* level);
     void triggerStopOrders();
 
     int crossLimitOrder(int orderId, bool buyOrSell, int shares, int limitPrice);
@@ -27,10 +91,53 @@ private:
     void executeMarketOrder(int orderId, bool buyOrSell, int shares);
     void convertStopLimitToLimit(Order *order, bool buyOrSell);
 
+    // Trades produced by the current public call, reused between calls
+    std::vector<Fill> fills;
+    void beginEvent();
+
+    // Levels changed since the consumer last cleared them, and levels
+    // changed by the current call alone (each when tracking)
+    bool trackTouchedLevels = false;
+    bool trackEventLevels = false;
+    std::vector<TouchedLevel> touchedLevels;
+    std::vector<TouchedLevel> eventLevels;
+    void touchLevel(bool buySide, int price) {
+        if (trackTouchedLevels) touchedLevels.push_back(TouchedLevel{buySide, price});
+        if (trackEventLevels) eventLevels.push_back(TouchedLevel{buySide, price});
+    }
+    bool tracksLevels() const { return trackTouchedLevels || trackEventLevels; }
+
+    // Visible order changes made by the current call (when tracking)
+    bool trackOrderEvents = false;
+    std::vector<OrderEvent> orderEvents;
+    void recordOrderEvent(OrderEvent::Type type, bool buySide, int orderId, int shares, int price, int takerId = 0) {
+        if (trackOrderEvents) orderEvents.push_back(OrderEvent{type, buySide, orderId, shares, price, takerId});
+    }
 public:
+    // Highest order id a book accepts unless told otherwise (index of 512MB)
+    static constexpr int defaultOrderIdLimit = (1 << 26) - 1;
+
     Book();
     ~Book();
 
+    // Orders and levels point into the book's pools, so a copy cannot share them
+    Book(const Book&) = delete;
+    Book& operator=(const Book&) = delete;
+
+    // Pre-allocate (and first-touch) room for `orders` orders with ids up to
+    // max(orders, maxOrderId), and `priceLevels` levels per side. Call on the
+    // thread that will run the book so the memory lands on its NUMA node.
+    void reserve(size_t orders, size_t priceLevels, size_t maxOrderId = 0);
+    // Highest order id accepted from now on (at least 0). New orders with a
+    // higher or negative id are rejected: the add and market calls throw
+    // std::invalid_argument, insertRestingOrder and appendLevel return false.
+    // The add calls also throw for an id already resting, and the modify
+    // calls for no shares.
+    void setOrderIdLimit(int limit) { orderIdLimit = std::max(limit, 0); }
+    int getOrderIdLimit() const { return orderIdLimit; }
+    // Start of the order pool's memory, or nullptr (for placement reports)
+    const void* getOrderStorage() const { return orderPool.firstSlab(); }
+
     // Counts used in order book perforamce visualisations
     int executedOrdersCount=0;
 
@@ -46,11 +153,59 @@ public:
     void cancelStopLimitOrder(int orderId);
     void modifyStopLimitOrder(int orderId, int newShares, int newLimitPrice, int newStopPrice);
 
-    const std::vector<Limit>& getBuyLimits() const {return buyLimits;}
-    const std::vector<Limit>& getSellLimits() const {return sellLimits;}
-    const std::vector<Limit>& getStopBuyLimits() const {return stopBuyLimits;}
-    const std::vector<Limit>& getStopSellLimits() const {return stopSellLimits;}
+    // Direct maintenance for books that mirror one matched elsewhere (feed
+    // handlers, restores): no crossing and no stop triggers. Both record
+    // levels, order events and fills like the calls above.
+    // Rest an order at the back of its level; false if the id is in use
+    bool insertRestingOrder(int orderId, bool buyOrSell, int shares, int limitPrice);
+    // Trade shares of a resting order against takerId, removing it once
+    // empty; false if it is not resting or has fewer shares
+    bool executeRestingOrder(int orderId, int shares, int takerId);
+    // Bulk restore (snapshots): append a level with its orders, front of the
+    // queue first, behind the worst level of the buy/sell ladder, or of the
+    // stop ladder when stop. Records nothing. False, leaving the book as it
+    // was, if price is not worse than that worst level, or an order has no
+    // shares or an id already in use.
+    bool appendLevel(bool stop, bool buyOrSell, int price, const RestingOrder* orders, size_t count);
+
+    // Live ladders: only for the thread that owns the book. Other threads
+    // read a published BookDepth instead (MatchingThread::readDepth).
+    const std::vector<Limit*>& getBuyLimits() const {return buyLimits;}
+    const std::vector<Limit*>& getSellLimits() const {return sellLimits;}
+    const std::vector<Limit*>& getStopBuyLimits() const {return stopBuyLimits;}
+    const std::vector<Limit*>& getStopSellLimits() const {return stopSellLimits;}
     Order* searchOrderMap(int orderId) const;
+    // Whether order rests in the buy/sell ladders (not in a stop ladder). A
+    // triggered stop-limit does, and is modified as a limit from then on.
+    bool isRestingLimit(const Order& order) const;
+    // Highest id of an order in the book (resting or stop), 0 if empty
+    int getMaxOrderId() const;
+
+    // Fills from the most recent order call, in execution order. Includes
+    // stop orders triggered by that call. Valid until the next call; empty
+    // after a call that threw (order calls reset their records first).
+    const std::vector<Fill>& getFills() const {return fills;}
+
+    // Incremental consumers (depth snapshots, feeds) can ask the book to
+    // record every buy/sell level an order call changes, so they only look at
+    // those levels. Entries may repeat and may name prices that no longer
+    // exist; consumers re-read the level with findLimit().
+    void setTrackTouchedLevels(bool on) { trackTouchedLevels = on; touchedLevels.clear(); }
+    const std::vector<TouchedLevel>& getTouchedLevels() const {return touchedLevels;}
+    void clearTouchedLevels() { touchedLevels.clear(); }
+    // The same record for the most recent order call only, reset by every
+    // call, so per-message consumers (market data feeds) need not share
+    // the list above with a consumer that clears it
+    void setTrackEventLevels(bool on) { trackEventLevels = on; eventLevels.clear(); }
+    const std::vector<TouchedLevel>& getEventLevels() const {return eventLevels;}
+
+    // Order-by-order record of the most recent order call: every add,
+    // execution, cancel and replace of a visible limit order, in the order
+    // they happened. Reset by every call.
+    void setTrackOrderEvents(bool on) { trackOrderEvents = on; orderEvents.clear(); }
+    const std::vector<OrderEvent>& getOrderEvents() const {return orderEvents;}
+    // Level at price on the buy or sell side, or nullptr
+    const Limit* findLimit(bool buySide, int price) const;
 
     // Functions for visualising the order book
     void printOrder(int orderId) const;
@@ -64,11 +219,11 @@ public:
     std::unordered_set<Order*> stopLimitOrders;
 
     int getBestBidPrice() const {
-        return buyLimits.empty() ? 0 : buyLimits.front().getLimitPrice();
+        return buyLimits.empty() ? 0 : buyLimits.front()->getLimitPrice();
     }
 
     int getBestAskPrice() const {
-        return sellLimits.empty() ? 0 : sellLimits.front().getLimitPrice();
+        return sellLimits.empty() ? 0 : sellLimits.front()->getLimitPrice();
     }
 
     int getAVLTreeBalanceCount() const {
@@ -0,0 +1,38 @@
+#include "BookDepth.hpp"
+#include "Book.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+    int copyLevels(const std::vector<Limit*>& limits, DepthLevel* out, int levels) {
+        int count = std::min(levels, static_cast<int>(limits.size()));
+        for (int i = 0; i < count; ++i) {
+            const Limit& limit = *limits[i];
+            out[i] = DepthLevel{limit.getLimitPrice(), limit.getTotalVolume(), limit.getSize()};
+        }
+        // Clear what a deeper previous capture left, so captures compare equal
+        std::fill(out + count, out + levels, DepthLevel{});
+        return count;
+    }
+
+    bool sameLevels(const DepthLevel* a, const DepthLevel* b, int count) {
+        for (int i = 0; i < count; ++i) {
+            if (a[i].price != b[i].price || a[i].volume != b[i].volume || a[i].orderCount != b[i].orderCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool BookDepth::operator==(const BookDepth& other) const {
+    return bidLevels == other.bidLevels && askLevels == other.askLevels
+        && sameLevels(bids, other.bids, bidLevels) && sameLevels(asks, other.asks, askLevels);
+}
+
+void captureDepth(const Book& book, BookDepth& depth, int levels) {
+    levels = std::clamp(levels, 0, BookDepth::maxLevels);
+    depth.bidLevels = copyLevels(book.getBuyLimits(), depth.bids, levels);
+    depth.askLevels = copyLevels(book.getSellLimits(), depth.asks, levels);
+}
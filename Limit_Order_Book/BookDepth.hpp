@@ -0,0 +1,29 @@
+#ifndef BOOKDEPTH_HPP
+#define BOOKDEPTH_HPP
+
+class Book;
+
+struct DepthLevel {
+    int price;
+    int volume;      // total shares resting at this price
+    int orderCount;
+};
+
+// Fixed-size copy of the best price levels on each side, cheap enough to
+// publish after every event and safe to hand to other threads
+struct BookDepth {
+    static constexpr int maxLevels = 10;
+
+    int bidLevels = 0;  // valid entries in bids
+    int askLevels = 0;
+    DepthLevel bids[maxLevels] = {};  // best first
+    DepthLevel asks[maxLevels] = {};
+
+    bool operator==(const BookDepth& other) const;
+    bool operator!=(const BookDepth& other) const { return !(*this == other); }
+};
+
+// Copy up to `levels` (at most BookDepth::maxLevels) levels per side of book
+void captureDepth(const Book& book, BookDepth& depth, int levels = BookDepth::maxLevels);
+
+#endif
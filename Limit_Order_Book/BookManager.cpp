@@ -0,0 +1,44 @@
+#include "BookManager.hpp"
+
+BookManager::BookManager(size_t expectedSymbols)
+{
+    if (expectedSymbols > 0) {
+        symbolIds.reserve(expectedSymbols);
+        symbols.reserve(expectedSymbols);
+        books.reserve(expectedSymbols);
+    }
+}
+
+int BookManager::internSymbol(std::string_view symbol)
+{
+    if (symbol.empty() || symbol.size() > maxSymbolLength) return -1;
+    if (const int* id = symbolIds.find(symbol)) return *id;
+
+    int id = static_cast<int>(symbols.size());
+    symbolIds.insert(symbol, id);
+    symbols.emplace_back(symbol);
+    books.emplace_back();
+    return id;
+}
+
+int BookManager::findSymbol(std::string_view symbol) const
+{
+    const int* id = symbolIds.find(symbol);
+    return id ? *id : -1;
+}
+
+Book* BookManager::getBook(int symbolId)
+{
+    std::unique_ptr<Book>& book = books[symbolId];
+    if (!book) {
+        book = std::make_unique<Book>();
+        ++activeBooks;
+    }
+    return book.get();
+}
+
+Book* BookManager::findBook(int symbolId) const
+{
+    if (symbolId < 0 || static_cast<size_t>(symbolId) >= books.size()) return nullptr;
+    return books[symbolId].get();
+}
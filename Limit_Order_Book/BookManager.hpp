@@ -0,0 +1,47 @@
+#ifndef BOOKMANAGER_HPP
+#define BOOKMANAGER_HPP
+
+#include "Book.hpp"
+#include "InlineStringMap.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Owns one Book per instrument, keyed by a dense symbol id.
+// Symbols are interned once into ids; Books are only constructed when an
+// instrument first trades, so idle instruments cost a name and a pointer.
+// Not thread safe: each manager belongs to one matching thread.
+class BookManager {
+public:
+    static constexpr size_t maxSymbolLength = InlineStringMap::maxKeyLength;
+
+    explicit BookManager(size_t expectedSymbols = 0);
+
+    BookManager(const BookManager&) = delete;
+    BookManager& operator=(const BookManager&) = delete;
+
+    // Id for symbol, assigning the next one on first use. -1 if the symbol
+    // is empty or longer than maxSymbolLength.
+    int internSymbol(std::string_view symbol);
+    // Id for an already interned symbol, or -1
+    int findSymbol(std::string_view symbol) const;
+    const std::string& getSymbol(int symbolId) const { return symbols[symbolId]; }
+
+    // Book for an interned symbol, created on first use
+    Book* getBook(int symbolId);
+    // nullptr while the symbol has never been traded
+    Book* findBook(int symbolId) const;
+
+    size_t getSymbolCount() const { return symbols.size(); }
+    size_t getActiveBookCount() const { return activeBooks; }
+
+private:
+    InlineStringMap symbolIds;
+    std::vector<std::string> symbols;
+    std::vector<std::unique_ptr<Book>> books;  // indexed by symbol id
+    size_t activeBooks = 0;
+};
+
+#endif
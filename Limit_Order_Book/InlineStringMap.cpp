@@ -0,0 +1,101 @@
+#include "InlineStringMap.hpp"
+#include <cstring>
+
+// FNV-1a
+uint32_t InlineStringMap::hashKey(std::string_view key)
+{
+    uint32_t hash = 2166136261u;
+    for (char c : key) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Index of the slot holding key, or of the empty slot where it would go
+size_t InlineStringMap::findSlot(std::string_view key, uint32_t hash) const
+{
+    size_t mask = slots.size() - 1;
+    size_t index = hash & mask;
+    while (slots[index].used) {
+        const Slot& slot = slots[index];
+        if (slot.hash == hash && slot.length == key.size() &&
+            std::memcmp(slot.key, key.data(), key.size()) == 0) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+const int* InlineStringMap::find(std::string_view key) const
+{
+    if (count == 0 || key.size() > maxKeyLength) return nullptr;
+    const Slot& slot = slots[findSlot(key, hashKey(key))];
+    return slot.used ? &slot.value : nullptr;
+}
+
+bool InlineStringMap::insert(std::string_view key, int value)
+{
+    if (key.size() > maxKeyLength) return false;
+    // Keep the load factor at or below one half
+    if ((count + 1) * 2 > slots.size()) {
+        rehash(slots.empty() ? 16 : slots.size() * 2);
+    }
+
+    uint32_t hash = hashKey(key);
+    Slot& slot = slots[findSlot(key, hash)];
+    if (slot.used) return false;
+
+    slot.hash = hash;
+    slot.length = static_cast<uint8_t>(key.size());
+    slot.used = true;
+    std::memcpy(slot.key, key.data(), key.size());
+    slot.value = value;
+    ++count;
+    return true;
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones
+bool InlineStringMap::erase(std::string_view key)
+{
+    if (count == 0 || key.size() > maxKeyLength) return false;
+    size_t mask = slots.size() - 1;
+    size_t hole = findSlot(key, hashKey(key));
+    if (!slots[hole].used) return false;
+
+    size_t next = (hole + 1) & mask;
+    while (slots[next].used) {
+        size_t home = slots[next].hash & mask;
+        // Move the entry back if the hole lies on its probe path
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    slots[hole].used = false;
+    --count;
+    return true;
+}
+
+void InlineStringMap::reserve(size_t keys)
+{
+    size_t capacity = 16;
+    while (capacity < keys * 2) capacity <<= 1;
+    if (capacity > slots.size()) rehash(capacity);
+}
+
+void InlineStringMap::rehash(size_t newCapacity)
+{
+    std::vector<Slot> old(newCapacity);
+    old.swap(slots);
+
+    size_t mask = slots.size() - 1;
+    for (const Slot& entry : old) {
+        if (!entry.used) continue;
+        size_t index = entry.hash & mask;
+        while (slots[index].used) index = (index + 1) & mask;
+        slots[index] = entry;
+    }
+}
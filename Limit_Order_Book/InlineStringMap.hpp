@@ -0,0 +1,53 @@
+#ifndef INLINESTRINGMAP_HPP
+#define INLINESTRINGMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Open-addressing hash map from short strings (ClOrdIDs, symbols) to int.
+// Keys are stored inline in the slot array, so lookups take a string_view and
+// never allocate; only growing the table does.
+class InlineStringMap {
+public:
+    static constexpr size_t maxKeyLength = 39;
+
+    InlineStringMap() = default;
+
+    // nullptr if the key is absent
+    const int* find(std::string_view key) const;
+    // false if the key is already present or longer than maxKeyLength
+    bool insert(std::string_view key, int value);
+    bool erase(std::string_view key);
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void reserve(size_t keys);
+
+    // Call visit(key, value) for every entry, in no particular order
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (const Slot& slot : slots) {
+            if (slot.used) visit(std::string_view(slot.key, slot.length), slot.value);
+        }
+    }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        uint8_t length;
+        bool used;
+        char key[maxKeyLength];
+        int value;
+    };
+
+    std::vector<Slot> slots;  // power-of-two sized, allocated on first insert
+    size_t count = 0;
+
+    static uint32_t hashKey(std::string_view key);
+    size_t findSlot(std::string_view key, uint32_t hash) const;
+    void rehash(size_t newCapacity);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "ObjectPool.hpp"
+
+#ifdef __linux__
+#include <sys/mman.h>
+
+namespace {
+    // Below a page a mapping would waste most of its page (a pool per book
+    // adds up over thousands of symbols), so small slabs use the heap
+    constexpr size_t mappedSlabBytes = 4096;
+    constexpr size_t hugeSlabBytes = 4 << 20;
+}
+#endif
+
+void* allocatePoolSlab(size_t bytes)
+{
+#ifdef __linux__
+    if (bytes < mappedSlabBytes) return ::operator new(bytes);
+    void* slab = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (slab == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    // Fewer page faults while the slab is first touched, and fewer TLB
+    // misses on a large book. Only a hint; ignored where unsupported.
+    if (bytes >= hugeSlabBytes) madvise(slab, bytes, MADV_HUGEPAGE);
+#endif
+    return slab;
+#else
+    return ::operator new(bytes);
+#endif
+}
+
+void releasePoolSlab(void* slab, size_t bytes)
+{
+#ifdef __linux__
+    if (bytes < mappedSlabBytes) {
+        ::operator delete(slab);
+        return;
+    }
+    munmap(slab, bytes);
+#else
+    (void)bytes;
+    ::operator delete(slab);
+#endif
+}
@@ -0,0 +1,116 @@
+#ifndef OBJECTPOOL_HPP
+#define OBJECTPOOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Memory for pool slabs. Slabs of a page or more are fresh, page-aligned
+// memory (mmap on Linux), placed by whichever thread first touches them
+// under that thread's NUMA memory policy instead of being recycled from
+// another thread's heap. Slabs of several megabytes ask for transparent huge
+// pages. Smaller slabs come from the heap.
+void* allocatePoolSlab(size_t bytes);
+void releasePoolSlab(void* slab, size_t bytes);
+
+// Free-list pool of T carved out of slabs. Objects never move, and freed
+// objects are reused LIFO (still warm in cache). Single threaded.
+//
+// Slabs start small and double up to `_slabObjects`, so an idle pool costs
+// little; objects are carved from the newest slab only as they are needed,
+// so its untouched tail stays out of the resident set.
+template <typename T>
+class ObjectPool {
+public:
+    explicit ObjectPool(size_t _slabObjects = 4096)
+        : slabObjects(_slabObjects ? _slabObjects : 1), nextSlabObjects(std::min(firstSlabObjects, slabObjects)) {}
+
+    ~ObjectPool() {
+        for (const Slab& slab : slabs) releasePoolSlab(slab.memory, slab.objects * sizeof(Node));
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Node* node = freeList;
+        if (node) {
+            freeList = node->next;
+        } else {
+            if (unused == unusedEnd) addSlab();
+            node = unused++;
+        }
+        ++live;
+        return new (node->storage) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* object) {
+        object->~T();
+        Node* node = reinterpret_cast<Node*>(object);
+        node->next = freeList;
+        freeList = node;
+        --live;
+    }
+
+    // Allocate (and touch) memory up front so at least `objects` are
+    // available without further allocation. The shortfall comes as one slab
+    // (a whole number of full-size slabs), so a large reserve is one mapping.
+    void reserve(size_t objects) {
+        size_t available = totalObjects - live;
+        if (available >= objects) return;
+        size_t slabCount = (objects - available + slabObjects - 1) / slabObjects;
+        Node* nodes = newSlab(slabCount * slabObjects);
+        // Thread the free list front to back, writing every node now so the
+        // pages are first touched by the pool's owning thread
+        for (size_t i = slabCount * slabObjects; i-- > 0;) {
+            nodes[i].next = freeList;
+            freeList = &nodes[i];
+        }
+    }
+
+    size_t capacity() const { return totalObjects; }
+    size_t size() const { return live; }
+    // Start of the first slab, or nullptr (used to report memory placement)
+    const void* firstSlab() const { return slabs.empty() ? nullptr : slabs.front().memory; }
+
+private:
+    union Node {
+        Node* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct Slab {
+        void* memory;
+        size_t objects;
+    };
+
+    static constexpr size_t firstSlabObjects = 4;
+
+    size_t slabObjects;      // largest regular slab
+    size_t nextSlabObjects;  // size of the next slab create() adds
+    std::vector<Slab> slabs;
+    Node* freeList = nullptr;
+    // Not yet handed out part of the newest regular slab
+    Node* unused = nullptr;
+    Node* unusedEnd = nullptr;
+    size_t live = 0;
+    size_t totalObjects = 0;
+
+    void addSlab() {
+        unused = newSlab(nextSlabObjects);
+        unusedEnd = unused + nextSlabObjects;
+        nextSlabObjects = std::min(nextSlabObjects * 2, slabObjects);
+    }
+
+    Node* newSlab(size_t objects) {
+        Node* nodes = static_cast<Node*>(allocatePoolSlab(objects * sizeof(Node)));
+        slabs.push_back(Slab{nodes, objects});
+        totalObjects += objects;
+        return nodes;
+    }
+};
+
+#endif
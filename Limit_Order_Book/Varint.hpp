@@ -0,0 +1,85 @@
+#ifndef VARINT_HPP
+#define VARINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// LEB128 varints and zigzag signed values, shared by the binary encodings
+// (depth snapshots, book snapshots). Header only, so the codecs' loops
+// can inline it.
+
+constexpr size_t maxVarint32 = 5;
+constexpr size_t maxVarint64 = 10;
+
+// Write value at out (up to maxVarint64 bytes); returns the end
+inline char* putVarint(char* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<char>(value);
+    return out;
+}
+
+// Small magnitudes of either sign map to small unsigned values. An int32_t
+// encodes to the same bytes through either width.
+inline uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+// Reads LEB128 varints of at most maxBits bits, failing on overrun
+class VarintReader {
+public:
+    VarintReader(const char* begin, const char* _end) : in(begin), end(_end) {}
+    explicit VarintReader(std::string_view data) : in(data.data()), end(data.data() + data.size()) {}
+
+    bool read(uint64_t& value, int maxBits = 64) {
+        value = 0;
+        for (int shift = 0; shift < maxBits; shift += 7) {
+            if (in == end) return false;
+            uint8_t byte = static_cast<uint8_t>(*in++);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return maxBits >= 64 || value >> maxBits == 0;
+        }
+        return false;
+    }
+
+    bool read32(uint32_t& value) {
+        uint64_t wide;
+        if (!read(wide, 32)) return false;
+        value = static_cast<uint32_t>(wide);
+        return true;
+    }
+
+    // A zigzag field that must fit an int, or the difference of two ints
+    bool readInt(int64_t& value) {
+        uint64_t wide;
+        if (!read(wide, 33)) return false;
+        value = unzigzag(wide);
+        return true;
+    }
+
+    bool atEnd() const { return in == end; }
+    size_t remaining() const { return static_cast<size_t>(end - in); }
+    const char* position() const { return in; }
+    void skip(size_t bytes) { in += bytes; }
+
+private:
+    const char* in;
+    const char* end;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "BBOTicker.hpp"
+
+#include <algorithm>
+
+bool BBOTicker::Consumer::poll(TopOfBook& latest) {
+    TopOfBook value = slot.load();
+    if (value.sequence == lastSequence) return false;
+    conflated += value.sequence - lastSequence - 1;
+    lastSequence = value.sequence;
+    latest = value;
+    return true;
+}
+
+BBOTicker::BBOTicker(const Book& _book) : book(_book) {
+    readQuote();
+}
+
+BBOTicker::Consumer& BBOTicker::subscribe(std::chrono::microseconds interval) {
+    uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count());
+    consumers.push_back(std::unique_ptr<Consumer>(new Consumer(ns)));
+    Consumer& consumer = *consumers.back();
+    // Start from the current quote, which the consumer has not seen yet
+    consumer.slot.store(quote);
+    consumer.lastSequence = quote.sequence == 0 ? 0 : quote.sequence - 1;
+    return consumer;
+}
+
+bool BBOTicker::readQuote() {
+    TopOfBook next;
+    const std::vector<Limit*>& bids = book.getBuyLimits();
+    const std::vector<Limit*>& asks = book.getSellLimits();
+    if (!bids.empty()) {
+        next.bidPrice = bids.front()->getLimitPrice();
+        next.bidVolume = bids.front()->getTotalVolume();
+        next.bidOrders = bids.front()->getSize();
+    }
+    if (!asks.empty()) {
+        next.askPrice = asks.front()->getLimitPrice();
+        next.askVolume = asks.front()->getTotalVolume();
+        next.askOrders = asks.front()->getSize();
+    }
+    if (next.sameQuote(quote)) return false;
+    next.sequence = quote.sequence + 1;
+    quote = next;
+    return true;
+}
+
+void BBOTicker::publish(Consumer& consumer, uint64_t now) {
+    consumer.slot.store(quote);
+    consumer.nextAllowed = now + consumer.interval;
+    consumer.pending = false;
+    ++consumer.publishes;
+}
+
+bool BBOTicker::onEvent() {
+    bool changed = readQuote();
+    // Only read the clock when there is something to stamp or publish
+    if (!changed && nextDue == UINT64_MAX) return false;
+    return offer(changed, tickerTimestamp());
+}
+
+bool BBOTicker::onEvent(uint64_t now) {
+    return offer(readQuote(), now);
+}
+
+bool BBOTicker::offer(bool changed, uint64_t now) {
+    if (!changed) {
+        publishDue(now);
+        return false;
+    }
+    quote.timestamp = now;
+    for (const std::unique_ptr<Consumer>& consumer : consumers) {
+        if (now >= consumer->nextAllowed) {
+            publish(*consumer, now);
+        } else {
+            // Replaces whatever was held back for it
+            consumer->pending = true;
+            nextDue = std::min(nextDue, consumer->nextAllowed);
+        }
+    }
+    return true;
+}
+
+void BBOTicker::publishDue(uint64_t now) {
+    if (now < nextDue) return;
+    nextDue = UINT64_MAX;
+    for (const std::unique_ptr<Consumer>& consumer : consumers) {
+        if (!consumer->pending) continue;
+        if (now >= consumer->nextAllowed) {
+            publish(*consumer, now);
+        } else {
+            nextDue = std::min(nextDue, consumer->nextAllowed);
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef BBOTICKER_HPP
+#define BBOTICKER_HPP
+
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Matching_Engine/Seqlock.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Best bid and offer of one book. An empty side has price, volume and
+// orderCount 0.
+struct TopOfBook {
+    int bidPrice = 0;
+    int bidVolume = 0;
+    int bidOrders = 0;
+    int askPrice = 0;
+    int askVolume = 0;
+    int askOrders = 0;
+    uint64_t sequence = 0;   // BBO changes up to and including this one
+    uint64_t timestamp = 0;  // ns (steady clock) when the book reached it
+
+    // Same quote, whenever it was reached
+    bool sameQuote(const TopOfBook& other) const {
+        return bidPrice == other.bidPrice && bidVolume == other.bidVolume && bidOrders == other.bidOrders
+            && askPrice == other.askPrice && askVolume == other.askVolume && askOrders == other.askOrders;
+    }
+};
+
+// Conflated top-of-book ticker for one book.
+//
+// After each order call, onEvent() reads the best level on each side and,
+// if the quote changed, offers it to every consumer. Each consumer has one
+// latest-value slot (a Seqlock) and a minimum interval between
+// publications: a change that arrives before a consumer's interval is up
+// is held back, and whatever the quote is once it is up gets published, so
+// intermediate quotes are dropped rather than queued. Consumers read their
+// slot from any thread at any pace and the matching thread never waits for
+// them.
+class BBOTicker {
+public:
+    class Consumer {
+    public:
+        Consumer(const Consumer&) = delete;
+        Consumer& operator=(const Consumer&) = delete;
+
+        // Consumer thread: the latest published quote, if it is newer than
+        // the one the previous poll returned
+        bool poll(TopOfBook& quote);
+        // Any thread: the latest published quote, seen or not
+        TopOfBook read() const { return slot.load(); }
+        // Consumer thread: changes dropped between the quotes polled so far
+        uint64_t getConflatedCount() const { return conflated; }
+
+        // Matching thread statistics
+        uint64_t getPublishCount() const { return publishes; }
+        uint64_t getInterval() const { return interval; }
+
+    private:
+        friend class BBOTicker;
+        explicit Consumer(uint64_t _interval) : interval(_interval) {}
+
+        Seqlock<TopOfBook> slot;
+        // Matching thread
+        uint64_t interval;
+        uint64_t nextAllowed = 0;
+        bool pending = false;
+        uint64_t publishes = 0;
+        // Consumer thread
+        alignas(64) uint64_t lastSequence = 0;
+        uint64_t conflated = 0;
+    };
+
+    explicit BBOTicker(const Book& book);
+
+    BBOTicker(const BBOTicker&) = delete;
+    BBOTicker& operator=(const BBOTicker&) = delete;
+
+    // Add a consumer that gets at most one quote per interval. Call before
+    // the book starts being matched; the consumer lives as long as the
+    // ticker.
+    Consumer& subscribe(std::chrono::microseconds interval);
+
+    // Matching thread, after each order call: stamped with the current time
+    // or a given one (ns). Returns true if the quote changed.
+    bool onEvent();
+    bool onEvent(uint64_t now);
+    // Matching thread, when idle: publish held back quotes whose interval
+    // has run out
+    void publishDue() { publishDue(tickerTimestamp()); }
+    void publishDue(uint64_t now);
+
+    const TopOfBook& getQuote() const { return quote; }
+    uint64_t getChangeCount() const { return quote.sequence; }
+
+    // Nanoseconds on the steady clock, as stamped by onEvent()
+    static uint64_t tickerTimestamp() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    const Book& book;
+    TopOfBook quote;
+    std::vector<std::unique_ptr<Consumer>> consumers;
+    // Earliest time a held back quote becomes due, or UINT64_MAX
+    uint64_t nextDue = UINT64_MAX;
+
+    // Read the best levels; true if the quote changed
+    bool readQuote();
+    bool offer(bool changed, uint64_t now);
+    void publish(Consumer& consumer, uint64_t now);
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "DepthCodec.hpp"
+#include "../Limit_Order_Book/Varint.hpp"
+
+#include <vector>
+
+namespace {
+    constexpr char snapshotType = 'S';
+
+    int priceOf(const Limit* limit) { return limit->getLimitPrice(); }
+    int priceOf(const DepthLevel& level) { return level.price; }
+    DepthLevel levelOf(const Limit* limit) {
+        return DepthLevel{limit->getLimitPrice(), limit->getTotalVolume(), limit->getSize()};
+    }
+    DepthLevel levelOf(const DepthLevel& level) { return level; }
+
+    template <typename Levels>
+    char* putSide(char* out, const Levels& levels, bool buySide) {
+        for (size_t i = 0; i < levels.size(); ++i) {
+            DepthLevel level = levelOf(levels[i]);
+            if (i == 0) {
+                out = putVarint(out, zigzag(level.price));
+            } else {
+                int previous = priceOf(levels[i - 1]);
+                out = putVarint(out, static_cast<uint32_t>(buySide ? previous - level.price : level.price - previous));
+            }
+            out = putVarint(out, static_cast<uint32_t>(level.volume));
+            out = putVarint(out, static_cast<uint32_t>(level.orderCount));
+        }
+        return out;
+    }
+
+    template <typename Levels>
+    size_t encode(const Levels& bids, const Levels& asks, uint64_t sequence, std::string& out) {
+        // Size for the worst case, then trim to what was written
+        size_t start = out.size();
+        out.resize(start + 1 + maxVarint64 + 2 * maxVarint32 + (bids.size() + asks.size()) * 3 * maxVarint32);
+        char* begin = out.data() + start;
+        char* cursor = begin;
+        *cursor++ = snapshotType;
+        cursor = putVarint(cursor, sequence);
+        cursor = putVarint(cursor, bids.size());
+        cursor = putVarint(cursor, asks.size());
+        cursor = putSide(cursor, bids, true);
+        cursor = putSide(cursor, asks, false);
+        out.resize(start + static_cast<size_t>(cursor - begin));
+        return static_cast<size_t>(cursor - begin);
+    }
+
+    bool readSide(VarintReader& reader, size_t count, bool buySide, std::vector<DepthLevel>& levels) {
+        levels.clear();
+        // Every level takes at least three bytes, which bounds a bad count
+        if (count > reader.remaining() / 3) return false;
+        levels.reserve(count);
+        int previous = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t price, volume, orderCount;
+            if (!reader.read32(price) || !reader.read32(volume) || !reader.read32(orderCount)) return false;
+            int value;
+            if (i == 0) {
+                value = unzigzag(price);
+            } else {
+                // Levels are strictly best first
+                if (price == 0) return false;
+                value = static_cast<int>(buySide ? static_cast<uint32_t>(previous) - price
+                                                 : static_cast<uint32_t>(previous) + price);
+            }
+            levels.push_back(DepthLevel{value, static_cast<int>(volume), static_cast<int>(orderCount)});
+            previous = value;
+        }
+        return true;
+    }
+}
+
+size_t encodeDepthSnapshot(const Book& book, uint64_t sequence, std::string& out) {
+    return encode(book.getBuyLimits(), book.getSellLimits(), sequence, out);
+}
+
+size_t encodeDepthSnapshot(const DepthSnapshot& snapshot, uint64_t sequence, std::string& out) {
+    return encode(snapshot.bids, snapshot.asks, sequence, out);
+}
+
+bool decodeDepthSnapshot(std::string_view data, DepthSnapshot& snapshot) {
+    if (data.empty() || data[0] != snapshotType) return false;
+    VarintReader reader(data.substr(1));
+    uint64_t sequence, bidCount, askCount;
+    if (!reader.read(sequence, 64) || !reader.read(bidCount, 32) || !reader.read(askCount, 32)) return false;
+    if (!readSide(reader, bidCount, true, snapshot.bids) || !readSide(reader, askCount, false, snapshot.asks)) {
+        return false;
+    }
+    snapshot.version = sequence;
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef DEPTHCODEC_HPP
+#define DEPTHCODEC_HPP
+
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Matching_Engine/DepthSnapshot.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Compact full-depth snapshot for late joiners: every price level of both
+// sides, typically a few bytes per level.
+//
+//   'S' | sequence | bid count | ask count | bid levels | ask levels
+//   level: price | volume | order count
+//
+// All fields are LEB128 varints. Levels run best first, and every price
+// after a side's first is sent as its distance from the previous level
+// (always positive, usually small), so a dense ladder costs one byte per
+// price. The first price of each side is zigzag encoded and may be
+// negative. sequence is whatever the sender pairs the image with, such as
+// the L2 or L3 sequence number it was taken at, so the joiner knows where
+// to pick up the incremental feed.
+
+// Append an image of book (matching thread) or of a published snapshot
+// (any thread) to out; returns the bytes appended
+size_t encodeDepthSnapshot(const Book& book, uint64_t sequence, std::string& out);
+size_t encodeDepthSnapshot(const DepthSnapshot& snapshot, uint64_t sequence, std::string& out);
+
+// Read an image into snapshot, with its sequence in snapshot.version.
+// False if it is truncated or malformed.
+bool decodeDepthSnapshot(std::string_view data, DepthSnapshot& snapshot);
+
+#endif
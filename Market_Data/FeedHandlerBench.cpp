@@ -0,0 +1,95 @@
+#include "L3Feed.hpp"
+#include "L3FeedHandler.hpp"
+#include "../Generate_Orders/GenerateOrders.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// How fast an L3 stream rebuilds a book.
+// Usage: FeedHandlerBench [commands] [seed] [--verify]
+//
+// Matches one generated single-symbol log while recording its L3 stream,
+// then times an L3FeedHandler rebuilding a fresh book from the whole
+// stream and checks the result against the source book. With --verify the
+// source and the rebuilt book instead advance in lockstep and are compared
+// level by level after every command, stopping at the first difference.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    void apply(Book& book, const OrderCommand& command) {
+        try {
+            applyOrderCommand(book, command);
+        } catch (const std::exception&) {}
+    }
+
+    int verify(const std::vector<OrderCommand>& log) {
+        Book source;
+        Book rebuilt;
+        L3FeedBuilder feed(source, 0, nullptr, SIZE_MAX);
+        L3FeedHandler handler(rebuilt, 0);
+        auto start = Clock::now();
+        for (size_t n = 0; n < log.size(); ++n) {
+            apply(source, log[n]);
+            feed.onEvent();
+            handler.onData(feed.getOutput());
+            feed.clearOutput();
+            std::string difference = compareBooks(source, rebuilt);
+            if (!difference.empty()) {
+                std::cout << "Books differ after command " << n << ": " << difference << std::endl;
+                return 1;
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << "Verified after each of " << log.size() << " commands (" << handler.getMessageCount()
+                  << " records, " << handler.getErrorCount() << " errors) in " << std::fixed << std::setprecision(2)
+                  << seconds << " s" << std::endl;
+        return handler.getErrorCount() == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 2000000;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 42;
+    bool verifyEach = argc > 3 && std::strcmp(argv[3], "--verify") == 0;
+
+    std::vector<OrderCommand> log = generateCommandLog(1, count, seed);
+    if (verifyEach) return verify(log);
+
+    Book source;
+    std::string stream;
+    {
+        L3FeedBuilder feed(source, 0, nullptr, SIZE_MAX);
+        for (const OrderCommand& command : log) {
+            apply(source, command);
+            feed.onEvent();
+        }
+        stream = feed.getOutput();
+    }
+    std::cout << count << " commands -> " << stream.size() / (1 << 20) << " MB of L3 stream" << std::endl;
+
+    Book rebuilt;
+    L3FeedHandler handler(rebuilt, 0);
+    auto start = Clock::now();
+    size_t used = handler.onData(stream);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    double messages = static_cast<double>(handler.getMessageCount());
+    std::cout << std::fixed << std::setprecision(1) << handler.getMessageCount() << " records rebuilt in "
+              << seconds * 1e3 << " ms: " << messages / seconds / 1e6 << "M records/s, " << seconds * 1e9 / messages
+              << " ns/record" << std::endl;
+    std::cout << handler.getGapCount() << " gaps, " << handler.getErrorCount() << " errors, "
+              << stream.size() - used << " bytes left over" << std::endl;
+
+    std::string difference = compareBooks(source, rebuilt);
+    std::cout << "Final book " << (difference.empty() ? "matches the source" : "differs: " + difference) << std::endl;
+    return difference.empty() && handler.getErrorCount() == 0 ? 0 : 1;
+}
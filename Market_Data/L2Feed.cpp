@@ -0,0 +1,47 @@
+#include "L2Feed.hpp"
+
+#include <algorithm>
+
+L2FeedBuilder::L2FeedBuilder(Book& _book, size_t reserveUpdates) : book(_book) {
+    scratch.reserve(reserveUpdates);
+    updates.reserve(reserveUpdates);
+    book.setTrackEventLevels(true);
+}
+
+L2FeedBuilder::~L2FeedBuilder() {
+    book.setTrackEventLevels(false);
+}
+
+const std::vector<LevelUpdate>& L2FeedBuilder::onEvent() {
+    updates.clear();
+    const std::vector<TouchedLevel>& touched = book.getEventLevels();
+    if (touched.empty()) return updates;
+
+    auto emit = [this](const TouchedLevel& level) {
+        const Limit* limit = book.findLimit(level.buySide, level.price);
+        if (limit) {
+            updates.push_back(LevelUpdate{level.buySide, level.price, limit->getTotalVolume(), limit->getSize()});
+        } else {
+            updates.push_back(LevelUpdate{level.buySide, level.price, 0, 0});
+        }
+    };
+
+    // Most messages touch one level: an add, a cancel or a partial fill
+    if (touched.size() == 1) {
+        emit(touched.front());
+    } else {
+        // Bids before asks, each best first; repeats end up next to each other
+        scratch.assign(touched.begin(), touched.end());
+        std::sort(scratch.begin(), scratch.end(), [](const TouchedLevel& a, const TouchedLevel& b) {
+            if (a.buySide != b.buySide) return a.buySide;
+            return a.buySide ? a.price > b.price : a.price < b.price;
+        });
+        auto last = std::unique(scratch.begin(), scratch.end(), [](const TouchedLevel& a, const TouchedLevel& b) {
+            return a.buySide == b.buySide && a.price == b.price;
+        });
+        std::for_each(scratch.begin(), last, emit);
+    }
+    ++sequence;
+    updateCount += updates.size();
+    return updates;
+}
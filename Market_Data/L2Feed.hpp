@@ -0,0 +1,58 @@
+#ifndef L2FEED_HPP
+#define L2FEED_HPP
+
+#include "../Limit_Order_Book/Book.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// New state of one price level after an inbound message. A level that
+// emptied is sent with volume and orderCount 0.
+struct LevelUpdate {
+    bool buySide;
+    int price;
+    int volume;
+    int orderCount;
+
+    bool operator==(const LevelUpdate& other) const {
+        return buySide == other.buySide && price == other.price && volume == other.volume
+            && orderCount == other.orderCount;
+    }
+};
+
+// Incremental L2 (price level) feed for one book.
+//
+// The book records every level an order call appends to, removes from or
+// fills against (Book::getEventLevels). After each call, onEvent() folds
+// those into one update per distinct level, read from the level's final
+// state, so a sweep through 20 levels that also triggers stops still sends
+// exactly one update per level it touched. Updates are ordered bids then
+// asks, best price first, and go into a buffer that is reused from message
+// to message.
+class L2FeedBuilder {
+public:
+    // Turns on per-call level tracking in book
+    explicit L2FeedBuilder(Book& book, size_t reserveUpdates = 256);
+    ~L2FeedBuilder();
+
+    L2FeedBuilder(const L2FeedBuilder&) = delete;
+    L2FeedBuilder& operator=(const L2FeedBuilder&) = delete;
+
+    // After each order call on the book: the updates it produced (possibly
+    // none), valid until the next onEvent()
+    const std::vector<LevelUpdate>& onEvent();
+    const std::vector<LevelUpdate>& getUpdates() const { return updates; }
+
+    // Messages that produced at least one update; the latest one's number
+    uint64_t getSequence() const { return sequence; }
+    uint64_t getUpdateCount() const { return updateCount; }
+
+private:
+    Book& book;
+    std::vector<TouchedLevel> scratch;
+    std::vector<LevelUpdate> updates;
+    uint64_t sequence = 0;
+    uint64_t updateCount = 0;
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "L3Feed.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    void putU16(char* out, uint16_t value) {
+        out[0] = static_cast<char>(value >> 8);
+        out[1] = static_cast<char>(value);
+    }
+
+    void putU32(char* out, uint32_t value) {
+        for (int i = 3; i >= 0; --i) {
+            out[i] = static_cast<char>(value);
+            value >>= 8;
+        }
+    }
+
+    void putU64(char* out, uint64_t value) {
+        for (int i = 7; i >= 0; --i) {
+            out[i] = static_cast<char>(value);
+            value >>= 8;
+        }
+    }
+
+    // Fixed width, so the loop unrolls into a load and byte swap
+    template <int Bytes>
+    uint64_t getUnsigned(const char* in) {
+        uint64_t value = 0;
+        for (int i = 0; i < Bytes; ++i) {
+            value = (value << 8) | static_cast<unsigned char>(in[i]);
+        }
+        return value;
+    }
+
+    int getInt(const char* in) {
+        return static_cast<int>(static_cast<uint32_t>(getUnsigned<4>(in)));
+    }
+
+    char recordType(OrderEvent::Type type) {
+        switch (type) {
+            case OrderEvent::Add: return L3Message::Add;
+            case OrderEvent::Execute: return L3Message::Execute;
+            case OrderEvent::Delete: return L3Message::Delete;
+            case OrderEvent::Replace: return L3Message::Replace;
+        }
+        return L3Message::Add;
+    }
+}
+
+uint64_t l3Timestamp() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+size_t L3Message::length(char type) {
+    switch (type) {
+        case Add: return 32;
+        case Execute: return 35;
+        case Delete: return 23;
+        case Replace: return 31;
+        default: return 0;
+    }
+}
+
+size_t L3Message::encode(char* out) const {
+    out[0] = type;
+    putU16(out + 1, locate);
+    putU64(out + 3, sequence);
+    putU64(out + 11, timestamp);
+    char* body = out + headerLength;
+    putU32(body, static_cast<uint32_t>(orderId));
+    switch (type) {
+        case Add:
+            body[4] = buySide ? 'B' : 'S';
+            putU32(body + 5, static_cast<uint32_t>(shares));
+            putU32(body + 9, static_cast<uint32_t>(price));
+            break;
+        case Execute:
+            putU32(body + 4, static_cast<uint32_t>(shares));
+            putU32(body + 8, static_cast<uint32_t>(price));
+            putU32(body + 12, static_cast<uint32_t>(takerId));
+            break;
+        case Replace:
+            putU32(body + 4, static_cast<uint32_t>(shares));
+            putU32(body + 8, static_cast<uint32_t>(price));
+            break;
+        default:
+            break;
+    }
+    return length(type);
+}
+
+bool L3Message::decode(std::string_view record) {
+    if (record.empty()) return false;
+    size_t expected = length(record[0]);
+    if (expected == 0 || record.size() < expected) return false;
+
+    const char* in = record.data();
+    type = in[0];
+    locate = static_cast<uint16_t>(getUnsigned<2>(in + 1));
+    sequence = getUnsigned<8>(in + 3);
+    timestamp = getUnsigned<8>(in + 11);
+    const char* body = in + headerLength;
+    orderId = getInt(body);
+    buySide = false;
+    shares = 0;
+    price = 0;
+    takerId = 0;
+    switch (type) {
+        case Add:
+            if (body[4] != 'B' && body[4] != 'S') return false;
+            buySide = body[4] == 'B';
+            shares = getInt(body + 5);
+            price = getInt(body + 9);
+            break;
+        case Execute:
+            shares = getInt(body + 4);
+            price = getInt(body + 8);
+            takerId = getInt(body + 12);
+            break;
+        case Replace:
+            shares = getInt(body + 4);
+            price = getInt(body + 8);
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+L3FileSink::L3FileSink(const char* path) : file(std::fopen(path, "wb")) {}
+
+L3FileSink::~L3FileSink() {
+    if (file) std::fclose(file);
+}
+
+bool L3FileSink::write(std::string_view stream) {
+    return file && std::fwrite(stream.data(), 1, stream.size(), file) == stream.size();
+}
+
+void L3FileSink::flush() {
+    if (file) std::fflush(file);
+}
+
+L3MulticastSink::L3MulticastSink(const char* group, uint16_t port, const char* interfaceAddress,
+                                 std::string_view sessionName) {
+    std::memset(session, ' ', sizeof(session));
+    std::memcpy(session, sessionName.data(), std::min(sessionName.size(), sizeof(session)));
+
+    in_addr groupIn{};
+    in_addr interfaceIn{};
+    if (inet_pton(AF_INET, group, &groupIn) != 1 || inet_pton(AF_INET, interfaceAddress, &interfaceIn) != 1) return;
+    groupAddress = groupIn.s_addr;
+    groupPort = htons(port);
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return;
+    unsigned char loop = 1;
+    unsigned char ttl = 0;  // never leaves the host
+    if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &interfaceIn, sizeof(interfaceIn)) != 0
+        || setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0
+        || setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+L3MulticastSink::~L3MulticastSink() {
+    if (fd >= 0) close(fd);
+}
+
+bool L3MulticastSink::sendPacket(uint64_t firstSequence, uint16_t count, size_t length) {
+    std::memcpy(packet, session, sizeof(session));
+    putU64(packet + 10, firstSequence);
+    putU16(packet + 18, count);
+
+    sockaddr_in destination{};
+    destination.sin_family = AF_INET;
+    destination.sin_addr.s_addr = groupAddress;
+    destination.sin_port = groupPort;
+    ssize_t sent = sendto(fd, packet, length, 0, reinterpret_cast<const sockaddr*>(&destination), sizeof(destination));
+    if (sent != static_cast<ssize_t>(length)) return false;
+    ++packetsSent;
+    return true;
+}
+
+bool L3MulticastSink::write(std::string_view stream) {
+    if (fd < 0) return false;
+
+    size_t length = packetHeaderLength;
+    uint16_t count = 0;
+    uint64_t firstSequence = 0;
+    size_t offset = 0;
+    while (offset + 2 <= stream.size()) {
+        size_t recordLength = 2 + static_cast<size_t>(getUnsigned<2>(stream.data() + offset));
+        if (offset + recordLength > stream.size()) return false;
+        if (length + recordLength > maxPacketLength) {
+            if (!sendPacket(firstSequence, count, length)) return false;
+            length = packetHeaderLength;
+            count = 0;
+        }
+        if (count == 0) firstSequence = getUnsigned<8>(stream.data() + offset + 2 + 3);
+        std::memcpy(packet + length, stream.data() + offset, recordLength);
+        length += recordLength;
+        ++count;
+        offset += recordLength;
+    }
+    return count == 0 || sendPacket(firstSequence, count, length);
+}
+
+L3FeedBuilder::L3FeedBuilder(Book& _book, uint16_t _locate, L3Sink* _sink, size_t _flushBytes)
+    : book(_book), locate(_locate), sink(_sink), flushBytes(_flushBytes) {
+    output.reserve(std::min(flushBytes, size_t{1} << 20) + 256 * (L3Message::maxLength + 2));
+    book.setTrackOrderEvents(true);
+}
+
+L3FeedBuilder::~L3FeedBuilder() {
+    flush();
+    book.setTrackOrderEvents(false);
+}
+
+size_t L3FeedBuilder::onEvent() {
+    if (book.getOrderEvents().empty()) return 0;
+    return onEvent(l3Timestamp());
+}
+
+size_t L3FeedBuilder::onEvent(uint64_t timestamp) {
+    const std::vector<OrderEvent>& events = book.getOrderEvents();
+    if (events.empty()) return 0;
+
+    L3Message message;
+    message.locate = locate;
+    message.timestamp = timestamp;
+    char record[2 + L3Message::maxLength];
+    for (const OrderEvent& event : events) {
+        message.type = recordType(event.type);
+        message.sequence = ++sequence;
+        message.orderId = event.orderId;
+        message.buySide = event.buySide;
+        message.shares = event.shares;
+        message.price = event.price;
+        message.takerId = event.takerId;
+        size_t length = message.encode(record + 2);
+        putU16(record, static_cast<uint16_t>(length));
+        output.append(record, length + 2);
+        bytes += length + 2;
+    }
+    if (sink && output.size() >= flushBytes) flush();
+    return events.size();
+}
+
+bool L3FeedBuilder::flush() {
+    if (!sink || output.empty()) return true;
+    bool written = sink->write(output);
+    output.clear();
+    return written;
+}
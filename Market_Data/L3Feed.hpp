@@ -0,0 +1,156 @@
+#ifndef L3FEED_HPP
+#define L3FEED_HPP
+
+#include "../Limit_Order_Book/Book.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// Order-by-order (L3) feed in the style of NASDAQ ITCH: fixed-length binary
+// records, integers big-endian, each starting with a one-byte type
+//
+//   header   type u8 | locate u16 | sequence u64 | timestamp u64 (ns)
+//   'A' add      header | orderId u32 | side u8 ('B'/'S') | shares u32 | price u32   32 bytes
+//   'E' execute  header | orderId u32 | shares u32 | price u32 | takerId u32         35 bytes
+//   'D' delete   header | orderId u32                                              23 bytes
+//   'U' replace  header | orderId u32 | shares u32 | price u32                       31 bytes
+//
+// locate is the symbol id. Sequence numbers count a stream's records from
+// 1, and all records from one inbound message share its timestamp. In a
+// stream every record is preceded by its u16 length, as in ITCH files and
+// MoldUDP64 packets, so readers can skip types they do not know.
+struct L3Message {
+    static constexpr char Add = 'A';
+    static constexpr char Execute = 'E';
+    static constexpr char Delete = 'D';
+    static constexpr char Replace = 'U';
+
+    static constexpr size_t headerLength = 19;
+    static constexpr size_t maxLength = 35;
+
+    char type = Add;
+    uint16_t locate = 0;
+    uint64_t sequence = 0;
+    uint64_t timestamp = 0;
+    int orderId = 0;
+    bool buySide = false;  // Add only
+    int shares = 0;
+    int price = 0;
+    int takerId = 0;       // Execute only
+
+    // Record length for a type, or 0 if the type is unknown
+    static size_t length(char type);
+
+    // Write the record (without length prefix) to out, which needs room for
+    // maxLength bytes; returns its length
+    size_t encode(char* out) const;
+    // Read one record; false if it is truncated or of an unknown type
+    bool decode(std::string_view record);
+};
+
+// Where encoded streams go
+class L3Sink {
+public:
+    virtual ~L3Sink() = default;
+    // stream holds whole length-prefixed records
+    virtual bool write(std::string_view stream) = 0;
+};
+
+// Appends the stream to a file, as ITCH files are stored
+class L3FileSink : public L3Sink {
+public:
+    explicit L3FileSink(const char* path);
+    ~L3FileSink() override;
+
+    L3FileSink(const L3FileSink&) = delete;
+    L3FileSink& operator=(const L3FileSink&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    bool write(std::string_view stream) override;
+    void flush();
+
+private:
+    std::FILE* file;
+};
+
+// Sends the stream as UDP datagrams to a multicast group, one MoldUDP64
+// style packet per datagram: session[10] | first sequence u64 | count u16,
+// then the length-prefixed records. Packets are cut at record boundaries.
+// By default the group is reached through the loopback interface, so it
+// stays on this machine.
+class L3MulticastSink : public L3Sink {
+public:
+    static constexpr size_t packetHeaderLength = 20;
+    static constexpr size_t maxPacketLength = 1400;
+
+    L3MulticastSink(const char* group, uint16_t port, const char* interfaceAddress = "127.0.0.1",
+                    std::string_view session = "LOB");
+    ~L3MulticastSink() override;
+
+    L3MulticastSink(const L3MulticastSink&) = delete;
+    L3MulticastSink& operator=(const L3MulticastSink&) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+    bool write(std::string_view stream) override;
+    uint64_t getPacketsSent() const { return packetsSent; }
+
+private:
+    int fd = -1;
+    uint32_t groupAddress = 0;  // network byte order
+    uint16_t groupPort = 0;
+    char session[10] = {};
+    char packet[maxPacketLength];
+    uint64_t packetsSent = 0;
+
+    bool sendPacket(uint64_t firstSequence, uint16_t count, size_t length);
+};
+
+// Builds the L3 stream for one book.
+//
+// The book records every visible order change an order call makes
+// (Book::getOrderEvents): resting adds, executions against resting orders,
+// cancels and replaces. onEvent() turns those into records with the next
+// sequence numbers and appends them to a reused output buffer, which goes
+// to the sink once it passes flushBytes (or on flush()).
+class L3FeedBuilder {
+public:
+    // Turns on order event tracking in book. sink may be null, in which case
+    // the output just accumulates until clearOutput().
+    L3FeedBuilder(Book& book, uint16_t locate, L3Sink* sink = nullptr, size_t flushBytes = 64 * 1024);
+    ~L3FeedBuilder();
+
+    L3FeedBuilder(const L3FeedBuilder&) = delete;
+    L3FeedBuilder& operator=(const L3FeedBuilder&) = delete;
+
+    // After each order call on the book, stamped with the current time or a
+    // given one (ns). Returns the number of records added.
+    size_t onEvent();
+    size_t onEvent(uint64_t timestamp);
+
+    // Send whatever is buffered to the sink
+    bool flush();
+
+    const std::string& getOutput() const { return output; }
+    void clearOutput() { output.clear(); }
+    // Sequence number of the last record written
+    uint64_t getSequence() const { return sequence; }
+    // Stream bytes produced so far, length prefixes included
+    uint64_t getBytes() const { return bytes; }
+
+private:
+    Book& book;
+    uint16_t locate;
+    L3Sink* sink;
+    size_t flushBytes;
+    std::string output;
+    uint64_t sequence = 0;
+    uint64_t bytes = 0;
+};
+
+// Nanoseconds since the epoch, as stamped by L3FeedBuilder::onEvent()
+uint64_t l3Timestamp();
+
+#endif
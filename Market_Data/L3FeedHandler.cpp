@@ -0,0 +1,101 @@
+#include "L3FeedHandler.hpp"
+
+#include <sstream>
+#include <vector>
+
+L3FeedHandler::L3FeedHandler(Book& _book, uint16_t _locate) : book(_book), locate(_locate) {}
+
+size_t L3FeedHandler::onData(std::string_view stream) {
+    size_t offset = 0;
+    while (offset + 2 <= stream.size()) {
+        size_t length = (static_cast<size_t>(static_cast<unsigned char>(stream[offset])) << 8)
+                      | static_cast<unsigned char>(stream[offset + 1]);
+        if (offset + 2 + length > stream.size()) break;
+        if (message.decode(stream.substr(offset + 2, length))) {
+            apply(message);
+        } else {
+            ++errors;
+        }
+        offset += 2 + length;
+    }
+    return offset;
+}
+
+bool L3FeedHandler::onPacket(std::string_view datagram) {
+    if (datagram.size() < L3MulticastSink::packetHeaderLength) return false;
+    std::string_view records = datagram.substr(L3MulticastSink::packetHeaderLength);
+    return onData(records) == records.size();
+}
+
+bool L3FeedHandler::apply(const L3Message& record) {
+    if (record.locate != locate) return true;
+    if (record.sequence <= sequence) {
+        ++duplicates;
+        return true;
+    }
+    if (record.sequence != sequence + 1) ++gaps;
+    sequence = record.sequence;
+    ++messages;
+
+    bool applied = true;
+    switch (record.type) {
+        case L3Message::Add:
+            applied = book.insertRestingOrder(record.orderId, record.buySide, record.shares, record.price);
+            break;
+        case L3Message::Execute:
+            applied = book.executeRestingOrder(record.orderId, record.shares, record.takerId);
+            break;
+        case L3Message::Delete:
+            applied = book.searchOrderMap(record.orderId) != nullptr;
+            book.cancelLimitOrder(record.orderId);
+            break;
+        case L3Message::Replace:
+            applied = book.searchOrderMap(record.orderId) != nullptr;
+            book.modifyLimitOrder(record.orderId, record.shares, record.price);
+            break;
+        default:
+            applied = false;
+            break;
+    }
+    if (!applied) ++errors;
+    return applied;
+}
+
+namespace {
+    std::string compareSide(const std::vector<Limit*>& source, const std::vector<Limit*>& rebuilt, const char* side) {
+        std::ostringstream difference;
+        if (source.size() != rebuilt.size()) {
+            difference << side << ": " << source.size() << " levels, rebuilt has " << rebuilt.size();
+            return difference.str();
+        }
+        for (size_t i = 0; i < source.size(); ++i) {
+            const Limit& expected = *source[i];
+            const Limit& actual = *rebuilt[i];
+            if (expected.getLimitPrice() != actual.getLimitPrice() || expected.getTotalVolume() != actual.getTotalVolume()
+                || expected.getSize() != actual.getSize()) {
+                difference << side << " level " << i << ": " << expected.getTotalVolume() << " in "
+                           << expected.getSize() << " orders at " << expected.getLimitPrice() << ", rebuilt has "
+                           << actual.getTotalVolume() << " in " << actual.getSize() << " orders at "
+                           << actual.getLimitPrice();
+                return difference.str();
+            }
+            const Order* a = expected.getHeadOrder();
+            const Order* b = actual.getHeadOrder();
+            for (int position = 0; a && b; ++position, a = a->nextOrder, b = b->nextOrder) {
+                if (a->getOrderId() != b->getOrderId() || a->getShares() != b->getShares()) {
+                    difference << side << " " << expected.getLimitPrice() << " position " << position << ": order "
+                               << a->getOrderId() << " x" << a->getShares() << ", rebuilt has order "
+                               << b->getOrderId() << " x" << b->getShares();
+                    return difference.str();
+                }
+            }
+        }
+        return {};
+    }
+}
+
+std::string compareBooks(const Book& source, const Book& rebuilt) {
+    std::string difference = compareSide(source.getBuyLimits(), rebuilt.getBuyLimits(), "bids");
+    if (difference.empty()) difference = compareSide(source.getSellLimits(), rebuilt.getSellLimits(), "asks");
+    return difference;
+}
@@ -0,0 +1,68 @@
+#ifndef L3FEEDHANDLER_HPP
+#define L3FEEDHANDLER_HPP
+
+#include "L3Feed.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Consumer side of the L3 feed: rebuilds a book from the stream that an
+// L3FeedBuilder produced, for testing downstream systems against a real
+// book.
+//
+// Records are applied with Book's direct maintenance calls: adds rest
+// without matching, executions take shares off the named order, deletes
+// cancel and replaces modify. The rebuilt book therefore holds the same
+// resting orders, levels and FIFO order as the source (stops excepted,
+// since the feed never shows them).
+//
+// Sequence numbers are checked: records at or below the last one applied
+// are skipped as duplicates (as after a MoldUDP64 retransmission), and a
+// jump forward counts as a gap but is still applied.
+class L3FeedHandler {
+public:
+    // Rebuilds into book, applying only records for locate
+    L3FeedHandler(Book& book, uint16_t locate);
+
+    L3FeedHandler(const L3FeedHandler&) = delete;
+    L3FeedHandler& operator=(const L3FeedHandler&) = delete;
+
+    // Apply the whole length-prefixed records at the start of stream and
+    // return the bytes they took. A record cut off at the end is not
+    // applied; pass it again with the rest of the stream.
+    size_t onData(std::string_view stream);
+    // Apply the records of one L3MulticastSink datagram; false if it is
+    // not a whole packet
+    bool onPacket(std::string_view datagram);
+    // Apply one decoded record; false if the book could not (unknown
+    // order, shares that do not match)
+    bool apply(const L3Message& record);
+
+    // Sequence number of the last record applied
+    uint64_t getSequence() const { return sequence; }
+    uint64_t getMessageCount() const { return messages; }
+    uint64_t getGapCount() const { return gaps; }
+    uint64_t getDuplicateCount() const { return duplicates; }
+    uint64_t getErrorCount() const { return errors; }
+
+private:
+    Book& book;
+    uint16_t locate;
+    uint64_t sequence = 0;
+    uint64_t messages = 0;
+    uint64_t gaps = 0;
+    uint64_t duplicates = 0;
+    uint64_t errors = 0;
+    L3Message message;
+};
+
+// Verification: compare the buy and sell ladders of two books level by
+// level (price, volume, order count) and order by order within each level
+// (id and shares, in FIFO order). Returns an empty string if they match,
+// otherwise a description of the first difference.
+std::string compareBooks(const Book& source, const Book& rebuilt);
+
+#endif
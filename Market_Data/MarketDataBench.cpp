@@ -0,0 +1,147 @@
+#include "BBOTicker.hpp"
+#include "DepthCodec.hpp"
+#include "L2Feed.hpp"
+#include "L3Feed.hpp"
+#include "TradeTape.hpp"
+#include "../Generate_Orders/GenerateOrders.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Cost of generating market data on the matching thread.
+// Usage: MarketDataBench [commands] [seed] [l3File]
+//
+// Replays one generated single-symbol log into a fresh book per run: once
+// bare, then with each feed attached (the BBO ticker with four consumers of
+// different intervals, the trade tape with 10ms and 1s bars), and prints the time per command and how much each
+// feed produced, then the size and cost of full-depth snapshots. The L3
+// stream is written to l3File if given and otherwise discarded.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template <typename OnEvent>
+    double replay(const std::vector<OrderCommand>& log, Book& book, OnEvent onEvent) {
+        auto start = Clock::now();
+        for (const OrderCommand& command : log) {
+            try {
+                applyOrderCommand(book, command);
+            } catch (const std::exception&) {}
+            onEvent();
+        }
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Microseconds per call of fn, averaged over repeats
+    template <typename Fn>
+    double timeEach(int repeats, Fn fn) {
+        auto start = Clock::now();
+        for (int n = 0; n < repeats; ++n) fn();
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / repeats;
+    }
+
+    void printRun(const char* name, double seconds, size_t count) {
+        std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(8) << seconds * 1e9 / static_cast<double>(count) << " ns/command";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 2000000;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 42;
+    const char* l3Path = argc > 3 ? argv[3] : nullptr;
+
+    std::vector<OrderCommand> log = generateCommandLog(1, count, seed);
+    std::cout << count << " commands on one book" << std::endl;
+
+    {
+        Book book;
+        printRun("bare", replay(log, book, []() {}), count);
+        std::cout << std::endl;
+    }
+
+    {
+        Book book;
+        BBOTicker ticker(book);
+        const int intervals[] = {0, 10, 100, 1000};
+        std::vector<BBOTicker::Consumer*> consumers;
+        for (int interval : intervals) consumers.push_back(&ticker.subscribe(std::chrono::microseconds(interval)));
+        double seconds = replay(log, book, [&ticker]() { ticker.onEvent(); });
+        printRun("BBO", seconds, count);
+        std::cout << "   " << ticker.getChangeCount() << " changes; published per consumer:";
+        for (size_t i = 0; i < consumers.size(); ++i) {
+            std::cout << " " << consumers[i]->getPublishCount() << " (" << intervals[i] << "us)";
+        }
+        std::cout << std::endl;
+    }
+
+    {
+        Book book;
+        L2FeedBuilder feed(book);
+        double seconds = replay(log, book, [&feed]() { feed.onEvent(); });
+        printRun("L2", seconds, count);
+        std::cout << "   " << feed.getSequence() << " messages, " << std::setprecision(2)
+                  << static_cast<double>(feed.getUpdateCount()) / static_cast<double>(feed.getSequence())
+                  << " level updates per message" << std::endl;
+    }
+
+    {
+        Book book;
+        std::unique_ptr<L3FileSink> file;
+        if (l3Path) file = std::make_unique<L3FileSink>(l3Path);
+        L3FeedBuilder feed(book, 0, file.get());
+        double seconds = replay(log, book, [&]() {
+            feed.onEvent();
+            if (!file && feed.getOutput().size() >= 64 * 1024) feed.clearOutput();
+        });
+        feed.flush();
+        printRun("L3", seconds, count);
+        std::cout << "   " << feed.getSequence() << " records, " << std::setprecision(1)
+                  << static_cast<double>(feed.getBytes()) / static_cast<double>(feed.getSequence()) << " bytes per record"
+                  << (l3Path ? ", written to " : "") << (l3Path ? l3Path : "") << std::endl;
+    }
+
+    {
+        Book book;
+        TradeTape tape(book);
+        BarSeries& bars = tape.addBars(10000000ull);
+        tape.addBars(1000000000ull);
+        double seconds = replay(log, book, [&tape]() { tape.onEvent(); });
+        printRun("Tape", seconds, count);
+        std::cout << "   " << tape.getTradeCount() << " trades in " << bars.getBarCount()
+                  << " 10ms bars, VWAP " << std::setprecision(2) << bars.vwap() << std::endl;
+    }
+
+    // Full-depth snapshot of the replayed book, then of a deep one
+    {
+        Book replayed;
+        replay(log, replayed, []() {});
+        Book deep;
+        int orderId = 1;
+        for (int level = 0; level < 5000; ++level) {
+            deep.addLimitOrder(orderId++, true, 100 + level % 50, 100000 - level);
+            deep.addLimitOrder(orderId++, false, 100 + level % 50, 100001 + level);
+        }
+        for (const Book* book : {&replayed, &deep}) {
+            std::string image;
+            DepthSnapshot decoded;
+            double encode = timeEach(1000, [&]() {
+                image.clear();
+                encodeDepthSnapshot(*book, 1, image);
+            });
+            double decode = timeEach(1000, [&]() { decodeDepthSnapshot(image, decoded); });
+            std::cout << "Snapshot  " << book->getBuyLimits().size() + book->getSellLimits().size() << " levels: "
+                      << image.size() << " bytes (" << std::setprecision(2)
+                      << static_cast<double>(image.size()) / static_cast<double>(decoded.bids.size() + decoded.asks.size())
+                      << " per level), encode " << encode << " us, decode " << decode << " us" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "TradeTape.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+BarSeries::BarSeries(uint64_t _interval, size_t capacity)
+    : interval(std::max<uint64_t>(_interval, 1)), bars(std::max<size_t>(capacity, 1)) {}
+
+void BarSeries::add(const Trade& trade) {
+    uint64_t start = trade.timestamp - trade.timestamp % interval;
+    if (count == 0 || start > bars[(count - 1) % bars.size()].start) {
+        // First trade of a new interval opens the next bar
+        Bar& bar = bars[count % bars.size()];
+        bar = Bar{};
+        bar.start = start;
+        bar.open = bar.high = bar.low = trade.price;
+        ++count;
+    }
+    Bar& bar = bars[(count - 1) % bars.size()];
+    bar.high = std::max(bar.high, trade.price);
+    bar.low = std::min(bar.low, trade.price);
+    bar.close = trade.price;
+    int64_t notionalValue = static_cast<int64_t>(trade.price) * trade.shares;
+    bar.volume += trade.shares;
+    bar.notional += notionalValue;
+    ++bar.tradeCount;
+    volume += trade.shares;
+    notional += notionalValue;
+}
+
+TradeTape::TradeTape(const Book& _book, size_t capacity)
+    : book(_book), ring(std::bit_ceil(std::max<size_t>(capacity, 1))), mask(ring.size() - 1) {}
+
+BarSeries& TradeTape::addBars(uint64_t interval, size_t barCapacity) {
+    series.push_back(std::make_unique<BarSeries>(interval, barCapacity));
+    return *series.back();
+}
+
+size_t TradeTape::onEvent() {
+    // Only read the clock for calls that traded
+    if (book.getFills().empty()) return 0;
+    return onEvent(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+}
+
+size_t TradeTape::onEvent(uint64_t timestamp) {
+    const std::vector<Fill>& fills = book.getFills();
+    for (const Fill& fill : fills) {
+        ++count;
+        Trade& trade = ring[(count - 1) & mask];
+        trade = Trade{count, timestamp, fill.price, fill.shares, fill.takerBuys, fill.makerId, fill.takerId};
+        for (const std::unique_ptr<BarSeries>& bars : series) bars->add(trade);
+    }
+    return fills.size();
+}
@@ -0,0 +1,103 @@
+#ifndef TRADETAPE_HPP
+#define TRADETAPE_HPP
+
+#include "../Limit_Order_Book/Book.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// One print on the tape
+struct Trade {
+    uint64_t sequence;   // trades on this tape so far, from 1
+    uint64_t timestamp;  // ns since the epoch
+    int price;
+    int shares;
+    bool takerBuys;      // aggressor side
+    int makerId;
+    int takerId;
+};
+
+// Open/high/low/close, volume and VWAP of the trades in one interval
+struct Bar {
+    uint64_t start = 0;   // ns, a multiple of the interval
+    int open = 0;
+    int high = 0;
+    int low = 0;
+    int close = 0;
+    int64_t volume = 0;
+    int64_t notional = 0;  // sum of price * shares
+    uint32_t tradeCount = 0;
+
+    double vwap() const { return volume ? static_cast<double>(notional) / static_cast<double>(volume) : 0.0; }
+};
+
+// Bars of one interval, maintained trade by trade. Only intervals that
+// had trades get a bar. The last `capacity` bars are kept, the newest of
+// which is the one still filling.
+class BarSeries {
+public:
+    BarSeries(uint64_t interval, size_t capacity);
+
+    void add(const Trade& trade);
+
+    uint64_t getInterval() const { return interval; }
+    // Bars held, and bars ever started
+    size_t size() const { return count < bars.size() ? static_cast<size_t>(count) : bars.size(); }
+    uint64_t getBarCount() const { return count; }
+    // ago = 0 is the newest bar; ago < size()
+    const Bar& getBar(size_t ago) const { return bars[(count - 1 - ago) % bars.size()]; }
+
+    // Totals over every trade added, for the session VWAP
+    int64_t getVolume() const { return volume; }
+    double vwap() const { return volume ? static_cast<double>(notional) / static_cast<double>(volume) : 0.0; }
+
+private:
+    uint64_t interval;
+    std::vector<Bar> bars;
+    uint64_t count = 0;
+    int64_t volume = 0;
+    int64_t notional = 0;
+};
+
+// Trade tape of one book.
+//
+// The book lists the fills of each order call (Book::getFills), aggressor
+// side included. After each call, onEvent() appends them to a ring of the
+// last `capacity` trades and folds each into every bar series, so bars and
+// VWAP are always current and never need a scan of the tape. Like the
+// feeds, it runs on the thread that owns the book.
+class TradeTape {
+public:
+    // capacity is rounded up to a power of two
+    explicit TradeTape(const Book& book, size_t capacity = 1 << 16);
+
+    TradeTape(const TradeTape&) = delete;
+    TradeTape& operator=(const TradeTape&) = delete;
+
+    // Keep bars of interval ns, the last barCapacity of them. Add series
+    // before the first trade; they live as long as the tape.
+    BarSeries& addBars(uint64_t interval, size_t barCapacity = 1024);
+
+    // After each order call on the book, stamped with the wall clock or a
+    // given time (ns since the epoch). Returns the number of trades appended.
+    size_t onEvent();
+    size_t onEvent(uint64_t timestamp);
+
+    // Trades ever appended, and the sequence of the oldest one still held
+    uint64_t getTradeCount() const { return count; }
+    uint64_t getOldestSequence() const { return count > ring.size() ? count - ring.size() + 1 : 1; }
+    // Trade by sequence, getOldestSequence() <= sequence <= getTradeCount()
+    const Trade& getTrade(uint64_t sequence) const { return ring[(sequence - 1) & mask]; }
+    const Trade& getLastTrade() const { return getTrade(count); }
+
+private:
+    const Book& book;
+    std::vector<Trade> ring;
+    uint64_t mask;
+    uint64_t count = 0;
+    std::vector<std::unique_ptr<BarSeries>> series;
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "AsyncEngine.hpp"
+#include "ThreadUtils.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Many client coroutines submitting to one AsyncEngine.
+// Usage: AsyncClients [executors] [clientsPerExecutor] [ordersPerClient]
+//
+// Each executor is one thread running its clients' coroutines. A client
+// awaits every order before sending the next, so up to executors *
+// clientsPerExecutor orders are in flight with no thread per client. Orders
+// are generated up front; the run reports throughput, submit-to-resume
+// latency and how many coroutine frames had to come from the heap.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct ClientStats {
+        std::vector<double> latencies;
+        long long filledShares = 0;
+    };
+
+    AsyncTask client(AsyncEngine& engine, const std::vector<OrderCommand>& orders, ClientStats& stats,
+                     std::atomic<int>& done) {
+        for (const OrderCommand& order : orders) {
+            auto start = Clock::now();
+            SubmitResult result = co_await engine.submit(order);
+            stats.latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            stats.filledShares += result.filledShares;
+        }
+        done.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Limits around 100 with some cancels and market orders, ids unique per client
+    std::vector<OrderCommand> generateOrders(int clientId, int count, std::mt19937& gen) {
+        std::uniform_int_distribution<> percent(0, 99);
+        std::uniform_int_distribution<> offset(0, 9);
+        std::uniform_int_distribution<> shares(1, 100);
+        std::vector<OrderCommand> orders;
+        orders.reserve(count);
+        int firstId = clientId * count + 1;
+        for (int i = 0; i < count; ++i) {
+            OrderCommand order;
+            order.symbolId = clientId % 8;
+            order.orderId = firstId + i;
+            order.buyOrSell = percent(gen) < 50;
+            order.shares = shares(gen);
+            int roll = percent(gen);
+            if (roll < 5) {
+                order.type = OrderCommand::Market;
+            } else if (roll < 25 && i > 0) {
+                order.type = OrderCommand::CancelLimit;
+                order.orderId = firstId + std::uniform_int_distribution<>(0, i - 1)(gen);
+            } else {
+                order.type = OrderCommand::AddLimit;
+                order.limitPrice = order.buyOrSell ? 95 + offset(gen) : 96 + offset(gen);
+            }
+            orders.push_back(order);
+        }
+        return orders;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int executors = argc > 1 ? std::atoi(argv[1]) : 2;
+    int clientsPerExecutor = argc > 2 ? std::atoi(argv[2]) : 256;
+    int ordersPerClient = argc > 3 ? std::atoi(argv[3]) : 2000;
+    if (executors < 1) executors = 1;
+    if (clientsPerExecutor < 1) clientsPerExecutor = 1;
+    if (ordersPerClient < 1) ordersPerClient = 1;
+    int clients = executors * clientsPerExecutor;
+
+    std::mt19937 gen(42);
+    std::vector<std::vector<OrderCommand>> orders;
+    for (int c = 0; c < clients; ++c) {
+        orders.push_back(generateOrders(c, ordersPerClient, gen));
+    }
+    std::vector<ClientStats> stats(clients);
+    for (ClientStats& clientStats : stats) clientStats.latencies.reserve(ordersPerClient);
+
+    AsyncEngine engine(WaitStrategy::Yield);
+    engine.start();
+
+    uint64_t framesBefore = FramePool::getHeapAllocations();
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int e = 0; e < executors; ++e) {
+        threads.emplace_back([&, e]() {
+            ClientExecutor executor(WaitStrategy::Yield);
+            std::atomic<int> done{0};
+            for (int c = e * clientsPerExecutor; c < (e + 1) * clientsPerExecutor; ++c) {
+                executor.spawn([&, c]() { client(engine, orders[c], stats[c], done); });
+            }
+            executor.runUntil([&]() { return done.load(std::memory_order_relaxed) == clientsPerExecutor; });
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    uint64_t frames = FramePool::getHeapAllocations() - framesBefore;
+    engine.stop();
+
+    std::vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(clients) * ordersPerClient);
+    long long filledShares = 0;
+    for (const ClientStats& clientStats : stats) {
+        latencies.insert(latencies.end(), clientStats.latencies.begin(), clientStats.latencies.end());
+        filledShares += clientStats.filledShares;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    uint64_t total = engine.getCommandsProcessed();
+    std::cout << executors << " executor(s) x " << clientsPerExecutor << " clients, " << total << " orders, "
+              << availableCpuCount() << " CPUs" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << static_cast<uint64_t>(total / seconds) << " orders/sec, " << filledShares << " shares filled, "
+              << engine.getErrorCount() << " rejected" << std::endl;
+    std::cout << "submit to resume: p50 " << latencies[latencies.size() / 2]
+              << "us  p99 " << latencies[latencies.size() * 99 / 100]
+              << "us  max " << latencies.back() << "us" << std::endl;
+    std::cout << frames << " coroutine frames from the heap (" << clients << " clients)" << std::endl;
+    return 0;
+}
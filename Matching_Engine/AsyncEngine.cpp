@@ -0,0 +1,181 @@
+#include "AsyncEngine.hpp"
+#include "ThreadUtils.hpp"
+
+#include <new>
+
+namespace {
+    constexpr size_t frameGranularity = 64;
+    constexpr size_t frameClasses = 32;  // pooled frames up to 2KB
+
+    struct FreeFrame {
+        FreeFrame* next;
+    };
+
+    // This thread's free lists; whatever is left goes back to the heap when
+    // the thread exits
+    struct FrameCache {
+        FreeFrame* lists[frameClasses] = {};
+
+        ~FrameCache() {
+            for (FreeFrame*& list : lists) {
+                while (list) {
+                    FreeFrame* next = list->next;
+                    ::operator delete(list);
+                    list = next;
+                }
+            }
+        }
+    };
+
+    thread_local FrameCache frameCache;
+    std::atomic<uint64_t> heapAllocations{0};
+
+    size_t frameClass(size_t size) {
+        return (size + frameGranularity - 1) / frameGranularity - 1;
+    }
+}
+
+void* FramePool::allocate(size_t size) {
+    size_t sizeClass = frameClass(size);
+    if (sizeClass < frameClasses) {
+        FreeFrame*& list = frameCache.lists[sizeClass];
+        if (list) {
+            FreeFrame* frame = list;
+            list = frame->next;
+            return frame;
+        }
+        heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new((sizeClass + 1) * frameGranularity);
+    }
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void FramePool::release(void* frame, size_t size) {
+    size_t sizeClass = frameClass(size);
+    if (sizeClass < frameClasses) {
+        FreeFrame* freed = static_cast<FreeFrame*>(frame);
+        freed->next = frameCache.lists[sizeClass];
+        frameCache.lists[sizeClass] = freed;
+        return;
+    }
+    ::operator delete(frame);
+}
+
+uint64_t FramePool::getHeapAllocations() {
+    return heapAllocations.load(std::memory_order_relaxed);
+}
+
+thread_local ClientExecutor* ClientExecutor::currentExecutor = nullptr;
+
+ClientExecutor::~ClientExecutor() {
+    while (posting.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+}
+
+size_t ClientExecutor::runReady() {
+    AsyncOperation* operation = ready.takeAll();
+    if (!operation) return 0;
+
+    ClientExecutor* previous = currentExecutor;
+    currentExecutor = this;
+    size_t count = 0;
+    while (operation) {
+        // Resuming may free the operation, so step past it first
+        AsyncOperation* next = operation->next;
+        operation->continuation.resume();
+        operation = next;
+        ++count;
+    }
+    currentExecutor = previous;
+    return count;
+}
+
+AsyncEngine::AsyncEngine(WaitStrategy _wait, int _cpu) : wait(_wait), cpu(_cpu) {}
+
+AsyncEngine::~AsyncEngine() {
+    stop();
+}
+
+void AsyncEngine::start() {
+    if (running.exchange(true)) return;
+    thread = std::thread(&AsyncEngine::run, this);
+}
+
+void AsyncEngine::stop() {
+    if (!running.exchange(false)) return;
+    inbound.wake();
+    if (thread.joinable()) thread.join();
+}
+
+Book* AsyncEngine::findBook(int symbolId) const {
+    if (symbolId < 0 || static_cast<size_t>(symbolId) >= books.size()) return nullptr;
+    return books[symbolId].get();
+}
+
+void AsyncEngine::match(SubmitAwaiter& request) {
+    SubmitResult& result = request.result;
+    const OrderCommand& command = request.command;
+    if (command.symbolId < 0) {
+        result.error = true;
+        errors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    size_t index = static_cast<size_t>(command.symbolId);
+    if (index >= books.size()) books.resize(index + 1);
+    if (!books[index]) books[index] = std::make_unique<Book>();
+    Book& book = *books[index];
+
+    try {
+        applyOrderCommand(book, command);
+    } catch (const std::exception&) {
+        result.error = true;
+        errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const std::vector<Fill>& fills = book.getFills();
+    result.fillCount = static_cast<uint32_t>(fills.size());
+    for (size_t i = 0; i < fills.size(); ++i) {
+        if (i < SubmitResult::maxFills) result.fills[i] = fills[i];
+        result.filledShares += fills[i].shares;
+    }
+    result.bestBid = book.getBestBidPrice();
+    result.bestAsk = book.getBestAskPrice();
+}
+
+size_t AsyncEngine::complete(AsyncOperation* operation) {
+    size_t count = 0;
+    while (operation) {
+        // Once handed back the operation belongs to its coroutine again
+        AsyncOperation* next = operation->next;
+        SubmitAwaiter& request = static_cast<SubmitAwaiter&>(*operation);
+        match(request);
+        ++count;
+        // Single writer, so a plain store publishes the count
+        processed.store(processed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        if (request.executor) {
+            request.executor->post(&request);
+        } else {
+            request.continuation.resume();
+        }
+        operation = next;
+    }
+    return count;
+}
+
+void AsyncEngine::run() {
+    if (cpu >= 0) pinCurrentThread(cpu);
+
+    IdleStrategy idleStrategy(wait);
+    auto park = [this]() { inbound.park([this]() { return running.load(); }); };
+    while (running.load(std::memory_order_relaxed)) {
+        if (complete(inbound.takeAll()) > 0) {
+            idleStrategy.reset();
+            continue;
+        }
+        idleStrategy.idle(park);
+    }
+    // Finish whatever raced with stop(), including anything coroutines
+    // resumed here submit on their way out
+    while (complete(inbound.takeAll()) > 0) {}
+}
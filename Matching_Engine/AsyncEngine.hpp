@@ -0,0 +1,267 @@
+#ifndef ASYNCENGINE_HPP
+#define ASYNCENGINE_HPP
+
+#include "WaitStrategy.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Coroutine frames recycled through per-thread free lists, one per 64-byte
+// size class, so a client that keeps starting short-lived coroutines only
+// touches the heap until its lists are warm. Frames may be released on
+// another thread; they then join that thread's lists.
+class FramePool {
+public:
+    static void* allocate(size_t size);
+    static void release(void* frame, size_t size);
+    // Frames that had to come from the heap, across all threads
+    static uint64_t getHeapAllocations();
+};
+
+// Fire-and-forget coroutine: starts running straight away and frees itself
+// when it returns. Its frame comes from FramePool.
+class AsyncTask {
+public:
+    struct promise_type {
+        AsyncTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+
+        static void* operator new(size_t size) { return FramePool::allocate(size); }
+        static void operator delete(void* frame, size_t size) { FramePool::release(frame, size); }
+    };
+};
+
+// A suspended coroutine waiting to be handed somewhere. Lives inside the
+// awaiter (and so inside the coroutine frame); queues link it intrusively.
+struct AsyncOperation {
+    AsyncOperation* next = nullptr;
+    std::coroutine_handle<> continuation;
+};
+
+// Unbounded lock-free multi-producer / single-consumer list of operations.
+// Producers push with one CAS; the consumer takes everything at once. It
+// never allocates and never fills up: each suspended coroutine has at most
+// one operation queued, so its length is bounded by the coroutines alive.
+class OperationQueue {
+public:
+    // Any thread. The operation may be resumed (and freed) as soon as this
+    // returns; it is not touched after being linked in.
+    void push(AsyncOperation* operation) {
+        AsyncOperation* first = head.load(std::memory_order_relaxed);
+        do {
+            operation->next = first;
+        } while (!head.compare_exchange_weak(first, operation, std::memory_order_release, std::memory_order_relaxed));
+        // Pairs with the fence in park(), as in SPSCQueue
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumerParked.load(std::memory_order_relaxed)) wake();
+    }
+
+    // Consumer only. Everything pushed so far, oldest first, or nullptr.
+    AsyncOperation* takeAll() {
+        AsyncOperation* list = head.exchange(nullptr, std::memory_order_acquire);
+        AsyncOperation* ordered = nullptr;
+        while (list) {
+            AsyncOperation* next = list->next;
+            list->next = ordered;
+            ordered = list;
+            list = next;
+        }
+        return ordered;
+    }
+
+    // Consumer only. Sleeps until something is pushed or wake() is called.
+    template <typename Predicate>
+    void park(Predicate stillWanted) {
+        uint32_t seen = wakeups.load(std::memory_order_acquire);
+        consumerParked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (empty() && stillWanted()) {
+            wakeups.wait(seen, std::memory_order_acquire);
+        }
+        consumerParked.store(false, std::memory_order_relaxed);
+    }
+
+    void wake() {
+        wakeups.fetch_add(1, std::memory_order_release);
+        wakeups.notify_one();
+    }
+
+    bool empty() const { return head.load(std::memory_order_relaxed) == nullptr; }
+
+private:
+    alignas(64) std::atomic<AsyncOperation*> head{nullptr};
+    std::atomic<bool> consumerParked{false};
+    std::atomic<uint32_t> wakeups{0};
+};
+
+// Single-threaded run loop for client coroutines. Whoever finishes an
+// operation (e.g. the matching thread) posts it here, and the coroutine
+// resumes on the thread running this executor instead of the one that
+// completed it.
+class ClientExecutor {
+public:
+    explicit ClientExecutor(WaitStrategy _wait = WaitStrategy::Park) : wait(_wait) {}
+    // Waits for any post() still in progress on another thread
+    ~ClientExecutor();
+
+    ClientExecutor(const ClientExecutor&) = delete;
+    ClientExecutor& operator=(const ClientExecutor&) = delete;
+
+    // Any thread
+    void post(AsyncOperation* operation) {
+        // The coroutine may resume, finish and let the executor go away before
+        // push() returns; the destructor waits for posting to drop to zero
+        posting.fetch_add(1, std::memory_order_relaxed);
+        ready.push(operation);
+        posting.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Start a coroutine here: makeTask() runs with this as the current
+    // executor, so the operations it starts resume here
+    template <typename MakeTask>
+    void spawn(MakeTask&& makeTask) {
+        ClientExecutor* previous = currentExecutor;
+        currentExecutor = this;
+        makeTask();
+        currentExecutor = previous;
+    }
+
+    // Resume everything posted so far; returns how many were resumed
+    size_t runReady();
+
+    // Run until done() is true, idling with the wait strategy in between
+    template <typename Predicate>
+    void runUntil(Predicate done) {
+        IdleStrategy idleStrategy(wait);
+        while (!done()) {
+            if (runReady() > 0) {
+                idleStrategy.reset();
+                continue;
+            }
+            idleStrategy.idle([&]() { ready.park([&]() { return !done(); }); });
+        }
+    }
+
+    // Wake a parked runUntil() after changing what its predicate reads from
+    // another thread
+    void wake() { ready.wake(); }
+
+    // Executor running on this thread (inside spawn or runReady), or nullptr
+    static ClientExecutor* current() { return currentExecutor; }
+
+private:
+    OperationQueue ready;
+    WaitStrategy wait;
+    std::atomic<uint32_t> posting{0};
+
+    static thread_local ClientExecutor* currentExecutor;
+};
+
+// Outcome of one submitted command, held inline so awaiting it never
+// allocates. Commands that fill more than maxFills times keep the first
+// maxFills; fillCount and filledShares still cover all of them.
+struct SubmitResult {
+    static constexpr size_t maxFills = 16;
+
+    uint32_t fillCount = 0;
+    int filledShares = 0;
+    int bestBid = 0;
+    int bestAsk = 0;
+    bool error = false;  // the book rejected the command
+    Fill fills[maxFills];
+
+    std::span<const Fill> getFills() const {
+        return {fills, fillCount < maxFills ? fillCount : maxFills};
+    }
+};
+
+// Coroutine facade over a single matching thread that owns every book
+// (keyed by command.symbolId, created on first use):
+//
+//     AsyncTask client(AsyncEngine& engine, OrderCommand order) {
+//         SubmitResult result = co_await engine.submit(order);
+//         ...
+//     }
+//
+// Any number of threads and coroutines may submit. The awaiter (command,
+// result and queue link) lives in the awaiting coroutine's frame, so a
+// submit allocates nothing. The coroutine resumes on the executor it
+// submitted from (ClientExecutor::current(), or the one given), or inline on
+// the matching thread when there is none.
+class AsyncEngine {
+public:
+    class SubmitAwaiter : public AsyncOperation {
+    public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            continuation = handle;
+            engine.inbound.push(this);
+        }
+        SubmitResult await_resume() const noexcept { return result; }
+
+    private:
+        friend class AsyncEngine;
+
+        SubmitAwaiter(AsyncEngine& _engine, ClientExecutor* _executor, const OrderCommand& _command)
+            : engine(_engine), executor(_executor), command(_command) {}
+
+        AsyncEngine& engine;
+        ClientExecutor* executor;
+        OrderCommand command;
+        SubmitResult result;
+    };
+
+    // cpu < 0 leaves the matching thread unpinned
+    explicit AsyncEngine(WaitStrategy wait = WaitStrategy::Park, int cpu = -1);
+    ~AsyncEngine();
+
+    AsyncEngine(const AsyncEngine&) = delete;
+    AsyncEngine& operator=(const AsyncEngine&) = delete;
+
+    void start();
+    // Completes everything already submitted, then joins the matching thread
+    void stop();
+
+    SubmitAwaiter submit(const OrderCommand& command) {
+        return SubmitAwaiter(*this, ClientExecutor::current(), command);
+    }
+    SubmitAwaiter submit(const OrderCommand& command, ClientExecutor& executor) {
+        return SubmitAwaiter(*this, &executor, command);
+    }
+
+    // Book for a symbol, or nullptr. Only safe once nothing is in flight.
+    Book* findBook(int symbolId) const;
+
+    uint64_t getCommandsProcessed() const { return processed.load(std::memory_order_acquire); }
+    uint64_t getErrorCount() const { return errors.load(std::memory_order_relaxed); }
+
+private:
+    OperationQueue inbound;
+    WaitStrategy wait;
+    int cpu;
+
+    std::vector<std::unique_ptr<Book>> books;  // matching thread only, indexed by symbol id
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> errors{0};
+
+    void run();
+    // Match every operation in the list and hand each back; returns the count
+    size_t complete(AsyncOperation* list);
+    void match(SubmitAwaiter& request);
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include "DepthSnapshot.hpp"
+
+#include <algorithm>
+
+namespace {
+    // Position of price in a best-first side
+    std::vector<DepthLevel>::iterator findLevel(std::vector<DepthLevel>& levels, bool buySide, int price) {
+        return std::lower_bound(levels.begin(), levels.end(), price, [buySide](const DepthLevel& level, int p) {
+            return buySide ? level.price > p : level.price < p;
+        });
+    }
+
+    void copySide(const std::vector<Limit*>& limits, std::vector<DepthLevel>& levels) {
+        levels.clear();
+        for (const Limit* limit : limits) {
+            levels.push_back(DepthLevel{limit->getLimitPrice(), limit->getTotalVolume(), limit->getSize()});
+        }
+    }
+}
+
+DepthSnapshotPublisher::DepthSnapshotPublisher(Book& _book, uint32_t _interval)
+    : book(_book), interval(_interval == 0 ? 1 : _interval) {
+    book.setTrackTouchedLevels(true);
+    rebuild(buffers[0]);
+    rebuild(buffers[1]);
+}
+
+DepthSnapshotPublisher::~DepthSnapshotPublisher() {
+    book.setTrackTouchedLevels(false);
+}
+
+bool DepthSnapshotPublisher::hasUnpublishedChanges() const {
+    return !book.getTouchedLevels().empty() || !pending[current.load(std::memory_order_relaxed)].empty();
+}
+
+bool DepthSnapshotPublisher::publish() {
+    eventsSincePublish = 0;
+    int live = current.load(std::memory_order_relaxed);
+    int spare = 1 - live;
+
+    // Both buffers need every new touch: the spare one now, the live one
+    // when it next becomes the spare
+    const std::vector<TouchedLevel>& touched = book.getTouchedLevels();
+    if (!touched.empty()) {
+        pending[0].insert(pending[0].end(), touched.begin(), touched.end());
+        pending[1].insert(pending[1].end(), touched.begin(), touched.end());
+        book.clearTouchedLevels();
+    }
+    if (pending[live].empty()) return true;  // live snapshot is already current
+
+    // Pairs with the seq_cst steps in read(): a reader either registered on
+    // the spare buffer before this load or will see the swap and move on
+    if (readers[spare].count.load(std::memory_order_seq_cst) != 0) {
+        ++skipped;
+        return false;
+    }
+
+    refresh(spare);
+    buffers[spare].version = buffers[live].version + 1;
+    current.store(spare, std::memory_order_seq_cst);
+    ++publishes;
+    return true;
+}
+
+void DepthSnapshotPublisher::refresh(int index) {
+    DepthSnapshot& snapshot = buffers[index];
+    std::vector<TouchedLevel>& changes = pending[index];
+
+    // Past a point, copying the whole book is cheaper than patching it
+    size_t bookLevels = book.getBuyLimits().size() + book.getSellLimits().size();
+    if (changes.size() > bookLevels) {
+        rebuild(snapshot);
+        changes.clear();
+        return;
+    }
+
+    for (const TouchedLevel& change : changes) {
+        std::vector<DepthLevel>& levels = change.buySide ? snapshot.bids : snapshot.asks;
+        auto it = findLevel(levels, change.buySide, change.price);
+        bool present = it != levels.end() && it->price == change.price;
+        const Limit* limit = book.findLimit(change.buySide, change.price);
+
+        if (limit) {
+            DepthLevel level{change.price, limit->getTotalVolume(), limit->getSize()};
+            if (present) {
+                *it = level;
+            } else {
+                levels.insert(it, level);
+            }
+            ++levelsCopied;
+        } else if (present) {
+            levels.erase(it);
+        }
+    }
+    changes.clear();
+}
+
+void DepthSnapshotPublisher::rebuild(DepthSnapshot& snapshot) {
+    copySide(book.getBuyLimits(), snapshot.bids);
+    copySide(book.getSellLimits(), snapshot.asks);
+    levelsCopied += snapshot.bids.size() + snapshot.asks.size();
+}
+
+DepthSnapshotPublisher::Reader DepthSnapshotPublisher::read() const {
+    for (;;) {
+        int index = current.load(std::memory_order_seq_cst);
+        readers[index].count.fetch_add(1, std::memory_order_seq_cst);
+        // Still current, so the publisher has seen this reader or never will
+        // write this buffer while it is registered
+        if (current.load(std::memory_order_seq_cst) == index) return Reader(this, index);
+        readers[index].count.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+DepthSnapshotPublisher::Reader::~Reader() {
+    if (publisher) publisher->readers[index].count.fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,100 @@
+#ifndef DEPTHSNAPSHOT_HPP
+#define DEPTHSNAPSHOT_HPP
+
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Limit_Order_Book/BookDepth.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Full depth of one book at some point in time
+struct DepthSnapshot {
+    uint64_t version = 0;          // publications so far
+    std::vector<DepthLevel> bids;  // every level, best first
+    std::vector<DepthLevel> asks;
+};
+
+// Publishes the full depth of a Book to any number of reader threads.
+//
+// Two snapshot buffers alternate: readers use the current one while the
+// matching thread brings the spare one up to date and then swaps them. The
+// book records which levels each event touched, and each buffer keeps the
+// list of touches it has not seen yet, so refreshing the spare copies only
+// the levels that changed since it was last current.
+//
+// A buffer is only written once no reader holds it. If a slow reader still
+// holds the spare buffer at publish time, the publisher skips that
+// publication and retries at the next one. The matcher never waits for a
+// reader.
+class DepthSnapshotPublisher {
+public:
+    // Turns on touched level tracking in book. interval is the number of
+    // onEvent() calls between publications.
+    explicit DepthSnapshotPublisher(Book& book, uint32_t interval = 64);
+    ~DepthSnapshotPublisher();
+
+    DepthSnapshotPublisher(const DepthSnapshotPublisher&) = delete;
+    DepthSnapshotPublisher& operator=(const DepthSnapshotPublisher&) = delete;
+
+    // Matching thread: call after each event applied to the book
+    void onEvent() {
+        if (++eventsSincePublish >= interval) publish();
+    }
+    // Matching thread: publish now. False if a reader still held the spare
+    // buffer, in which case the changes stay pending.
+    bool publish();
+    // Matching thread: true if the book changed since the last publication
+    bool hasUnpublishedChanges() const;
+
+    // Keeps one snapshot alive and unchanged while it exists
+    class Reader {
+    public:
+        Reader(Reader&& other) noexcept : publisher(other.publisher), index(other.index) { other.publisher = nullptr; }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        ~Reader();
+
+        const DepthSnapshot& operator*() const { return publisher->buffers[index]; }
+        const DepthSnapshot* operator->() const { return &publisher->buffers[index]; }
+
+    private:
+        friend class DepthSnapshotPublisher;
+        Reader(const DepthSnapshotPublisher* _publisher, int _index) : publisher(_publisher), index(_index) {}
+
+        const DepthSnapshotPublisher* publisher;
+        int index;
+    };
+
+    // Any thread. Readers should not hold a snapshot for longer than needed,
+    // since that delays publication of the next one.
+    Reader read() const;
+
+    uint64_t getPublishCount() const { return publishes; }
+    uint64_t getSkippedCount() const { return skipped; }
+    uint64_t getLevelsCopied() const { return levelsCopied; }
+
+private:
+    struct alignas(64) ReaderCount {
+        std::atomic<int> count{0};
+    };
+
+    Book& book;
+    uint32_t interval;
+    uint32_t eventsSincePublish = 0;
+
+    DepthSnapshot buffers[2];
+    std::vector<TouchedLevel> pending[2];  // touches each buffer has not applied
+    alignas(64) std::atomic<int> current{0};
+    mutable ReaderCount readers[2];
+
+    // Matching thread statistics
+    uint64_t publishes = 0;
+    uint64_t skipped = 0;
+    uint64_t levelsCopied = 0;
+
+    void refresh(int index);
+    void rebuild(DepthSnapshot& snapshot);
+};
+
+#endif
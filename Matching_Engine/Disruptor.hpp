@@ -0,0 +1,129 @@
+#ifndef DISRUPTOR_HPP
+#define DISRUPTOR_HPP
+
+#include "WaitStrategy.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Building blocks for a Disruptor-style pipeline: a pre-allocated ring of
+// events written once by a single producer and read in place by several
+// consumer stages, each of which publishes how far it has got in its own
+// Sequence. Stages wait on the sequences they depend on; the producer waits
+// on the slowest stage before reusing a slot.
+
+// Monotonic counter on its own cache line. -1 means nothing yet.
+class Sequence {
+public:
+    int64_t get() const { return value.load(std::memory_order_acquire); }
+
+    void set(int64_t next) {
+        value.store(next, std::memory_order_release);
+        // Pairs with the fence in waitWhile(): a waiter either sees the new
+        // value before sleeping or is seen here and woken
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) value.notify_all();
+    }
+
+    // Sleep while the value is still `seen`
+    void waitWhile(int64_t seen) const {
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        value.wait(seen, std::memory_order_acquire);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> value{-1};
+    mutable std::atomic<int> waiters{0};
+    char padding[64 - sizeof(std::atomic<int>)];
+};
+
+// Lowest of a set of sequences (what every one of them has reached)
+inline int64_t minimumSequence(const std::vector<const Sequence*>& sequences, int64_t fallback) {
+    int64_t minimum = fallback;
+    for (const Sequence* sequence : sequences) {
+        int64_t value = sequence->get();
+        if (value < minimum) minimum = value;
+    }
+    return minimum;
+}
+
+// Wait until every dependency has reached `wanted`; returns the highest
+// sequence they have all reached (at least `wanted`), so callers can
+// process a whole batch at once.
+inline int64_t waitForSequence(const std::vector<const Sequence*>& dependencies, int64_t wanted,
+                               WaitStrategy wait) {
+    IdleStrategy idle(wait);
+    for (;;) {
+        int64_t available = INT64_MAX;
+        const Sequence* slowest = nullptr;
+        for (const Sequence* dependency : dependencies) {
+            int64_t value = dependency->get();
+            if (value < available) {
+                available = value;
+                slowest = dependency;
+            }
+        }
+        if (available >= wanted) return available;
+        idle.idle([&]() { slowest->waitWhile(available); });
+    }
+}
+
+// Pre-allocated ring of events for one producer
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity)
+        : mask(roundUpToPowerOfTwo(capacity) - 1), slots(new T[mask + 1]) {}
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    T& operator[](int64_t sequence) { return slots[static_cast<size_t>(sequence) & mask]; }
+    const T& operator[](int64_t sequence) const { return slots[static_cast<size_t>(sequence) & mask]; }
+
+    // Stages the producer must not lap
+    void addGatingSequence(const Sequence* sequence) { gating.push_back(sequence); }
+
+    // Producer only. Claims the next `count` slots, waiting until the slowest
+    // gating stage has finished with them. Returns the last claimed sequence.
+    int64_t claim(int64_t count = 1) {
+        int64_t last = nextSequence + count - 1;
+        int64_t wrapPoint = last - static_cast<int64_t>(mask + 1);
+        if (wrapPoint > cachedGating) {
+            IdleStrategy idle(WaitStrategy::Yield);
+            while (wrapPoint > (cachedGating = minimumSequence(gating, nextSequence - 1))) {
+                idle.idle();
+            }
+        }
+        nextSequence = last + 1;
+        return last;
+    }
+
+    // Producer only. Makes every claimed slot up to `sequence` visible.
+    void publish(int64_t sequence) { cursor.set(sequence); }
+
+    const Sequence& getCursor() const { return cursor; }
+    size_t capacity() const { return mask + 1; }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    const size_t mask;
+    std::unique_ptr<T[]> slots;
+    Sequence cursor;
+    std::vector<const Sequence*> gating;
+    int64_t nextSequence = 0;   // producer only
+    int64_t cachedGating = -1;  // producer only
+};
+
+#endif
@@ -0,0 +1,273 @@
+#include "MatchingThread.hpp"
+#include "ThreadUtils.hpp"
+#include "../Persistence/BookSnapshot.hpp"
+#include "../Persistence/ForkSnapshot.hpp"
+#include "../Persistence/Journal.hpp"
+
+#include <chrono>
+#include <exception>
+#include <utility>
+
+MatchingThread::MatchingThread(size_t capacity, WaitStrategy _wait, int _cpu)
+    : ring(capacity), wait(_wait), cpu(_cpu), forkSnapshot(std::make_unique<ForkSnapshot>()) {}
+
+MatchingThread::~MatchingThread() {
+    stop();
+}
+
+void MatchingThread::start() {
+    if (running.exchange(true)) return;
+    initialized.store(false);
+    thread = std::thread(&MatchingThread::run, this);
+    // Pinning and memory setup are done before the first command is timed
+    while (!initialized.load(std::memory_order_acquire)) std::this_thread::yield();
+}
+
+void MatchingThread::stop() {
+    if (!running.load()) return;
+    drain();
+    running.store(false);
+    ring.wake();
+    if (thread.joinable()) thread.join();
+}
+
+void MatchingThread::waitForRoom() {
+    if (wait == WaitStrategy::BusySpin) cpuRelax(); else std::this_thread::yield();
+}
+
+void MatchingThread::submitBatch(const OrderCommand* commands, size_t count) {
+    flush();
+    while (count > 0) {
+        size_t pushed = ring.tryPushBatch(commands, count);
+        if (pushed == 0) waitForRoom();
+        commands += pushed;
+        count -= pushed;
+        submitted += pushed;
+    }
+}
+
+void MatchingThread::flush() {
+    size_t offset = 0;
+    while (offset < stagedCount) {
+        size_t pushed = ring.tryPushBatch(staged + offset, stagedCount - offset);
+        if (pushed == 0) waitForRoom();
+        offset += pushed;
+    }
+    submitted += stagedCount;
+    stagedCount = 0;
+}
+
+void MatchingThread::drain() {
+    if (!running.load()) return;  // nothing will consume
+    flush();
+    while (processed.load(std::memory_order_acquire) != submitted) {
+        waitForRoom();
+    }
+}
+
+Book* MatchingThread::findBook(int symbolId) const {
+    if (symbolId < 0 || static_cast<size_t>(symbolId) >= books.size()) return nullptr;
+    return books[symbolId].get();
+}
+
+bool MatchingThread::hasJournalFailed() const {
+    return journal && journal->hasFailed();
+}
+
+std::vector<const Book*> MatchingThread::listBooks() const {
+    std::vector<const Book*> list;
+    list.reserve(books.size());
+    for (const auto& book : books) list.push_back(book.get());
+    return list;
+}
+
+uint64_t MatchingThread::snapshotSequence() const {
+    return journal ? journal->getAppendedSequence() : getCommandsProcessed();
+}
+
+bool MatchingThread::writeSnapshot(const std::string& directory) const {
+    uint64_t sequence = snapshotSequence();
+    if (journal && !journal->waitDurable(sequence)) return false;
+    return writeSnapshotSet(directory, sequence, listBooks());
+}
+
+bool MatchingThread::requestSnapshot(const std::string& directory) {
+    if (snapshotAt.load(std::memory_order_acquire) != 0) return false;
+    flush();
+    snapshotDirectory = directory;
+    snapshotAt.store(submitted + 1, std::memory_order_release);
+    ring.wake();
+    return true;
+}
+
+void MatchingThread::takeRequestedSnapshot(uint64_t applied) {
+    uint64_t at = snapshotAt.load(std::memory_order_acquire);
+    if (at == 0 || applied + 1 < at) return;
+    // A child still writing the previous snapshot is waited for first
+    reapSnapshot(true);
+    // The set must not get ahead of the journal: if the process died before
+    // the writer caught up, it would hold commands the journal never saw
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sequence = snapshotSequence();
+    if (!journal || journal->waitDurable(sequence)) {
+        forkSnapshot->start(snapshotDirectory, sequence, listBooks());
+    }
+    snapshotPause.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start).count(),
+                        std::memory_order_relaxed);
+    snapshotAt.store(0, std::memory_order_release);
+}
+
+void MatchingThread::reapSnapshot(bool block) {
+    if (block) {
+        forkSnapshot->wait();
+    } else {
+        forkSnapshot->reap();
+    }
+    snapshotsWritten.store(forkSnapshot->getWrittenCount(), std::memory_order_release);
+}
+
+void MatchingThread::restoreBooks(std::vector<std::unique_ptr<Book>> recovered) {
+    if (running.load() || !fullDepth.empty()) return;
+    books = std::move(recovered);
+}
+
+void MatchingThread::setRealtimePriority(int priority) {
+    if (running.load()) return;
+    realtimePriority = priority;
+}
+
+void MatchingThread::setMemoryPlacement(MemoryPlacement _placement, size_t _reserveOrders) {
+    if (running.load()) return;
+    placement = _placement;
+    reserveOrders = _reserveOrders;
+}
+
+Book& MatchingThread::createBook(size_t index) {
+    books[index] = std::make_unique<Book>();
+    if (reserveOrders > 0 && running.load(std::memory_order_relaxed)) {
+        books[index]->reserve(reserveOrders, reservedPriceLevels);
+    }
+    return *books[index];
+}
+
+void MatchingThread::publishDepth(size_t symbolCount, int levels) {
+    if (running.load()) return;
+    depthSlots = std::make_unique<DepthSlot[]>(symbolCount);
+    depthSymbolCount = symbolCount;
+    depthLevels = levels;
+}
+
+bool MatchingThread::readDepth(int symbolId, BookDepth& depth) const {
+    if (symbolId < 0 || static_cast<size_t>(symbolId) >= depthSymbolCount) return false;
+    depth = depthSlots[symbolId].view.load();
+    return true;
+}
+
+uint64_t MatchingThread::getDepthVersion(int symbolId) const {
+    if (symbolId < 0 || static_cast<size_t>(symbolId) >= depthSymbolCount) return 0;
+    return depthSlots[symbolId].view.getVersion() - 1;
+}
+
+void MatchingThread::publishFullDepth(int symbolId, uint32_t interval) {
+    if (running.load() || symbolId < 0) return;
+    size_t index = static_cast<size_t>(symbolId);
+    if (index >= books.size()) books.resize(index + 1);
+    if (!books[index]) createBook(index);
+    if (index >= fullDepth.size()) fullDepth.resize(index + 1);
+    fullDepth[index] = std::make_unique<DepthSnapshotPublisher>(*books[index], interval);
+}
+
+const DepthSnapshotPublisher* MatchingThread::getFullDepth(int symbolId) const {
+    if (symbolId < 0 || static_cast<size_t>(symbolId) >= fullDepth.size()) return nullptr;
+    return fullDepth[symbolId].get();
+}
+
+bool MatchingThread::publishIdleFullDepth() {
+    bool published = true;
+    for (auto& publisher : fullDepth) {
+        if (publisher && publisher->hasUnpublishedChanges() && !publisher->publish()) published = false;
+    }
+    return published;
+}
+
+void MatchingThread::apply(const OrderCommand& command) {
+    if (command.symbolId < 0) return;
+    // Nothing is matched that the journal did not take
+    if (journal && journal->append(command) == 0) {
+        errors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    size_t index = static_cast<size_t>(command.symbolId);
+    if (index >= books.size()) books.resize(index + 1);
+    if (!books[index]) createBook(index);
+    try {
+        applyOrderCommand(*books[index], command);
+    } catch (const std::exception&) {
+        errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (index < depthSymbolCount) {
+        // Most commands leave the top levels alone; only publish real changes
+        // so readers' cached copies stay valid
+        DepthSlot& slot = depthSlots[index];
+        captureDepth(*books[index], depthScratch, depthLevels);
+        if (depthScratch != slot.last) {
+            slot.last = depthScratch;
+            slot.view.store(depthScratch);
+        }
+    }
+    if (index < fullDepth.size() && fullDepth[index]) fullDepth[index]->onEvent();
+}
+
+void MatchingThread::run() {
+    if (cpu >= 0) pinCurrentThread(cpu);
+    if (realtimePriority > 0) realtime.store(::setRealtimePriority(realtimePriority));
+    // After pinning, so "local" means the node of this thread's CPU
+    if (placement != MemoryPlacement::Default) setThreadMemoryPlacement(placement);
+    threadNode.store(currentNumaNode(), std::memory_order_release);
+    // Books created before start() get their reserved memory here instead
+    if (reserveOrders > 0) {
+        for (auto& book : books) {
+            if (book) book->reserve(reserveOrders, reservedPriceLevels);
+        }
+    }
+    initialized.store(true, std::memory_order_release);
+
+    uint64_t count = 0;
+    uint64_t busy = 0;
+    uint64_t idle = 0;
+    bool caughtUp = true;  // full-depth snapshots published since the last batch
+    IdleStrategy idleStrategy(wait);
+    auto applyCommand = [this](const OrderCommand& command) { apply(command); };
+    // A snapshot request wakes the thread like a stop does
+    auto park = [this]() {
+        ring.park([this]() { return running.load() && snapshotAt.load(std::memory_order_acquire) == 0; });
+    };
+
+    while (running.load(std::memory_order_relaxed)) {
+        size_t n = ring.consume(applyCommand, consumeBatch);
+        if (n > 0) {
+            // Single writer, so plain stores publish the counts
+            count += n;
+            processed.store(count, std::memory_order_release);
+            busyPolls.store(++busy, std::memory_order_relaxed);
+            idleStrategy.reset();
+            caughtUp = fullDepth.empty();
+            takeRequestedSnapshot(count);
+            continue;
+        }
+        idlePolls.store(++idle, std::memory_order_relaxed);
+        takeRequestedSnapshot(count);
+        reapSnapshot(false);
+
+        // Catch up full-depth snapshots when idle, retrying any that a
+        // reader held back until they all go out
+        if (!caughtUp) caughtUp = publishIdleFullDepth();
+
+        idleStrategy.idle(park);
+    }
+    // A request that came in with the last commands, then the last child
+    takeRequestedSnapshot(count);
+    reapSnapshot(true);
+}
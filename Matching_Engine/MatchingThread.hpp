@@ -0,0 +1,186 @@
+#ifndef MATCHINGTHREAD_HPP
+#define MATCHINGTHREAD_HPP
+
+#include "DepthSnapshot.hpp"
+#include "SPSCQueue.hpp"
+#include "Seqlock.hpp"
+#include "ThreadUtils.hpp"
+#include "WaitStrategy.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Limit_Order_Book/BookDepth.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ForkSnapshot;
+class Journal;
+
+// A dedicated thread that owns a set of books and applies OrderCommands to
+// them, fed by one producer through an SPSC ring. Books are keyed by
+// command.symbolId and created on first use.
+//
+// submit/submitBatch/flush/drain are for the single producer thread.
+class MatchingThread {
+public:
+    // cpu < 0 leaves the thread unpinned
+    explicit MatchingThread(size_t capacity = 1 << 16, WaitStrategy wait = WaitStrategy::Yield, int cpu = -1);
+    ~MatchingThread();
+
+    MatchingThread(const MatchingThread&) = delete;
+    MatchingThread& operator=(const MatchingThread&) = delete;
+
+    // Returns once the thread is pinned and its memory set up
+    void start();
+    // Applies everything already submitted, then joins the thread
+    void stop();
+
+    // Commands are staged and published to the ring in batches; flush()
+    // publishes whatever is staged. Both wait while the ring is full.
+    void submit(const OrderCommand& command) {
+        staged[stagedCount++] = command;
+        if (stagedCount == publishBatch) flush();
+    }
+    void submitBatch(const OrderCommand* commands, size_t count);
+    void flush();
+    // Wait until every submitted command has been applied (no-op while stopped)
+    void drain();
+
+    // Book for a symbol, or nullptr if it has not traded. Only safe to read
+    // after drain() or stop().
+    Book* findBook(int symbolId) const;
+
+    // Run the thread under SCHED_FIFO at this priority (1-99) so ordinary
+    // threads cannot preempt it. Needs CAP_SYS_NICE; without it the thread
+    // keeps the normal scheduler. Call before start().
+    void setRealtimePriority(int priority);
+    // Whether SCHED_FIFO was granted (valid once started)
+    bool isRealtime() const { return realtime.load(); }
+
+    // NUMA placement of everything the thread allocates (books, order pools,
+    // ladders, indexes), applied on the thread itself after pinning. With
+    // reserveOrders > 0 every book pre-allocates room for that many orders
+    // there. Call before start().
+    void setMemoryPlacement(MemoryPlacement placement, size_t reserveOrders = 0);
+    int getCpu() const { return cpu; }
+    // NUMA node the thread started on (-1 until started or where unknown)
+    int getThreadNode() const { return threadNode.load(std::memory_order_acquire); }
+
+    // Append every command to journal just before applying it, so the
+    // journal holds each command the thread accepted, in the order it was
+    // matched. The journal must be started first and outlive the thread.
+    // Call before start(). Once the journal's writer fails, commands are no
+    // longer matched: each is counted in getErrorCount() instead.
+    void setJournal(Journal* _journal) { journal = _journal; }
+    // Any thread: true once the journal has failed and commands are refused
+    bool hasJournalFailed() const;
+
+    // Write every book as one snapshot set (BookSnapshot.hpp) into
+    // directory, tagged with the journal's sequence (commands processed
+    // without a journal). Only safe after drain() or stop(), like findBook().
+    // Waits for the journal to make that sequence durable first, so a set
+    // is never ahead of the journal; false if the journal has failed.
+    bool writeSnapshot(const std::string& directory) const;
+    // Snapshot every book from a forked child (ForkSnapshot.hpp) while the
+    // thread carries on matching; it only stops for the journal to make the
+    // tag durable (one write, plus a sync unless the mode is None) and for
+    // the fork. For the producer thread: the snapshot is taken at the first
+    // batch boundary after everything submitted so far and tagged like
+    // writeSnapshot(). False if an earlier request has not been taken yet.
+    bool requestSnapshot(const std::string& directory);
+    // Nanoseconds the thread stopped for the last snapshot (durability wait
+    // and fork), and snapshots children have finished writing (all reaped
+    // by stop())
+    uint64_t getSnapshotPause() const { return snapshotPause.load(std::memory_order_relaxed); }
+    uint64_t getSnapshotsWritten() const { return snapshotsWritten.load(std::memory_order_acquire); }
+    // Take over books rebuilt by BookRecovery, indexed by symbol id, in
+    // place of any the thread has. Call before start() and before
+    // publishFullDepth(), whose publishers hold on to their books.
+    void restoreBooks(std::vector<std::unique_ptr<Book>> recovered);
+
+    // Publish the top `levels` of symbols [0, symbolCount) after every
+    // command that changes them. Call before start().
+    void publishDepth(size_t symbolCount, int levels = BookDepth::maxLevels);
+    // Latest published depth of a symbol, from any thread. Lock free and never
+    // delays matching; false if the symbol's depth is not published.
+    bool readDepth(int symbolId, BookDepth& depth) const;
+    // Number of depth changes published for a symbol so far
+    uint64_t getDepthVersion(int symbolId) const;
+
+    // Publish full-depth snapshots of a symbol every `interval` commands on
+    // it, and again when the thread goes idle (retrying any a reader held
+    // back). Call before start().
+    void publishFullDepth(int symbolId, uint32_t interval = 64);
+    // Full-depth publisher of a symbol (read() from any thread), or nullptr
+    const DepthSnapshotPublisher* getFullDepth(int symbolId) const;
+
+    uint64_t getCommandsProcessed() const { return processed.load(std::memory_order_acquire); }
+    uint64_t getErrorCount() const { return errors.load(std::memory_order_relaxed); }
+    // Polls of the ring that found work vs found it empty. Their ratio shows
+    // how much of the core the wait strategy spends idle.
+    uint64_t getBusyPolls() const { return busyPolls.load(std::memory_order_relaxed); }
+    uint64_t getIdlePolls() const { return idlePolls.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t publishBatch = 32;
+    static constexpr size_t consumeBatch = 256;
+    static constexpr size_t reservedPriceLevels = 256;
+
+    SPSCQueue<OrderCommand> ring;
+    WaitStrategy wait;
+    int cpu;
+
+    // Producer side
+    OrderCommand staged[publishBatch];
+    size_t stagedCount = 0;
+    uint64_t submitted = 0;
+
+    // Matching thread side
+    Journal* journal = nullptr;
+    std::vector<std::unique_ptr<Book>> books;  // indexed by symbol id
+    MemoryPlacement placement = MemoryPlacement::Default;
+    size_t reserveOrders = 0;
+    std::atomic<int> threadNode{-1};
+    std::atomic<bool> initialized{false};
+    int realtimePriority = 0;
+    std::atomic<bool> realtime{false};
+    // Published depth: the view readers copy and the matcher's last capture
+    struct DepthSlot {
+        Seqlock<BookDepth> view;
+        BookDepth last;
+    };
+    std::unique_ptr<DepthSlot[]> depthSlots;
+    size_t depthSymbolCount = 0;
+    int depthLevels = BookDepth::maxLevels;
+    BookDepth depthScratch;
+    std::vector<std::unique_ptr<DepthSnapshotPublisher>> fullDepth;  // indexed by symbol id, may be null
+    // Fork snapshots: the producer names the directory and the command count
+    // to reach (plus one, 0 when none is pending); the thread forks and reaps
+    std::string snapshotDirectory;
+    std::atomic<uint64_t> snapshotAt{0};
+    std::unique_ptr<ForkSnapshot> forkSnapshot;
+    std::atomic<uint64_t> snapshotPause{0};
+    std::atomic<uint64_t> snapshotsWritten{0};
+    std::thread thread;
+    std::atomic<bool> running{false};
+    alignas(64) std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> busyPolls{0};
+    std::atomic<uint64_t> idlePolls{0};
+
+    void run();
+    void apply(const OrderCommand& command);
+    Book& createBook(size_t index);
+    bool publishIdleFullDepth();
+    std::vector<const Book*> listBooks() const;
+    uint64_t snapshotSequence() const;
+    void takeRequestedSnapshot(uint64_t applied);
+    void reapSnapshot(bool block);
+    void waitForRoom();
+};
+
+#endif
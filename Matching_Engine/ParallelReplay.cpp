@@ -0,0 +1,84 @@
+#include "ThreadUtils.hpp"
+#include "WorkStealingPool.hpp"
+#include "../Generate_Orders/GenerateOrders.hpp"
+#include "../Limit_Order_Book/BookManager.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+#include "../Process_Orders/OrderPipeline.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Back-testing replay of one multi-symbol log file on a work-stealing pool.
+// Usage: ParallelReplay [symbols] [commands] [maxThreads] [logFile]
+//
+// Writes a generated log to logFile, then replays it with 1, 2, 4... worker
+// threads. Every run is checked against the per-symbol results of the
+// single-threaded run.
+namespace {
+    bool sameResults(const ReplayStats& a, const ReplayStats& b) {
+        if (a.perSymbol.size() != b.perSymbol.size()) return false;
+        for (size_t i = 0; i < a.perSymbol.size(); ++i) {
+            const SymbolReplayStats& x = a.perSymbol[i];
+            const SymbolReplayStats& y = b.perSymbol[i];
+            if (x.commands != y.commands || x.fills != y.fills || x.sharesTraded != y.sharesTraded
+                || x.bestBid != y.bestBid || x.bestAsk != y.bestAsk) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int symbols = argc > 1 ? std::atoi(argv[1]) : 256;
+    size_t count = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 4000000;
+    int maxThreads = argc > 3 ? std::atoi(argv[3]) : availableCpuCount();
+    std::string logFile = argc > 4 ? argv[4] : "replay_log.txt";
+    if (symbols < 1) symbols = 1;
+    if (maxThreads < 1) maxThreads = 1;
+
+    {
+        std::vector<OrderCommand> log = generateCommandLog(symbols, count, 42);
+        std::vector<std::string> names;
+        for (int i = 0; i < symbols; ++i) {
+            names.push_back("SYM" + std::to_string(i));
+        }
+        std::string text;
+        text.reserve(log.size() * 32);
+        for (const OrderCommand& command : log) {
+            formatOrderCommand(command, names[command.symbolId], text);
+        }
+        std::ofstream file(logFile, std::ios::binary | std::ios::trunc);
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!file) {
+            std::cerr << "Cannot write " << logFile << std::endl;
+            return 1;
+        }
+    }
+    std::cout << symbols << " symbols, " << count << " commands, " << availableCpuCount() << " CPUs" << std::endl;
+
+    ReplayStats reference;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        BookManager books(static_cast<size_t>(symbols));
+        WorkStealingPool pool(static_cast<size_t>(threads));
+        OrderPipeline pipeline(&books, &pool);
+        pipeline.processOrdersFromFile(logFile);
+
+        const ReplayStats& stats = pipeline.getReplayStats();
+        if (threads == 1) reference = stats;
+        bool matches = sameResults(stats, reference);
+
+        std::cout << threads << " thread(s): " << static_cast<uint64_t>(stats.commandsPerSecond()) << " commands/sec"
+                  << " (partition " << stats.partitionSeconds << "s, replay " << stats.replaySeconds << "s, "
+                  << pool.getStealCount() << " steals)" << (matches ? "" : "  [MISMATCH]") << std::endl;
+        if (!matches) return 1;
+        if (threads == 1) {
+            std::cout << "  " << stats.fills << " fills, " << stats.sharesTraded << " shares traded, "
+                      << stats.rejectedLines << " rejected lines" << std::endl;
+        }
+    }
+    return 0;
+}
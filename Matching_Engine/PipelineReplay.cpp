@@ -0,0 +1,122 @@
+#include "MatchingThread.hpp"
+#include "SequencedPipeline.hpp"
+#include "../FIX_Protocol/FIXMessage.hpp"
+#include "../Generate_Orders/GenerateOrders.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Replay through the sequenced pipeline with all three stages attached.
+// Usage: PipelineReplay [symbols] [commands] [journalPath]
+//
+// The journal appends every command to a file and flushes once per batch, the
+// market data stage counts best bid/offer changes and the report stage encodes
+// a FIX execution report per fill. A bare MatchingThread over the same log is
+// timed first for comparison.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    bool sameTopOfBook(const Book& a, const Book& b) {
+        return a.getBestBidPrice() == b.getBestBidPrice() && a.getBestAskPrice() == b.getBestAskPrice()
+            && a.getBuyLimits().size() == b.getBuyLimits().size()
+            && a.getSellLimits().size() == b.getSellLimits().size();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int symbols = argc > 1 ? std::atoi(argv[1]) : 64;
+    size_t count = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 2000000;
+    const char* journalPath = argc > 3 ? argv[3] : "pipeline_journal.bin";
+    if (symbols < 1) symbols = 1;
+
+    std::vector<OrderCommand> log = generateCommandLog(symbols, count, 42);
+    std::cout << symbols << " symbols, " << count << " commands" << std::endl;
+
+    // Matching alone on a dedicated thread
+    MatchingThread reference;
+    reference.start();
+    auto start = Clock::now();
+    reference.submitBatch(log.data(), log.size());
+    reference.drain();
+    double baseline = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "matching thread: " << static_cast<uint64_t>(count / baseline) << " commands/sec" << std::endl;
+
+    std::FILE* journalFile = std::fopen(journalPath, "wb");
+    if (!journalFile) {
+        std::cerr << "Cannot open " << journalPath << std::endl;
+        return 1;
+    }
+
+    // Each stage keeps its own state; nothing here is shared between threads
+    uint64_t journalBatches = 0;
+    std::vector<std::pair<int, int>> lastTop(symbols, {0, 0});
+    uint64_t topChanges = 0;
+    FIXMessage report;
+    std::string reportBuffer;
+    uint64_t reportCount = 0;
+    uint64_t reportBytes = 0;
+
+    SequencedPipeline::Stages stages;
+    stages.journal = [&](const PipelineEvent& event, bool endOfBatch) {
+        std::fwrite(&event.command, sizeof(OrderCommand), 1, journalFile);
+        if (endOfBatch) {
+            std::fflush(journalFile);
+            ++journalBatches;
+        }
+    };
+    stages.marketData = [&](const PipelineEvent& event, bool) {
+        std::pair<int, int>& top = lastTop[event.command.symbolId];
+        if (top.first != event.bestBid || top.second != event.bestAsk) {
+            top = {event.bestBid, event.bestAsk};
+            ++topChanges;
+        }
+    };
+    stages.reports = [&](const PipelineEvent& event, bool endOfBatch) {
+        for (const Fill& fill : event.fills) {
+            report.clear();
+            report.setField(FIXMessage::BeginString, "FIX.4.2");
+            report.setMsgType(FIXMessage::ExecutionReport);
+            report.setField(FIXMessage::OrderID, fill.takerId);
+            report.setField(FIXMessage::LastShares, fill.shares);
+            report.setField(FIXMessage::LastPx, static_cast<double>(fill.price));
+            report.encodeTo(reportBuffer);
+            ++reportCount;
+        }
+        if (endOfBatch) {
+            reportBytes += reportBuffer.size();
+            reportBuffer.clear();
+        }
+    };
+
+    SequencedPipeline pipeline(std::move(stages));
+    pipeline.start();
+    start = Clock::now();
+    pipeline.publishBatch(log.data(), log.size());
+    pipeline.drain();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    bool matches = true;
+    for (int i = 0; i < symbols; ++i) {
+        const Book* book = pipeline.findBook(i);
+        const Book* expected = reference.findBook(i);
+        if ((book == nullptr) != (expected == nullptr) || (book && !sameTopOfBook(*book, *expected))) {
+            matches = false;
+        }
+    }
+    pipeline.stop();
+    reference.stop();
+    std::fclose(journalFile);
+
+    std::cout << "pipeline: " << static_cast<uint64_t>(count / seconds) << " commands/sec"
+              << (matches ? "" : "  [MISMATCH]") << std::endl;
+    std::cout << "  journal: " << journalBatches << " flushes, "
+              << count / (journalBatches ? journalBatches : 1) << " commands per flush" << std::endl;
+    std::cout << "  market data: " << topChanges << " top of book changes" << std::endl;
+    std::cout << "  reports: " << reportCount << " fills, " << reportBytes << " bytes" << std::endl;
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free single-producer / single-consumer ring.
+//
+// The producer and consumer indices live on separate cache lines, each next
+// to a cached copy of the other side's index, so in steady state each side
+// only touches the shared index when its cached view runs out. Batch push and
+// consume publish many slots with one release store.
+//
+// The consumer can park (sleep) while the ring is empty; the producer then
+// wakes it on the next publish.
+template <typename T>
+class SPSCQueue {
+private:
+    static constexpr size_t cacheLine = 64;
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    const size_t mask;
+    std::unique_ptr<T[]> slots;
+
+    // Producer side
+    alignas(cacheLine) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+
+    // Consumer side
+    alignas(cacheLine) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+
+    // Parking
+    alignas(cacheLine) std::atomic<bool> consumerParked{false};
+    std::atomic<uint32_t> wakeups{0};
+
+    void publish(size_t newTail) {
+        tail.store(newTail, std::memory_order_release);
+        // Pairs with the fence in park(): either the consumer sees the new
+        // tail before sleeping or we see it parked and wake it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumerParked.load(std::memory_order_relaxed)) wake();
+    }
+
+public:
+    explicit SPSCQueue(size_t capacity)
+        : mask(roundUpToPowerOfTwo(capacity) - 1), slots(new T[mask + 1]) {}
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // Producer only. Returns false when full.
+    bool tryPush(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) return false;
+        }
+        slots[t & mask] = value;
+        publish(t + 1);
+        return true;
+    }
+
+    // Producer only. Copies as many of items as fit and publishes them
+    // together; returns how many were taken.
+    size_t tryPushBatch(const T* items, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t space = mask + 1 - (t - cachedHead);
+        if (space < count) {
+            cachedHead = head.load(std::memory_order_acquire);
+            space = mask + 1 - (t - cachedHead);
+        }
+        size_t n = count < space ? count : space;
+        if (n == 0) return 0;
+        for (size_t i = 0; i < n; ++i) {
+            slots[(t + i) & mask] = items[i];
+        }
+        publish(t + n);
+        return n;
+    }
+
+    // Consumer only
+    bool tryPop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        out = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Calls f(const T&) on up to maxItems available items in
+    // place, then frees all of their slots at once. Returns the count.
+    template <typename F>
+    size_t consume(F&& f, size_t maxItems = SIZE_MAX) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return 0;
+        }
+        size_t available = cachedTail - h;
+        size_t n = available < maxItems ? available : maxItems;
+        for (size_t i = 0; i < n; ++i) {
+            f(slots[(h + i) & mask]);
+        }
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer only. Sleeps until the producer publishes or wake() is called.
+    // Returns straight away if items are waiting or stillWanted() is false;
+    // whoever changes what stillWanted() reads must call wake() afterwards.
+    template <typename Predicate>
+    void park(Predicate stillWanted) {
+        uint32_t seen = wakeups.load(std::memory_order_acquire);
+        consumerParked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (head.load(std::memory_order_relaxed) == tail.load(std::memory_order_relaxed) && stillWanted()) {
+            wakeups.wait(seen, std::memory_order_acquire);
+        }
+        consumerParked.store(false, std::memory_order_relaxed);
+    }
+
+    // Any thread. Wakes a parked consumer (e.g. to let it see a stop flag).
+    void wake() {
+        wakeups.fetch_add(1, std::memory_order_release);
+        wakeups.notify_one();
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return mask + 1; }
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// Single-writer sequence lock around a trivially copyable value.
+//
+// The writer never waits: it bumps the sequence to odd, writes the value and
+// bumps it back to even. Readers copy the value and retry if the sequence was
+// odd or changed underneath them, so they never block the writer and never
+// see a torn value. The value is held as relaxed atomic words, which keeps
+// the racing copy well defined (and quiet under ThreadSanitizer).
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable_v<T>, "Seqlock values are copied word by word");
+
+public:
+    Seqlock() { store(T{}); }
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    // Writer only
+    void store(const T& value) {
+        uint64_t buffer[wordCount] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        uint64_t start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < wordCount; ++i) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    // One attempt; false if a write was in progress
+    bool tryLoad(T& value) const {
+        uint64_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) return false;
+        uint64_t buffer[wordCount];
+        for (size_t i = 0; i < wordCount; ++i) {
+            buffer[i] = words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != before) return false;
+        std::memcpy(&value, buffer, sizeof(T));
+        return true;
+    }
+
+    // Retries until a consistent copy is read
+    T load() const {
+        T value;
+        int attempts = 0;
+        while (!tryLoad(value)) {
+            if (++attempts > 64) std::this_thread::yield();
+        }
+        return value;
+    }
+
+    // Number of completed stores (plus the initial one)
+    uint64_t getVersion() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t wordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(64) std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> words[wordCount];
+};
+
+#endif
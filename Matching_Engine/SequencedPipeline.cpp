@@ -0,0 +1,151 @@
+#include "SequencedPipeline.hpp"
+#include "ThreadUtils.hpp"
+
+#include <exception>
+
+SequencedPipeline::SequencedPipeline(Stages stages, size_t capacity, WaitStrategy _wait, bool _pinThreads)
+    : ring(capacity), wait(_wait), pinThreads(_pinThreads) {
+    // Pre-size every slot's fill buffer so matching does not allocate
+    for (size_t i = 0; i < ring.capacity(); ++i) {
+        ring[static_cast<int64_t>(i)].fills.reserve(8);
+    }
+
+    const Sequence* cursor = &ring.getCursor();
+    matcher.dependencies = {cursor};
+    activeStages.push_back(&matcher);  // the matcher has no handler; runStage calls match()
+
+    journal.handler = std::move(stages.journal);
+    journal.dependencies = {cursor};
+    marketData.handler = std::move(stages.marketData);
+    marketData.dependencies = {&matcher.sequence};
+    reports.handler = std::move(stages.reports);
+    reports.dependencies = {&matcher.sequence};
+    // Never acknowledge a command the journal has not written yet
+    if (journal.handler) reports.dependencies.push_back(&journal.sequence);
+    for (Stage* stage : {&journal, &marketData, &reports}) {
+        if (stage->handler) activeStages.push_back(stage);
+    }
+
+    // The slowest stage decides when a slot can be reused
+    for (Stage* stage : activeStages) {
+        ring.addGatingSequence(&stage->sequence);
+    }
+}
+
+SequencedPipeline::~SequencedPipeline() {
+    stop();
+}
+
+void SequencedPipeline::start() {
+    if (running) return;
+    running = true;
+    for (size_t i = 0; i < activeStages.size(); ++i) {
+        int cpu = pinThreads ? availableCpuId(static_cast<int>(i)) : -1;
+        Stage* stage = activeStages[i];
+        stage->thread = std::thread(&SequencedPipeline::runStage, this, std::ref(*stage), cpu);
+    }
+}
+
+void SequencedPipeline::stop() {
+    if (!running) return;
+    int64_t sequence = ring.claim();
+    PipelineEvent& event = ring[sequence];
+    event.sequence = sequence;
+    event.halt = true;
+    ring.publish(sequence);
+    for (Stage* stage : activeStages) {
+        stage->thread.join();
+    }
+    running = false;
+}
+
+void SequencedPipeline::publish(const OrderCommand& command) {
+    int64_t sequence = ring.claim();
+    PipelineEvent& event = ring[sequence];
+    event.sequence = sequence;
+    event.command = command;
+    event.halt = false;
+    ring.publish(sequence);
+}
+
+void SequencedPipeline::publishBatch(const OrderCommand* commands, size_t count) {
+    // Claim in chunks no larger than the ring, then publish each chunk at once
+    size_t chunk = ring.capacity() / 2;
+    while (count > 0) {
+        size_t n = count < chunk ? count : chunk;
+        int64_t last = ring.claim(static_cast<int64_t>(n));
+        int64_t first = last - static_cast<int64_t>(n) + 1;
+        for (int64_t sequence = first; sequence <= last; ++sequence) {
+            PipelineEvent& event = ring[sequence];
+            event.sequence = sequence;
+            event.command = commands[sequence - first];
+            event.halt = false;
+        }
+        ring.publish(last);
+        commands += n;
+        count -= n;
+    }
+}
+
+void SequencedPipeline::drain() {
+    if (!running) return;
+    int64_t published = ring.getCursor().get();
+    for (Stage* stage : activeStages) {
+        while (stage->sequence.get() < published) {
+            if (wait == WaitStrategy::BusySpin) cpuRelax(); else std::this_thread::yield();
+        }
+    }
+}
+
+Book* SequencedPipeline::findBook(int symbolId) const {
+    if (symbolId < 0 || static_cast<size_t>(symbolId) >= books.size()) return nullptr;
+    return books[symbolId].get();
+}
+
+void SequencedPipeline::match(PipelineEvent& event) {
+    event.fills.clear();
+    const OrderCommand& command = event.command;
+    if (command.symbolId < 0) return;
+
+    size_t index = static_cast<size_t>(command.symbolId);
+    if (index >= books.size()) books.resize(index + 1);
+    if (!books[index]) books[index] = std::make_unique<Book>();
+    Book& book = *books[index];
+
+    try {
+        applyOrderCommand(book, command);
+    } catch (const std::exception&) {
+        errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    const std::vector<Fill>& fills = book.getFills();
+    event.fills.assign(fills.begin(), fills.end());
+    event.bestBid = book.getBestBidPrice();
+    event.bestAsk = book.getBestAskPrice();
+}
+
+void SequencedPipeline::runStage(Stage& stage, int cpu) {
+    if (cpu >= 0) pinCurrentThread(cpu);
+
+    int64_t next = 0;
+    for (;;) {
+        int64_t available = waitForSequence(stage.dependencies, next, wait);
+        for (int64_t sequence = next; sequence <= available; ++sequence) {
+            PipelineEvent& event = ring[sequence];
+            if (event.halt) {
+                stage.sequence.set(sequence);
+                return;
+            }
+            if (&stage == &matcher) {
+                match(event);
+            } else {
+                // The halt is always last, so the event before it ends the
+                // final batch even when both arrive together
+                bool endOfBatch = sequence == available || ring[sequence + 1].halt;
+                stage.handler(event, endOfBatch);
+            }
+        }
+        // One store publishes the whole batch to the stages behind
+        stage.sequence.set(available);
+        next = available + 1;
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef SEQUENCEDPIPELINE_HPP
+#define SEQUENCEDPIPELINE_HPP
+
+#include "Disruptor.hpp"
+#include "WaitStrategy.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// One slot of the pipeline ring. The producer writes the command once; the
+// matcher adds its results in place for the stages behind it.
+struct PipelineEvent {
+    int64_t sequence = -1;
+    OrderCommand command;
+    bool halt = false;  // shuts each stage down after everything before it
+
+    // Written by the matcher
+    std::vector<Fill> fills;  // capacity is kept, so steady state does not allocate
+    int bestBid = 0;
+    int bestAsk = 0;
+};
+
+// Disruptor-style pipeline around the matcher:
+//
+//                 +--> journal -----------------+
+//   producer --> ring                            +--> reports
+//                 +--> matcher --+---------------+
+//                                +--> market data
+//
+// Every stage runs on its own thread and reads events in place. The journal
+// and the matcher only depend on the producer, so persisting commands never
+// delays matching; market data follows the matcher. Reports follow both the
+// matcher and the journal, so a client never hears of a fill the journal
+// could still lose. The producer
+// gates on every stage before reusing a slot. Stages receive endOfBatch so
+// they can flush once per batch (e.g. one write or fsync per group).
+class SequencedPipeline {
+public:
+    using Handler = std::function<void(const PipelineEvent& event, bool endOfBatch)>;
+
+    // Any handler may be empty, in which case that stage is not started
+    struct Stages {
+        Handler journal;
+        Handler marketData;
+        Handler reports;
+    };
+
+    // With pinning on, stages are pinned to consecutive available CPUs.
+    // A pipeline runs once: start(), publish, stop().
+    SequencedPipeline(Stages stages, size_t capacity = 1 << 14,
+                      WaitStrategy wait = WaitStrategy::Yield, bool pinThreads = false);
+    ~SequencedPipeline();
+
+    SequencedPipeline(const SequencedPipeline&) = delete;
+    SequencedPipeline& operator=(const SequencedPipeline&) = delete;
+
+    void start();
+    // Lets every stage finish what was published, then joins them
+    void stop();
+
+    // Producer only
+    void publish(const OrderCommand& command);
+    void publishBatch(const OrderCommand* commands, size_t count);
+    // Wait until every stage has handled everything published
+    void drain();
+
+    // Matcher's book for a symbol, or nullptr. Only safe after drain()/stop().
+    Book* findBook(int symbolId) const;
+
+    int64_t getPublishedSequence() const { return ring.getCursor().get(); }
+    uint64_t getErrorCount() const { return errors.load(std::memory_order_relaxed); }
+
+private:
+    struct Stage {
+        Sequence sequence;
+        std::vector<const Sequence*> dependencies;
+        Handler handler;
+        std::thread thread;
+    };
+
+    RingBuffer<PipelineEvent> ring;
+    WaitStrategy wait;
+    bool pinThreads;
+    bool running = false;
+
+    Stage journal;
+    Stage matcher;
+    Stage marketData;
+    Stage reports;
+    std::vector<Stage*> activeStages;
+
+    std::vector<std::unique_ptr<Book>> books;  // matcher only, indexed by symbol id
+    std::atomic<uint64_t> errors{0};
+
+    void runStage(Stage& stage, int cpu);
+    void match(PipelineEvent& event);
+};
+
+#endif
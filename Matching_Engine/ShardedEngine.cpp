@@ -0,0 +1,70 @@
+#include "ShardedEngine.hpp"
+#include "ThreadUtils.hpp"
+
+#include <map>
+#include <ostream>
+
+ShardedEngine::ShardedEngine(size_t shardCount, size_t queueCapacity, bool pinThreads, WaitStrategy wait) {
+    if (shardCount == 0) shardCount = 1;
+    for (size_t i = 0; i < shardCount; ++i) {
+        int cpu = pinThreads ? availableCpuId(static_cast<int>(i)) : -1;
+        shards.push_back(std::make_unique<MatchingThread>(queueCapacity, wait, cpu));
+    }
+}
+
+ShardedEngine::~ShardedEngine() {
+    stop();
+}
+
+void ShardedEngine::start() {
+    for (auto& shard : shards) shard->start();
+}
+
+void ShardedEngine::stop() {
+    for (auto& shard : shards) shard->stop();
+}
+
+void ShardedEngine::drain() {
+    // Publish everything first so the shards work in parallel while we wait
+    for (auto& shard : shards) shard->flush();
+    for (auto& shard : shards) shard->drain();
+}
+
+Book* ShardedEngine::findBook(int symbolId) const {
+    if (symbolId < 0) return nullptr;
+    return shards[shardFor(symbolId)]->findBook(symbolId);
+}
+
+void ShardedEngine::publishDepth(size_t symbolCount, int levels) {
+    // Slots are indexed by the global symbol id, so each shard leaves the
+    // slots of other shards' symbols unused
+    for (auto& shard : shards) shard->publishDepth(symbolCount, levels);
+}
+
+void ShardedEngine::setMemoryPlacement(MemoryPlacement placement, size_t reserveOrdersPerBook) {
+    for (auto& shard : shards) shard->setMemoryPlacement(placement, reserveOrdersPerBook);
+}
+
+void ShardedEngine::printPlacement(std::ostream& out) const {
+    for (size_t i = 0; i < shards.size(); ++i) {
+        // Books a shard owns are the symbol ids that map to it
+        std::map<int, size_t> booksPerNode;
+        for (size_t id = i; id < symbols.getSymbolCount(); id += shards.size()) {
+            const Book* book = shards[i]->findBook(static_cast<int>(id));
+            if (book && book->getOrderStorage()) ++booksPerNode[numaNodeOf(book->getOrderStorage())];
+        }
+        out << "shard " << i << ": cpu " << shards[i]->getCpu() << ", node " << shards[i]->getThreadNode()
+            << ", order pools on";
+        if (booksPerNode.empty()) out << " (none)";
+        for (const auto& [node, count] : booksPerNode) {
+            out << " node " << node << " x" << count;
+        }
+        out << std::endl;
+    }
+}
+
+uint64_t ShardedEngine::getErrorCount() const {
+    uint64_t errors = 0;
+    for (const auto& shard : shards) errors += shard->getErrorCount();
+    return errors;
+}
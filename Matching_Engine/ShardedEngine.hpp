@@ -0,0 +1,88 @@
+#ifndef SHARDEDENGINE_HPP
+#define SHARDEDENGINE_HPP
+
+#include "MatchingThread.hpp"
+#include "WaitStrategy.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Limit_Order_Book/BookManager.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Matching spread over several threads by symbol.
+//
+// Symbol ids are partitioned across shards (symbolId % shardCount), so every
+// command for a symbol lands on the same shard, in submission order. Each
+// shard is a MatchingThread that owns its books exclusively and is fed through
+// its own SPSC ring; with pinning on, shard i runs on the i-th CPU available
+// to the process.
+//
+// internSymbol/submit/drain are for a single ingress thread.
+class ShardedEngine {
+public:
+    explicit ShardedEngine(size_t shardCount, size_t queueCapacity = 1 << 16, bool pinThreads = true,
+                           WaitStrategy wait = WaitStrategy::Yield);
+    ~ShardedEngine();
+
+    ShardedEngine(const ShardedEngine&) = delete;
+    ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+    void start();
+    // Applies everything already submitted, then joins the shard threads
+    void stop();
+
+    int internSymbol(std::string_view symbol) { return symbols.internSymbol(symbol); }
+    const std::string& getSymbol(int symbolId) const { return symbols.getSymbol(symbolId); }
+    size_t shardFor(int symbolId) const { return static_cast<size_t>(symbolId) % shards.size(); }
+
+    // Queue a command for command.symbolId's shard. Commands are published
+    // to the shard in small batches; drain() publishes the rest.
+    void submit(const OrderCommand& command) {
+        if (command.symbolId >= 0) shards[shardFor(command.symbolId)]->submit(command);
+    }
+    // Wait until every submitted command has been applied
+    void drain();
+
+    // Book for a symbol, or nullptr if it has not traded. Only safe to read
+    // after drain() or stop().
+    Book* findBook(int symbolId) const;
+
+    // Published top-of-book depth (see MatchingThread::publishDepth), for
+    // symbol ids below symbolCount. Call before start().
+    void publishDepth(size_t symbolCount, int levels = BookDepth::maxLevels);
+    // Latest depth of a symbol, readable from any thread while matching runs
+    bool readDepth(int symbolId, BookDepth& depth) const {
+        return symbolId >= 0 && shards[shardFor(symbolId)]->readDepth(symbolId, depth);
+    }
+
+    // Full-depth snapshots of a symbol, published by its shard (see
+    // MatchingThread::publishFullDepth). Call before start().
+    void publishFullDepth(int symbolId, uint32_t interval = 64) {
+        if (symbolId >= 0) shards[shardFor(symbolId)]->publishFullDepth(symbolId, interval);
+    }
+    const DepthSnapshotPublisher* getFullDepth(int symbolId) const {
+        return symbolId >= 0 ? shards[shardFor(symbolId)]->getFullDepth(symbolId) : nullptr;
+    }
+
+    // NUMA placement for every shard's allocations (see
+    // MatchingThread::setMemoryPlacement). Call before start().
+    void setMemoryPlacement(MemoryPlacement placement, size_t reserveOrdersPerBook = 0);
+    // One line per shard: its CPU, the node it runs on and the nodes its
+    // books' order pools landed on. Only after drain() or stop().
+    void printPlacement(std::ostream& out) const;
+
+    size_t getShardCount() const { return shards.size(); }
+    uint64_t getCommandsProcessed(size_t shard) const { return shards[shard]->getCommandsProcessed(); }
+    uint64_t getErrorCount() const;
+
+private:
+    std::vector<std::unique_ptr<MatchingThread>> shards;
+    BookManager symbols;  // symbol table only; books live in the shards
+};
+
+#endif
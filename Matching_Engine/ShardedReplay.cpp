@@ -0,0 +1,154 @@
+#include "ShardedEngine.hpp"
+#include "ThreadUtils.hpp"
+#include "../Generate_Orders/GenerateOrders.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Multi-symbol replay through ShardedEngine at increasing shard counts.
+// Usage: ShardedReplay [symbols] [commands] [maxShards] [placement]
+//
+// placement is default, local or interleaved (NUMA placement of each shard's
+// books, which also prints where they landed), or compare to time local
+// against interleaved placement at maxShards.
+//
+// Commands are generated up front so the run measures routing and matching
+// only. Every run is checked against a single-threaded replay of the same log.
+// A final run publishes every book's depth while a reader thread polls it.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    bool sameTopOfBook(const Book& a, const Book& b) {
+        return a.getBestBidPrice() == b.getBestBidPrice() && a.getBestAskPrice() == b.getBestAskPrice()
+            && a.getBuyLimits().size() == b.getBuyLimits().size()
+            && a.getSellLimits().size() == b.getSellLimits().size();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int symbols = argc > 1 ? std::atoi(argv[1]) : 256;
+    size_t count = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 4000000;
+    int maxShards = argc > 3 ? std::atoi(argv[3]) : availableCpuCount();
+    std::string placementArg = argc > 4 ? argv[4] : "";
+    if (symbols < 1) symbols = 1;
+    if (maxShards < 1) maxShards = 1;
+
+    MemoryPlacement placement = MemoryPlacement::Default;
+    if (placementArg == "local") placement = MemoryPlacement::Local;
+    if (placementArg == "interleaved") placement = MemoryPlacement::Interleaved;
+    bool showPlacement = !placementArg.empty();
+
+    std::vector<OrderCommand> log = generateCommandLog(symbols, count, 42);
+
+    // Reference: the same log applied in order on this thread
+    std::vector<Book> reference(symbols);
+    auto start = Clock::now();
+    for (const OrderCommand& command : log) {
+        applyOrderCommand(reference[command.symbolId], command);
+    }
+    double baseline = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << symbols << " symbols, " << count << " commands, " << availableCpuCount() << " CPUs" << std::endl;
+    std::cout << "single thread: " << static_cast<uint64_t>(count / baseline) << " commands/sec" << std::endl;
+    if (showPlacement) std::cout << numaNodeCount() << " NUMA node(s)" << std::endl;
+
+    for (int shards = 1; shards <= maxShards; shards *= 2) {
+        ShardedEngine engine(static_cast<size_t>(shards));
+        for (int i = 0; i < symbols; ++i) {
+            engine.internSymbol("SYM" + std::to_string(i));
+        }
+        engine.setMemoryPlacement(placement);
+        engine.start();
+
+        start = Clock::now();
+        for (const OrderCommand& command : log) {
+            engine.submit(command);
+        }
+        engine.drain();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        bool matches = true;
+        for (int i = 0; i < symbols; ++i) {
+            const Book* book = engine.findBook(i);
+            if (book && !sameTopOfBook(*book, reference[i])) matches = false;
+        }
+        engine.stop();
+
+        std::cout << shards << " shard(s): " << static_cast<uint64_t>(count / seconds) << " commands/sec, speedup "
+                  << baseline / seconds << (matches ? "" : "  [MISMATCH]") << std::endl;
+        if (showPlacement && shards * 2 > maxShards) engine.printPlacement(std::cout);
+        if (!matches) return 1;
+    }
+
+    // Same run with books reserved up front, once per placement
+    if (placementArg == "compare") {
+        size_t ordersPerBook = count / static_cast<size_t>(symbols) + 1;
+        for (MemoryPlacement compared : {MemoryPlacement::Local, MemoryPlacement::Interleaved}) {
+            ShardedEngine engine(static_cast<size_t>(maxShards));
+            for (int i = 0; i < symbols; ++i) {
+                engine.internSymbol("SYM" + std::to_string(i));
+            }
+            engine.setMemoryPlacement(compared, ordersPerBook);
+            engine.start();
+
+            start = Clock::now();
+            for (const OrderCommand& command : log) {
+                engine.submit(command);
+            }
+            engine.drain();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::cout << memoryPlacementName(compared) << " placement, " << maxShards << " shard(s): "
+                      << static_cast<uint64_t>(count / seconds) << " commands/sec" << std::endl;
+            engine.printPlacement(std::cout);
+            engine.stop();
+        }
+    }
+
+    // Depth publishing cost, with one reader copying views the whole time
+    ShardedEngine engine(static_cast<size_t>(maxShards));
+    for (int i = 0; i < symbols; ++i) {
+        engine.internSymbol("SYM" + std::to_string(i));
+    }
+    engine.publishDepth(static_cast<size_t>(symbols));
+    engine.start();
+
+    std::atomic<bool> reading{true};
+    uint64_t reads = 0;
+    std::thread reader([&]() {
+        BookDepth depth;
+        for (int i = 0; reading.load(std::memory_order_relaxed); i = (i + 1) % symbols) {
+            if (engine.readDepth(i, depth)) ++reads;
+        }
+    });
+
+    start = Clock::now();
+    for (const OrderCommand& command : log) {
+        engine.submit(command);
+    }
+    engine.drain();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    reading.store(false);
+    reader.join();
+
+    bool matches = true;
+    for (int i = 0; i < symbols; ++i) {
+        BookDepth depth;
+        engine.readDepth(i, depth);
+        int bestBid = depth.bidLevels > 0 ? depth.bids[0].price : 0;
+        int bestAsk = depth.askLevels > 0 ? depth.asks[0].price : 0;
+        if (bestBid != reference[i].getBestBidPrice() || bestAsk != reference[i].getBestAskPrice()) matches = false;
+    }
+    engine.stop();
+
+    std::cout << maxShards << " shard(s) publishing depth: " << static_cast<uint64_t>(count / seconds)
+              << " commands/sec, " << static_cast<uint64_t>(reads / seconds) << " reads/sec"
+              << (matches ? "" : "  [MISMATCH]") << std::endl;
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include "ThreadUtils.hpp"
+
+#include <thread>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#endif
+
+bool pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+bool setRealtimePriority(int priority)
+{
+#ifdef __linux__
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+    (void)priority;
+    return false;
+#endif
+}
+
+int availableCpuCount()
+{
+#ifdef __linux__
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        int count = CPU_COUNT(&set);
+        if (count > 0) return count;
+    }
+#endif
+    unsigned count = std::thread::hardware_concurrency();
+    return count > 0 ? static_cast<int>(count) : 1;
+}
+
+int availableCpuId(int index)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) > 0) {
+        int wanted = index % CPU_COUNT(&set);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set) && wanted-- == 0) return cpu;
+        }
+    }
+#endif
+    return index % availableCpuCount();
+}
+
+// NUMA policies go through the raw system calls, so there is no libnuma
+// dependency; on a single-node machine they are accepted and change nothing
+bool setThreadMemoryPlacement(MemoryPlacement placement)
+{
+#ifdef __linux__
+    switch (placement) {
+        case MemoryPlacement::Default:
+            return syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0) == 0;
+        case MemoryPlacement::Local:
+            // Preferred with an empty node mask means "the local node"
+            return syscall(SYS_set_mempolicy, MPOL_PREFERRED, nullptr, 0) == 0;
+        case MemoryPlacement::Interleaved: {
+            unsigned long mask[16] = {};
+            int nodes = numaNodeCount();
+            for (int node = 0; node < nodes && node < static_cast<int>(sizeof(mask) * 8); ++node) {
+                mask[node / 64] |= 1UL << (node % 64);
+            }
+            return syscall(SYS_set_mempolicy, MPOL_INTERLEAVE, mask, sizeof(mask) * 8) == 0;
+        }
+    }
+#else
+    (void)placement;
+#endif
+    return false;
+}
+
+int numaNodeCount()
+{
+#ifdef __linux__
+    // "0-1" or "0" for the nodes that can ever exist
+    std::ifstream possible("/sys/devices/system/node/possible");
+    std::string range;
+    if (possible >> range) {
+        size_t dash = range.find('-');
+        if (dash == std::string::npos) return 1;
+        return std::stoi(range.substr(dash + 1)) + 1;
+    }
+#endif
+    return 1;
+}
+
+int currentNumaNode()
+{
+#ifdef __linux__
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return static_cast<int>(node);
+#endif
+    return -1;
+}
+
+int numaNodeOf(const void* address)
+{
+#ifdef __linux__
+    if (!address) return -1;
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, const_cast<void*>(address), MPOL_F_NODE | MPOL_F_ADDR) == 0) {
+        return node;
+    }
+#else
+    (void)address;
+#endif
+    return -1;
+}
+
+const char* memoryPlacementName(MemoryPlacement placement)
+{
+    switch (placement) {
+        case MemoryPlacement::Default: return "default";
+        case MemoryPlacement::Local: return "local";
+        case MemoryPlacement::Interleaved: return "interleaved";
+    }
+    return "unknown";
+}
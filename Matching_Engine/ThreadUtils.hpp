@@ -0,0 +1,39 @@
+#ifndef THREADUTILS_HPP
+#define THREADUTILS_HPP
+
+// Pin the calling thread to one CPU. Returns false where affinity is not
+// supported or the CPU is not available to this process.
+bool pinCurrentThread(int cpu);
+
+// Switch the calling thread to SCHED_FIFO at priority (1-99). Returns false
+// without the privilege (CAP_SYS_NICE / RLIMIT_RTPRIO) or support.
+bool setRealtimePriority(int priority);
+
+// Number of CPUs this process may run on (at least 1)
+int availableCpuCount();
+
+// Id of the index-th CPU this process may run on, wrapping around, so that
+// threads can be spread over the allowed CPUs in order
+int availableCpuId(int index);
+
+// Where memory first touched by a thread is placed on multi-socket machines
+enum class MemoryPlacement {
+    Default,      // the process policy (normally first touch)
+    Local,        // the NUMA node of the CPU the thread is running on
+    Interleaved   // spread page by page over every node
+};
+
+// Apply placement to pages the calling thread touches from now on. Returns
+// false where NUMA policies are not supported (then nothing changes).
+bool setThreadMemoryPlacement(MemoryPlacement placement);
+
+// Number of NUMA nodes (1 where unknown)
+int numaNodeCount();
+// NUMA node of the CPU the calling thread is on, or -1
+int currentNumaNode();
+// NUMA node holding the page at address (touching it if needed), or -1
+int numaNodeOf(const void* address);
+
+const char* memoryPlacementName(MemoryPlacement placement);
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef WAITSTRATEGY_HPP
+#define WAITSTRATEGY_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// What a thread does while its queue has nothing for it (or no room).
+//   BusySpin - poll continuously with a pause hint; lowest latency, burns the core
+//   Yield    - poll, giving the core to other threads between polls
+//   Backoff  - spin, then yield, then sleep for exponentially longer
+//              (up to 1ms); little CPU when idle, slower to notice work
+//   Park     - sleep until woken by the other side (consumers only;
+//              producers waiting for room fall back to Yield)
+enum class WaitStrategy {
+    BusySpin,
+    Yield,
+    Backoff,
+    Park
+};
+
+// Spin-loop hint: lets the sibling hyperthread run and saves power
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Idle state of one polling loop. Call idle() each time a poll finds nothing
+// and reset() once it finds work.
+class IdleStrategy {
+public:
+    static constexpr uint32_t spinPolls = 64;
+    static constexpr uint32_t yieldPolls = 64;
+    static constexpr int64_t maxSleepNanos = 1000000;
+
+    explicit IdleStrategy(WaitStrategy _strategy) : strategy(_strategy) {}
+
+    void reset() { polls = 0; }
+
+    // Empty polls since the last reset(), and what the next idle() sleeps
+    // for under Backoff (0 while it still spins or yields)
+    uint32_t getPolls() const { return polls; }
+    int64_t nextSleepNanos() const {
+        if (strategy != WaitStrategy::Backoff || polls < spinPolls + yieldPolls) return 0;
+        return sleepNanos(polls);
+    }
+
+    // park() blocks until the other side signals; it is only called for Park
+    template <typename Park>
+    void idle(Park&& park) {
+        uint32_t poll = polls < UINT32_MAX ? polls++ : polls;
+        switch (strategy) {
+            case WaitStrategy::BusySpin:
+                cpuRelax();
+                break;
+            case WaitStrategy::Yield:
+                if (poll < spinPolls) cpuRelax(); else std::this_thread::yield();
+                break;
+            case WaitStrategy::Backoff:
+                if (poll < spinPolls) {
+                    cpuRelax();
+                } else if (poll < spinPolls + yieldPolls) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(sleepNanos(poll)));
+                }
+                break;
+            case WaitStrategy::Park:
+                if (poll < spinPolls) cpuRelax(); else park();
+                break;
+        }
+    }
+
+    void idle() {
+        idle([]() { std::this_thread::yield(); });
+    }
+
+private:
+    WaitStrategy strategy;
+    uint32_t polls = 0;
+
+    // Backoff sleep of a poll past the spinning and yielding ones
+    static int64_t sleepNanos(uint32_t poll) {
+        uint32_t shift = poll - spinPolls - yieldPolls;
+        return shift < 20 ? std::min<int64_t>(int64_t{1000} << shift, maxSleepNanos) : maxSleepNanos;
+    }
+};
+
+#endif
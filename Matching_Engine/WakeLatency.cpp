@@ -0,0 +1,84 @@
+#include "MatchingThread.hpp"
+#include "ThreadUtils.hpp"
+#include "WaitStrategy.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Wake-up latency against CPU cost for each wait strategy.
+// Usage: WakeLatency [samples] [gapMicros] [cpu] [realtimePriority]
+//
+// Submits one command at a time with a quiet gap in between, so the matching
+// thread goes idle before every command, and times how long it takes to see
+// it applied. CPU is the whole process's CPU time per wall second.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const char* strategyName(WaitStrategy wait) {
+        switch (wait) {
+            case WaitStrategy::BusySpin: return "spin";
+            case WaitStrategy::Yield: return "yield";
+            case WaitStrategy::Backoff: return "backoff";
+            case WaitStrategy::Park: return "park";
+        }
+        return "?";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int samples = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int gapMicros = argc > 2 ? std::atoi(argv[2]) : 200;
+    int cpu = argc > 3 ? std::atoi(argv[3]) : -1;
+    int priority = argc > 4 ? std::atoi(argv[4]) : 0;
+    if (samples < 1) samples = 1;
+
+    std::cout << samples << " samples, " << gapMicros << "us apart, " << availableCpuCount() << " CPUs" << std::endl;
+    for (WaitStrategy wait : {WaitStrategy::BusySpin, WaitStrategy::Yield, WaitStrategy::Backoff, WaitStrategy::Park}) {
+        MatchingThread matcher(1024, wait, cpu);
+        if (priority > 0) matcher.setRealtimePriority(priority);
+        matcher.start();
+
+        std::vector<double> latencies;
+        latencies.reserve(samples);
+        std::clock_t cpuStart = std::clock();
+        auto wallStart = Clock::now();
+        for (int i = 0; i < samples; ++i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(gapMicros));
+            OrderCommand command;
+            command.type = OrderCommand::AddLimit;
+            command.orderId = i + 1;
+            command.buyOrSell = i % 2;
+            command.shares = 1;
+            command.limitPrice = i % 2 ? 100 : 110;
+
+            auto start = Clock::now();
+            matcher.submit(command);
+            matcher.flush();
+            IdleStrategy waiting(WaitStrategy::Yield);
+            while (matcher.getCommandsProcessed() < static_cast<uint64_t>(i + 1)) waiting.idle();
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        double wall = std::chrono::duration<double>(Clock::now() - wallStart).count();
+        double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        uint64_t busy = matcher.getBusyPolls();
+        uint64_t idle = matcher.getIdlePolls();
+        bool realtime = matcher.isRealtime();
+        matcher.stop();
+
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << std::left << std::setw(8) << strategyName(wait) << std::right << std::fixed << std::setprecision(1)
+                  << " p50 " << std::setw(8) << latencies[latencies.size() / 2]
+                  << "us  p99 " << std::setw(8) << latencies[latencies.size() * 99 / 100]
+                  << "us  max " << std::setw(9) << latencies.back()
+                  << "us  cpu " << std::setw(5) << 100.0 * cpuSeconds / wall << "%"
+                  << "  busy/idle polls " << busy << "/" << idle
+                  << (realtime ? "  SCHED_FIFO" : "") << std::endl;
+    }
+    return 0;
+}
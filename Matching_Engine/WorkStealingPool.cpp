@@ -0,0 +1,115 @@
+#include "WorkStealingPool.hpp"
+#include "ThreadUtils.hpp"
+
+namespace {
+    // Set on pool threads, so submit() from inside a task stays local
+    thread_local const void* currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(size_t threadCount, bool pinThreads) {
+    if (threadCount == 0) threadCount = static_cast<size_t>(availableCpuCount());
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        int cpu = pinThreads ? availableCpuId(static_cast<int>(i)) : -1;
+        workers[i]->thread = std::thread(&WorkStealingPool::run, this, i, cpu);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    stopping.store(true);
+    // Wake idle workers so they see stopping
+    queued.fetch_add(1);
+    queued.notify_all();
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    size_t index = currentPool == this ? currentWorker
+                                       : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    unfinished.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> guard(workers[index]->lock);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    queued.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    for (;;) {
+        int64_t remaining = unfinished.load(std::memory_order_acquire);
+        if (remaining == 0) return;
+        unfinished.wait(remaining, std::memory_order_acquire);
+    }
+}
+
+uint64_t WorkStealingPool::getStealCount() const {
+    uint64_t total = 0;
+    for (const auto& worker : workers) {
+        total += worker->steals.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+bool WorkStealingPool::popOwn(Worker& worker, Task& task) {
+    std::lock_guard<std::mutex> guard(worker.lock);
+    if (worker.tasks.empty()) return false;
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thief, Task& task) {
+    // Start with the next worker along so thieves spread over victims
+    for (size_t offset = 1; offset < workers.size(); ++offset) {
+        Worker& victim = *workers[(thief + offset) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::run(size_t index, int cpu) {
+    if (cpu >= 0) pinCurrentThread(cpu);
+    currentPool = this;
+    currentWorker = index;
+    Worker& self = *workers[index];
+
+    Task task;
+    for (;;) {
+        bool found = popOwn(self, task);
+        if (!found && steal(index, task)) {
+            found = true;
+            self.steals.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (!found) {
+            if (stopping.load()) return;
+            // Sleep until something is queued; a task counted in queued but
+            // not yet visible in a deque just costs another pass
+            int64_t seen = queued.load();
+            if (seen == 0) {
+                queued.wait(0);
+            } else {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        queued.fetch_sub(1);
+        task();
+        task = nullptr;
+        self.executed.fetch_add(1, std::memory_order_relaxed);
+        if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) unfinished.notify_all();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque.
+//
+// A worker takes work from the back of its own deque and, when that is empty,
+// steals from the front of the others'. Tasks here are coarse (a whole
+// symbol's stream during replay), so each deque is a plain mutex-protected
+// std::deque: the lock is taken once per task, almost never contended, and
+// stealing still evens out uneven task sizes across workers.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threadCount 0 means one worker per available CPU
+    explicit WorkStealingPool(size_t threadCount = 0, bool pinThreads = false);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // From outside the pool, tasks are dealt round robin over the workers;
+    // a task submitted from a worker goes on that worker's own deque.
+    // Tasks must not throw.
+    void submit(Task task);
+    // Block until every submitted task has finished
+    void wait();
+
+    size_t getThreadCount() const { return workers.size(); }
+    uint64_t getTasksExecuted(size_t worker) const { return workers[worker]->executed.load(std::memory_order_relaxed); }
+    uint64_t getStealCount() const;
+
+private:
+    struct alignas(64) Worker {
+        std::mutex lock;
+        std::deque<Task> tasks;
+        std::thread thread;
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> steals{0};
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int64_t> queued{0};      // tasks sitting in any deque
+    std::atomic<int64_t> unfinished{0};  // submitted and not yet finished
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> nextWorker{0};
+
+    void run(size_t index, int cpu);
+    bool popOwn(Worker& worker, Task& task);
+    bool steal(size_t thief, Task& task);
+};
+
+#endif
@@ -0,0 +1,356 @@
+#include "BookSnapshot.hpp"
+#include "Checksum.hpp"
+#include "../Limit_Order_Book/Varint.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char magic[4] = {'L', 'O', 'B', 'S'};
+    constexpr char setMagic[4] = {'L', 'O', 'B', 'M'};
+    constexpr uint8_t formatVersion = 1;
+    constexpr size_t checksumBytes = 4;
+    // Id delta, shares and (stops only) limit price
+    constexpr size_t maxOrderBytes = maxVarint64 + maxVarint32 * 2;
+    // Queues walked at once while encoding
+    constexpr size_t encodeLanes = 16;
+
+    bool fitsInt(int64_t value) {
+        return value >= INT32_MIN && value <= INT32_MAX;
+    }
+
+    // Ladders in file order: buy, sell, stop buy, stop sell
+    const std::vector<Limit*>& ladderOf(const Book& book, int ladder) {
+        switch (ladder) {
+            case 0: return book.getBuyLimits();
+            case 1: return book.getSellLimits();
+            case 2: return book.getStopBuyLimits();
+            default: return book.getStopSellLimits();
+        }
+    }
+
+    bool writeAll(int fd, const char* data, size_t length) {
+        while (length > 0) {
+            ssize_t n = write(fd, data, length);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Write data to path through a temporary file that is synced and then
+    // renamed over path, and sync the rename
+    bool writeFileAtomically(const std::string& path, const std::string& data) {
+        std::string temporary = path + ".tmp";
+        int fd = open(temporary.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        bool written = writeAll(fd, data.data(), data.size()) && fsync(fd) == 0;
+        written = close(fd) == 0 && written;
+        if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        int dirFd = open(parent.empty() ? "." : parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+        return true;
+    }
+
+    bool readFile(const std::string& path, std::string& data) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+        std::error_code error;
+        uintmax_t size = std::filesystem::file_size(path, error);
+        if (!error) data.resize(static_cast<size_t>(size));
+        bool read = !error && std::fread(data.data(), 1, data.size(), file) == data.size();
+        std::fclose(file);
+        return read;
+    }
+
+    void putChecksum(std::string& out, size_t start) {
+        uint32_t crc = crc32c(out.data() + start, out.size() - start);
+        for (size_t i = 0; i < checksumBytes; ++i) out.push_back(static_cast<char>(crc >> (8 * i)));
+    }
+
+    // Whether data ends in the CRC-32C of the bytes before it
+    bool checksumMatches(std::string_view data) {
+        if (data.size() < checksumBytes) return false;
+        size_t body = data.size() - checksumBytes;
+        uint32_t stored = 0;
+        for (size_t i = 0; i < checksumBytes; ++i) {
+            stored |= static_cast<uint32_t>(static_cast<uint8_t>(data[body + i])) << (8 * i);
+        }
+        return crc32c(data.data(), body) == stored;
+    }
+}
+
+size_t encodeBookSnapshot(const Book& book, uint64_t sequence, std::string& out) {
+    uint64_t orders = 0;
+    size_t levels = 0;
+    for (int ladder = 0; ladder < 4; ++ladder) {
+        for (const Limit* level : ladderOf(book, ladder)) orders += static_cast<uint64_t>(level->getSize());
+        levels += ladderOf(book, ladder).size();
+    }
+
+    // Worst case for every field, trimmed once written
+    size_t start = out.size();
+    size_t bound = sizeof(magic) + 1 + maxVarint64 * 2 + maxVarint32 * 5 + levels * (maxVarint64 + maxVarint32)
+        + orders * maxOrderBytes + checksumBytes;
+    out.resize(start + bound);
+    char* begin = out.data() + start;
+    char* cursor = begin;
+
+    std::memcpy(cursor, magic, sizeof(magic));
+    cursor += sizeof(magic);
+    *cursor++ = static_cast<char>(formatVersion);
+    cursor = putVarint(cursor, sequence);
+    cursor = putVarint(cursor, static_cast<uint32_t>(book.getMaxOrderId()));
+    cursor = putVarint(cursor, orders);
+    for (int ladder = 0; ladder < 4; ++ladder) cursor = putVarint(cursor, ladderOf(book, ladder).size());
+
+    // Queues are linked lists spread over the order pool, so on a cold book
+    // every step along one is a cache miss. Walking several levels' queues
+    // in turn lets those misses overlap; each queue is encoded into its own
+    // lane and the lanes are copied out in level order.
+    std::vector<std::string> laneBuffers(encodeLanes);
+    for (int ladder = 0; ladder < 4; ++ladder) {
+        bool stop = ladder >= 2;
+        bool descending = ladder % 2 == 0;  // buy ladders
+        const std::vector<Limit*>& limits = ladderOf(book, ladder);
+        for (size_t first = 0; first < limits.size(); first += encodeLanes) {
+            size_t laneCount = std::min(encodeLanes, limits.size() - first);
+            const Order* next[encodeLanes];
+            char* laneCursor[encodeLanes];
+            int64_t previousId[encodeLanes];
+            for (size_t lane = 0; lane < laneCount; ++lane) {
+                const Limit& level = *limits[first + lane];
+                laneBuffers[lane].resize(static_cast<size_t>(level.getSize()) * maxOrderBytes);
+                next[lane] = level.getHeadOrder();
+                laneCursor[lane] = laneBuffers[lane].data();
+                previousId[lane] = 0;
+            }
+            for (size_t active = laneCount; active > 0;) {
+                active = 0;
+                for (size_t lane = 0; lane < laneCount; ++lane) {
+                    const Order* order = next[lane];
+                    if (!order) continue;
+                    ++active;
+                    next[lane] = order->nextOrder;
+                    char* laneOut = laneCursor[lane];
+                    laneOut = putVarint(laneOut, zigzag(order->getOrderId() - previousId[lane]));
+                    previousId[lane] = order->getOrderId();
+                    laneOut = putVarint(laneOut, static_cast<uint32_t>(order->getShares()));
+                    if (stop) laneOut = putVarint(laneOut, zigzag(order->getLimit()));
+                    laneCursor[lane] = laneOut;
+                }
+            }
+
+            for (size_t lane = 0; lane < laneCount; ++lane) {
+                size_t i = first + lane;
+                const Limit& level = *limits[i];
+                int64_t price = level.getLimitPrice();
+                if (i == 0) {
+                    cursor = putVarint(cursor, zigzag(price));
+                } else {
+                    int64_t previous = limits[i - 1]->getLimitPrice();
+                    cursor = putVarint(cursor, static_cast<uint64_t>(descending ? previous - price : price - previous));
+                }
+                cursor = putVarint(cursor, static_cast<uint32_t>(level.getSize()));
+                size_t laneBytes = static_cast<size_t>(laneCursor[lane] - laneBuffers[lane].data());
+                std::memcpy(cursor, laneBuffers[lane].data(), laneBytes);
+                cursor += laneBytes;
+            }
+        }
+    }
+
+    out.resize(static_cast<size_t>(cursor - out.data()));
+    putChecksum(out, start);
+    return out.size() - start;
+}
+
+bool decodeBookSnapshot(std::string_view data, Book& book, uint64_t& sequence) {
+    if (data.size() < sizeof(magic) + 1 + checksumBytes || std::memcmp(data.data(), magic, sizeof(magic)) != 0
+        || static_cast<uint8_t>(data[sizeof(magic)]) != formatVersion) {
+        return false;
+    }
+    if (!checksumMatches(data)) return false;
+    size_t body = data.size() - checksumBytes;
+    for (int ladder = 0; ladder < 4; ++ladder) {
+        if (!ladderOf(book, ladder).empty()) return false;
+    }
+
+    VarintReader reader(data.data() + sizeof(magic) + 1, data.data() + body);
+    uint64_t maxOrderId;
+    uint64_t orders;
+    uint64_t levelCounts[4];
+    if (!reader.read(sequence) || !reader.read(maxOrderId, 32) || maxOrderId > INT32_MAX || !reader.read(orders)) {
+        return false;
+    }
+    uint64_t levels = 0;
+    for (uint64_t& count : levelCounts) {
+        if (!reader.read(count, 32)) return false;
+        levels += count;
+    }
+    // Every order and level takes at least two bytes, so counts beyond that
+    // are corrupt and must not size the pools
+    if (orders > body || levels > body) return false;
+
+    // The source book took ids this high, so the restored one must too
+    if (maxOrderId > static_cast<uint64_t>(book.getOrderIdLimit())) book.setOrderIdLimit(static_cast<int>(maxOrderId));
+    // Pools, ladders and index sized once, instead of growing level by level
+    book.reserve(orders, (levels + 1) / 2, maxOrderId);
+    std::vector<RestingOrder> queue;
+    uint64_t restored = 0;
+    for (int ladder = 0; ladder < 4; ++ladder) {
+        bool stop = ladder >= 2;
+        bool descending = ladder % 2 == 0;
+        int64_t price = 0;
+        for (uint64_t i = 0; i < levelCounts[ladder]; ++i) {
+            int64_t orderId = 0;
+            if (i == 0) {
+                if (!reader.readInt(price)) return false;
+            } else {
+                uint64_t distance;
+                if (!reader.read(distance, 32) || distance == 0) return false;
+                price += descending ? -static_cast<int64_t>(distance) : static_cast<int64_t>(distance);
+            }
+            uint64_t count;
+            if (!fitsInt(price) || !reader.read(count, 32) || count == 0 || count > orders - restored) return false;
+
+            queue.resize(count);
+            for (RestingOrder& order : queue) {
+                int64_t delta;
+                uint64_t shares;
+                int64_t limitPrice = 0;
+                if (!reader.readInt(delta) || !reader.read(shares, 31)) return false;
+                if (stop && !reader.readInt(limitPrice)) return false;
+                orderId += delta;
+                if (orderId < 0 || static_cast<uint64_t>(orderId) > maxOrderId || !fitsInt(limitPrice)) return false;
+                order = RestingOrder{static_cast<int>(orderId), static_cast<int>(shares), static_cast<int>(limitPrice)};
+            }
+            // Buy ladders run best (highest) first
+            if (!book.appendLevel(stop, descending, static_cast<int>(price), queue.data(), queue.size())) return false;
+            restored += count;
+        }
+    }
+    return restored == orders && reader.atEnd();
+}
+
+bool writeBookSnapshot(const Book& book, uint64_t sequence, const std::string& path) {
+    std::string image;
+    encodeBookSnapshot(book, sequence, image);
+    return writeFileAtomically(path, image);
+}
+
+bool readBookSnapshot(const std::string& path, Book& book, uint64_t& sequence) {
+    std::string image;
+    return readFile(path, image) && decodeBookSnapshot(image, book, sequence);
+}
+
+uint64_t bookStateHash(const Book& book) {
+    std::string image;
+    encodeBookSnapshot(book, 0, image);
+    // Eight bytes per step: multiply, then fold the high bits back down
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ image.size();
+    size_t i = 0;
+    for (; i + 8 <= image.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, image.data() + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    for (; i < image.size(); ++i) hash = (hash ^ static_cast<uint8_t>(image[i])) * 0x100000001B3ull;
+    return hash ^ (hash >> 29);
+}
+
+std::string snapshotSetName(uint64_t sequence) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "snapshot-%020llu.lob", static_cast<unsigned long long>(sequence));
+    return name;
+}
+
+bool writeSnapshotSet(const std::string& directory, uint64_t sequence, const std::vector<const Book*>& books) {
+    std::string data(setMagic, sizeof(setMagic));
+    data.push_back(static_cast<char>(formatVersion));
+    char header[maxVarint64 * 2];
+    size_t count = 0;
+    for (const Book* book : books) count += book != nullptr;
+    data.append(header, static_cast<size_t>(putVarint(putVarint(header, sequence), count) - header));
+
+    std::string image;
+    for (size_t symbol = 0; symbol < books.size(); ++symbol) {
+        if (!books[symbol]) continue;
+        image.clear();
+        encodeBookSnapshot(*books[symbol], sequence, image);
+        char frame[maxVarint64 * 2];
+        data.append(frame, static_cast<size_t>(putVarint(putVarint(frame, symbol), image.size()) - frame));
+        data += image;
+    }
+    putChecksum(data, 0);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    return writeFileAtomically(directory + "/" + snapshotSetName(sequence), data);
+}
+
+std::vector<uint64_t> listSnapshotSets(const std::string& directory) {
+    std::vector<uint64_t> sequences;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string name = entry.path().filename().string();
+        unsigned long long sequence = 0;
+        if (std::sscanf(name.c_str(), "snapshot-%llu.lob", &sequence) == 1 && name == snapshotSetName(sequence)) {
+            sequences.push_back(sequence);
+        }
+    }
+    std::sort(sequences.begin(), sequences.end());
+    return sequences;
+}
+
+bool readSnapshotSet(const std::string& path, std::vector<std::unique_ptr<Book>>& books, uint64_t& sequence) {
+    std::string data;
+    if (!readFile(path, data) || data.size() < sizeof(setMagic) + 1 + checksumBytes
+        || std::memcmp(data.data(), setMagic, sizeof(setMagic)) != 0
+        || static_cast<uint8_t>(data[sizeof(setMagic)]) != formatVersion || !checksumMatches(data)) {
+        return false;
+    }
+
+    const char* end = data.data() + data.size() - checksumBytes;
+    VarintReader reader(data.data() + sizeof(setMagic) + 1, end);
+    uint64_t count;
+    if (!reader.read(sequence) || !reader.read(count, 32)) return false;
+    std::vector<std::unique_ptr<Book>> restored;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t symbol;
+        uint64_t length;
+        if (!reader.read(symbol, 31) || !reader.read(length) || length > reader.remaining()) return false;
+        if (symbol >= restored.size()) restored.resize(symbol + 1);
+        if (restored[symbol]) return false;
+        restored[symbol] = std::make_unique<Book>();
+        uint64_t imageSequence;
+        if (!decodeBookSnapshot(std::string_view(reader.position(), length), *restored[symbol], imageSequence)
+            || imageSequence != sequence) {
+            return false;
+        }
+        reader.skip(length);
+    }
+    if (!reader.atEnd()) return false;
+    books = std::move(restored);
+    return true;
+}
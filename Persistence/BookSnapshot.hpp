@@ -0,0 +1,74 @@
+#ifndef BOOKSNAPSHOT_HPP
+#define BOOKSNAPSHOT_HPP
+
+#include "../Limit_Order_Book/Book.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Point-in-time image of everything a book holds, for restarting without
+// replaying its whole history: the buy, sell, stop buy and stop sell
+// ladders, every order of every level in queue order, and so the order
+// index. Restoring rebuilds the book in bulk with no matching.
+//
+//   "LOBS" | version | sequence | max order id | order count
+//          | level count x4 | ladders | CRC-32C
+//   ladder: levels, best first
+//   level:  price | order count | orders
+//   order:  id | shares [| limit price, stop ladders only]
+//
+// The version is one byte and the CRC four little-endian bytes over
+// everything before them; all other fields are LEB128 varints. Within a
+// ladder each price after the first is its distance from the previous
+// level, and each order id is a zigzag delta from the order before it in
+// its level, so a deep book costs four to five bytes per order. sequence
+// is whatever the caller pairs the image with, such as the journal
+// sequence of the last command applied to the book. Ids come from clients,
+// so the book has no id counter of its own; the highest id is kept so the
+// restore can size the index up front.
+
+// Append an image of book to out (on the thread that owns the book);
+// returns the bytes appended
+size_t encodeBookSnapshot(const Book& book, uint64_t sequence, std::string& out);
+
+// Restore an image into book, which must be empty, and its sequence into
+// sequence. The checksum is verified before the book is touched. False if
+// the image is corrupt or the book is not empty; after a failure part way
+// through (only possible for images from a different build), book holds a
+// partial image and should be discarded.
+bool decodeBookSnapshot(std::string_view data, Book& book, uint64_t& sequence);
+
+// Write the image to path through a temporary file that is synced and then
+// renamed over path, so path always holds a whole snapshot. False on any
+// I/O error.
+bool writeBookSnapshot(const Book& book, uint64_t sequence, const std::string& path);
+// Read and restore the snapshot at path, as decodeBookSnapshot
+bool readBookSnapshot(const std::string& path, Book& book, uint64_t& sequence);
+
+// 64-bit hash of everything an image of book holds (ladders, queues,
+// orders), so two books can be checked for identical state from one number
+// each. On the thread that owns the book; costs about one encode.
+uint64_t bookStateHash(const Book& book);
+
+// Snapshot sets: every book of a matching thread (indexed by symbol id)
+// taken at one sequence, in one file of a snapshot directory. The file is
+// "LOBM" | version | sequence | book count | (symbol id | image length |
+// book image) per book | CRC-32C, written like writeBookSnapshot.
+
+// File name of the set taken at sequence, e.g.
+// snapshot-00000000000000001000.lob; names sort in sequence order
+std::string snapshotSetName(uint64_t sequence);
+// Null entries (symbols without a book) are skipped. Creates directory if
+// needed; false on any I/O error.
+bool writeSnapshotSet(const std::string& directory, uint64_t sequence, const std::vector<const Book*>& books);
+// Sequences of the sets in directory, oldest first
+std::vector<uint64_t> listSnapshotSets(const std::string& directory);
+// Restore the set at path into books, indexed by symbol id (null where the
+// set has no book). books is only replaced if the whole set is valid.
+bool readSnapshotSet(const std::string& path, std::vector<std::unique_ptr<Book>>& books, uint64_t& sequence);
+
+#endif
@@ -0,0 +1,44 @@
+#include "Checksum.hpp"
+
+#include <array>
+
+namespace {
+    using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+    // tables[k][b]: CRC of byte b followed by k zero bytes
+    constexpr CrcTables makeCrcTables() {
+        CrcTables tables{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+            tables[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (size_t k = 1; k < 8; ++k) tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+        }
+        return tables;
+    }
+    constexpr CrcTables crcTables = makeCrcTables();
+
+    // Little-endian load whatever the host order (a single load on x86)
+    uint32_t load32(const unsigned char* bytes) {
+        return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8
+            | static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+    }
+}
+
+uint32_t crc32c(const void* data, size_t length, uint32_t crc) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    while (length >= 8) {
+        uint32_t low = load32(bytes) ^ crc;
+        uint32_t high = load32(bytes + 4);
+        crc = crcTables[7][low & 0xFF] ^ crcTables[6][(low >> 8) & 0xFF] ^ crcTables[5][(low >> 16) & 0xFF]
+            ^ crcTables[4][low >> 24] ^ crcTables[3][high & 0xFF] ^ crcTables[2][(high >> 8) & 0xFF]
+            ^ crcTables[1][(high >> 16) & 0xFF] ^ crcTables[0][high >> 24];
+        bytes += 8;
+        length -= 8;
+    }
+    while (length-- > 0) crc = crcTables[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
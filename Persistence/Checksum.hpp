@@ -0,0 +1,12 @@
+#ifndef CHECKSUM_HPP
+#define CHECKSUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32C (Castagnoli) of length bytes, continuing from crc (the result of
+// an earlier call) so large images can be checksummed in pieces.
+// Table driven, eight bytes per step.
+uint32_t crc32c(const void* data, size_t length, uint32_t crc = 0);
+
+#endif
@@ -0,0 +1,78 @@
+#include "ForkSnapshot.hpp"
+#include "BookSnapshot.hpp"
+
+#include <cerrno>
+#include <chrono>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    int64_t nowNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+ForkSnapshot::~ForkSnapshot() {
+    wait();
+}
+
+bool ForkSnapshot::start(const std::string& directory, uint64_t sequence, const std::vector<const Book*>& books) {
+    if (isRunning()) return false;
+
+    int64_t before = nowNanoseconds();
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Child: only this thread exists here. Write and leave without
+        // running the parent's exit handlers or destructors.
+        int niceness = nice(10);
+        (void)niceness;
+        _exit(writeSnapshotSet(directory, sequence, books) ? 0 : 1);
+    }
+    int64_t after = nowNanoseconds();
+    if (pid < 0) {
+        ++failed;
+        return false;
+    }
+    child = pid;
+    childSequence = sequence;
+    forkedAt = before;
+    forkNanoseconds = static_cast<uint64_t>(after - before);
+    return true;
+}
+
+void ForkSnapshot::reap() {
+    if (child < 0) return;
+    int status = 0;
+    pid_t pid = waitpid(child, &status, WNOHANG);
+    if (pid != 0) finish(pid == child ? status : -1);
+}
+
+bool ForkSnapshot::isRunning() {
+    reap();
+    return child >= 0;
+}
+
+bool ForkSnapshot::wait() {
+    if (child < 0) return true;
+    int status = 0;
+    pid_t pid;
+    do {
+        pid = waitpid(child, &status, 0);
+    } while (pid < 0 && errno == EINTR);
+    uint64_t before = written;
+    finish(pid == child ? status : -1);
+    return written > before;
+}
+
+void ForkSnapshot::finish(int status) {
+    writeNanoseconds = static_cast<uint64_t>(nowNanoseconds() - forkedAt);
+    if (status >= 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        ++written;
+        lastSequence = childSequence;
+    } else {
+        ++failed;
+    }
+    child = -1;
+}
@@ -0,0 +1,68 @@
+#ifndef FORKSNAPSHOT_HPP
+#define FORKSNAPSHOT_HPP
+
+#include "../Limit_Order_Book/Book.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+// Snapshot sets written by a forked child, so the thread that owns the
+// books only stops for the fork itself.
+//
+// fork() gives the child a copy-on-write image of the whole process, so it
+// sees the books exactly as they were at the call while the parent goes
+// on matching. The parent's pause is the kernel copying page tables,
+// which grows with resident memory (much less with huge pages, which the
+// book's large pools ask for). Afterwards the parent pays a page fault
+// and a copy the first time it writes to each page the child still
+// shares, spread over the snapshot's lifetime.
+//
+// One snapshot at a time. All calls on the thread that owns the books.
+class ForkSnapshot {
+public:
+    ForkSnapshot() = default;
+    // Waits for a running child
+    ~ForkSnapshot();
+
+    ForkSnapshot(const ForkSnapshot&) = delete;
+    ForkSnapshot& operator=(const ForkSnapshot&) = delete;
+
+    // Fork a child that writes books (indexed by symbol id, null entries
+    // skipped) as a snapshot set tagged with sequence into directory, then
+    // exits. The child runs at lower priority so it does not compete with
+    // matching. False if a snapshot is still being written or fork fails.
+    bool start(const std::string& directory, uint64_t sequence, const std::vector<const Book*>& books);
+    // Reap the child if it has finished, without blocking
+    void reap();
+    // reap(), then true while the child is still writing
+    bool isRunning();
+    // Block until the child exits. True if there was none or it wrote its
+    // snapshot.
+    bool wait();
+
+    // Time the last start() spent in fork()
+    uint64_t getForkNanoseconds() const { return forkNanoseconds; }
+    // From fork to the child being reaped, for the last snapshot finished
+    uint64_t getWriteNanoseconds() const { return writeNanoseconds; }
+    uint64_t getWrittenCount() const { return written; }
+    uint64_t getFailedCount() const { return failed; }
+    // Sequence of the last snapshot written (0 if none)
+    uint64_t getLastSequence() const { return lastSequence; }
+
+private:
+    pid_t child = -1;
+    uint64_t childSequence = 0;
+    int64_t forkedAt = 0;
+    uint64_t forkNanoseconds = 0;
+    uint64_t writeNanoseconds = 0;
+    uint64_t written = 0;
+    uint64_t failed = 0;
+    uint64_t lastSequence = 0;
+
+    void finish(int status);
+};
+
+#endif
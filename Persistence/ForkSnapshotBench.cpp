@@ -0,0 +1,129 @@
+#include "BookSnapshot.hpp"
+#include "ForkSnapshot.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// Matching stall of an inline snapshot against a forked one.
+// Usage: ForkSnapshotBench [orders] [directory]
+//
+// Builds a book of `orders` resting orders over 2000 price levels per side
+// and times writeSnapshotSet on the owning thread, which holds matching for
+// the whole encode and write. Then forks the same snapshot with
+// ForkSnapshot and, while the child writes, keeps cancelling random resting
+// orders and adding new ones on the parent, timing each pair. Those
+// latencies (which include the parent's copy-on-write faults, and on a
+// single CPU the child's time slices) are compared with the same work run
+// without a child. The forked snapshot is read back and checked.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double millisecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    const int mid = 100000;
+
+    void buildBook(Book& book, size_t orders, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> side(0, 1);
+        std::uniform_int_distribution<> depth(1, 2000);
+        std::uniform_int_distribution<> shares(1, 500);
+        for (size_t i = 1; i <= orders; ++i) {
+            bool buy = side(gen) == 1;
+            int offset = depth(gen);
+            book.insertRestingOrder(static_cast<int>(i), buy, shares(gen), buy ? mid - offset : mid + offset);
+        }
+    }
+
+    // Cancel a random resting order and add a new one on the same side, so
+    // writes land all over the book's memory. Runs for `seconds` or until
+    // `until` returns false; returns each pair's time in us.
+    template <typename Until>
+    std::vector<double> churn(Book& book, std::vector<int>& live, int& nextId, std::mt19937& gen,
+                              double seconds, Until until) {
+        std::uniform_int_distribution<> depth(1, 2000);
+        std::vector<double> latencies;
+        auto start = Clock::now();
+        while (until() && millisecondsSince(start) < seconds * 1e3) {
+            size_t slot = std::uniform_int_distribution<size_t>(0, live.size() - 1)(gen);
+            int offset = depth(gen);
+            auto before = Clock::now();
+            int orderId = live[slot];
+            bool buy = book.searchOrderMap(orderId)->getBuyOrSell();
+            book.cancelLimitOrder(orderId);
+            book.addLimitOrder(nextId, buy, 100, buy ? mid - offset : mid + offset);
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+            live[slot] = nextId++;
+        }
+        return latencies;
+    }
+
+    void printLatencies(const char* label, std::vector<double> latencies) {
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << label << std::setw(8) << latencies.size() << " ops  p50 " << std::setw(6)
+                  << latencies[latencies.size() / 2] << "us  p99 " << std::setw(7)
+                  << latencies[latencies.size() * 99 / 100] << "us  p99.9 " << std::setw(8)
+                  << latencies[latencies.size() * 999 / 1000] << "us  max " << std::setw(8) << latencies.back()
+                  << "us" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t orders = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 1000000;
+    std::string directory = argc > 2 ? argv[2] : "fork_snapshot_bench";
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+
+    auto start = Clock::now();
+    Book book;
+    buildBook(book, orders, 42);
+    std::vector<int> live(orders);
+    std::iota(live.begin(), live.end(), 1);
+    int nextId = static_cast<int>(orders) + 1;
+    std::mt19937 gen(7);
+    std::vector<const Book*> set{&book};
+    std::cout << orders << " orders, built in " << std::fixed << std::setprecision(0) << millisecondsSince(start)
+              << "ms" << std::endl << std::setprecision(1);
+
+    start = Clock::now();
+    if (!writeSnapshotSet(directory, 1, set)) {
+        std::cerr << "cannot write a snapshot to " << directory << std::endl;
+        return 1;
+    }
+    std::cout << "inline snapshot: matching stalled " << millisecondsSince(start) << "ms" << std::endl;
+
+    printLatencies("no snapshot:   ", churn(book, live, nextId, gen, 1.0, [] { return true; }));
+
+    uint64_t expected = bookStateHash(book);
+    ForkSnapshot snapshot;
+    if (!snapshot.start(directory, 2, set)) {
+        std::cerr << "fork failed" << std::endl;
+        return 1;
+    }
+    std::cout << "forked snapshot: matching stalled " << snapshot.getForkNanoseconds() / 1e6 << "ms" << std::endl;
+    std::vector<double> during = churn(book, live, nextId, gen, 60.0, [&] { return snapshot.isRunning(); });
+    snapshot.wait();
+    printLatencies("while writing: ", during);
+    std::cout << "child wrote the snapshot in " << snapshot.getWriteNanoseconds() / 1e6 << "ms" << std::endl;
+
+    std::vector<std::unique_ptr<Book>> restored;
+    uint64_t sequence = 0;
+    if (snapshot.getWrittenCount() != 1
+        || !readSnapshotSet(directory + "/" + snapshotSetName(2), restored, sequence) || restored.size() != 1
+        || bookStateHash(*restored[0]) != expected) {
+        std::cerr << "forked snapshot does not match the book at the fork" << std::endl;
+        return 1;
+    }
+    std::filesystem::remove_all(directory, error);
+    return 0;
+}
@@ -0,0 +1,384 @@
+#include "Journal.hpp"
+#include "Checksum.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t maxBatch = 4096;
+    constexpr size_t checksummedBytes = offsetof(JournalRecord, checksum);
+
+    bool writeAll(int fd, const void* data, size_t length, off_t offset) {
+        const char* bytes = static_cast<const char*>(data);
+        while (length > 0) {
+            ssize_t n = pwrite(fd, bytes, length, offset);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            bytes += n;
+            length -= static_cast<size_t>(n);
+            offset += n;
+        }
+        return true;
+    }
+
+    // Segment indices in directory, in order
+    std::vector<uint32_t> listSegments(const std::string& directory) {
+        std::vector<uint32_t> indices;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            std::string name = entry.path().filename().string();
+            unsigned index = 0;
+            char suffix[8] = {};
+            if (std::sscanf(name.c_str(), "journal-%u.%4s", &index, suffix) == 2 && std::strcmp(suffix, "wal") == 0
+                && name == journalSegmentName(index)) {
+                indices.push_back(index);
+            }
+        }
+        std::sort(indices.begin(), indices.end());
+        return indices;
+    }
+
+    // Valid record at position in a segment file
+    bool readRecord(const std::string& path, size_t position, JournalRecord& record) {
+        int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0) return false;
+        ssize_t n = pread(file, &record, sizeof(record), static_cast<off_t>(position * sizeof(record)));
+        close(file);
+        return n == static_cast<ssize_t>(sizeof(record)) && record.isValid();
+    }
+
+    void syncDirectory(const std::string& directory) {
+        int dirFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+    }
+}
+
+JournalRecord JournalRecord::make(uint64_t sequence, const OrderCommand& command) {
+    JournalRecord record{};
+    record.sequence = sequence;
+    record.type = command.type;
+    record.buyOrSell = command.buyOrSell;
+    record.symbolId = command.symbolId;
+    record.orderId = command.orderId;
+    record.shares = command.shares;
+    record.limitPrice = command.limitPrice;
+    record.stopPrice = command.stopPrice;
+    record.checksum = crc32c(&record, checksummedBytes);
+    return record;
+}
+
+bool JournalRecord::isValid() const {
+    return sequence != 0 && checksum == crc32c(this, checksummedBytes);
+}
+
+OrderCommand JournalRecord::command() const {
+    OrderCommand command;
+    command.type = static_cast<OrderCommand::Type>(type);
+    command.buyOrSell = buyOrSell != 0;
+    command.symbolId = symbolId;
+    command.orderId = orderId;
+    command.shares = shares;
+    command.limitPrice = limitPrice;
+    command.stopPrice = stopPrice;
+    return command;
+}
+
+std::string journalSegmentName(uint32_t index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "journal-%06u.wal", index);
+    return name;
+}
+
+Journal::Journal(std::string _directory, Durability _durability, size_t segmentBytes, size_t capacity,
+                 WaitStrategy _wait)
+    : directory(std::move(_directory)), durability(_durability),
+      segmentRecords(std::max<size_t>(segmentBytes / recordSize, 2)), wait(_wait), queue(capacity) {}
+
+Journal::~Journal() {
+    stop();
+}
+
+void Journal::start() {
+    if (running.load()) return;
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (!std::filesystem::is_directory(directory)) {
+        throw std::runtime_error("Journal directory " + directory + " cannot be created");
+    }
+
+    // Carry on after whatever is already there, in a fresh segment
+    std::vector<uint32_t> existing = listSegments(directory);
+    startSequence = readJournal(directory, UINT64_MAX, [](uint64_t, const OrderCommand&) {});
+    nextSequence = startSequence + 1;
+    appended = startSequence;
+    written.store(startSequence);
+    durable.store(startSequence);
+    segmentIndex = existing.empty() ? 1 : existing.back() + 1;
+    segmentOffset = 0;
+    fd = createSegment(segmentIndex);
+    if (fd < 0) throw std::runtime_error("Journal segment in " + directory + " cannot be created");
+
+    buffer.resize(maxBatch);
+    failed.store(false);
+    running.store(true);
+    writer = std::thread(&Journal::run, this);
+}
+
+void Journal::stop() {
+    if (!running.load()) return;
+    running.store(false);
+    queue.wake();
+    writer.join();
+    for (int* file : {&fd, &nextFd}) {
+        if (*file >= 0) close(*file);
+        *file = -1;
+    }
+}
+
+bool Journal::waitDurable(uint64_t sequence) const {
+    IdleStrategy idle(WaitStrategy::Yield);
+    for (uint32_t poll = 0;; ++poll) {
+        if (durable.load() >= sequence) return true;
+        if (failed.load()) return false;
+        if (poll < IdleStrategy::spinPolls) {
+            idle.idle();
+            continue;
+        }
+        // Pairs with publishDurable(): either it sees this waiter or this
+        // waiter sees the new durable sequence
+        uint32_t seen = progress.load();
+        waiters.fetch_add(1);
+        if (durable.load() < sequence && !failed.load()) progress.wait(seen);
+        waiters.fetch_sub(1);
+    }
+}
+
+void Journal::waitForRoom() {
+    ++fullWaits;
+    std::this_thread::yield();
+}
+
+int Journal::createSegment(uint32_t index) {
+    std::string path = directory + "/" + journalSegmentName(index);
+    int file = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0644);
+    if (file < 0) return -1;
+    off_t bytes = static_cast<off_t>(segmentRecords * recordSize);
+    // Reserve the whole segment up front; fall back to a sparse file where
+    // the filesystem cannot
+    if (posix_fallocate(file, 0, bytes) != 0 && ftruncate(file, bytes) != 0) {
+        close(file);
+        return -1;
+    }
+    if (durability != Durability::None) {
+        fsync(file);
+        syncDirectory(directory);
+    }
+    ++segmentsCreated;
+    return file;
+}
+
+bool Journal::advanceSegment() {
+    // Whatever sits in the old segment must be on disk before records
+    // after it are
+    if (durability != Durability::None && fdatasync(fd) != 0) return false;
+    close(fd);
+    fd = nextFd >= 0 ? nextFd : createSegment(segmentIndex + 1);
+    nextFd = -1;
+    ++segmentIndex;
+    segmentOffset = 0;
+    return fd >= 0;
+}
+
+bool Journal::writeBatch(size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        if (segmentOffset == segmentRecords && !advanceSegment()) return false;
+        size_t n = std::min(count - done, segmentRecords - segmentOffset);
+        if (!writeAll(fd, buffer.data() + done, n * recordSize, static_cast<off_t>(segmentOffset * recordSize))) {
+            return false;
+        }
+        segmentOffset += n;
+        done += n;
+        if (nextFd < 0 && segmentOffset >= segmentRecords / 2) nextFd = createSegment(segmentIndex + 1);
+    }
+    return true;
+}
+
+bool Journal::sync() {
+    ++syncs;
+    return fdatasync(fd) == 0;
+}
+
+void Journal::publishDurable(uint64_t sequence) {
+    durable.store(sequence);
+    progress.fetch_add(1);
+    if (waiters.load() > 0) progress.notify_all();
+}
+
+void Journal::run() {
+    IdleStrategy idleStrategy(wait);
+    auto park = [this]() { queue.park([this]() { return running.load(); }); };
+    auto lastSync = Clock::now();
+    uint64_t synced = nextSequence - 1;
+
+    auto fail = [this]() {
+        failed.store(true);
+        progress.fetch_add(1);
+        progress.notify_all();
+    };
+    auto syncWritten = [&]() {
+        uint64_t last = nextSequence - 1;
+        if (synced == last) return true;
+        if (!sync()) return false;
+        synced = last;
+        lastSync = Clock::now();
+        publishDurable(last);
+        return true;
+    };
+
+    for (;;) {
+        size_t count = 0;
+        size_t n = queue.consume([&](const OrderCommand& command) {
+            buffer[count] = JournalRecord::make(nextSequence + count, command);
+            ++count;
+        }, maxBatch);
+
+        if (n == 0) {
+            // Idle: a good moment to sync anything still pending
+            if (durability == Durability::Async && !syncWritten()) return fail();
+            if (!running.load() && queue.empty()) break;
+            idleStrategy.idle(park);
+            continue;
+        }
+        idleStrategy.reset();
+
+        if (!writeBatch(n)) return fail();
+        nextSequence += n;
+        ++batches;
+        largestBatch = std::max(largestBatch, n);
+        written.store(nextSequence - 1);
+
+        switch (durability) {
+            case Durability::None:
+                publishDurable(nextSequence - 1);
+                break;
+            case Durability::Async:
+                if (Clock::now() - lastSync >= syncInterval && !syncWritten()) return fail();
+                break;
+            case Durability::PerBatch:
+                if (!syncWritten()) return fail();
+                break;
+        }
+    }
+    if (durability != Durability::None && !syncWritten()) return fail();
+}
+
+uint64_t readJournal(const std::string& directory, uint64_t afterSequence,
+                     const std::function<void(uint64_t sequence, const OrderCommand& command)>& apply) {
+    std::vector<uint32_t> segments = listSegments(directory);
+    // First sequence of every segment (0 if it has no valid record), so
+    // segments wholly at or before afterSequence need not be read
+    std::vector<uint64_t> firsts(segments.size(), 0);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        JournalRecord record;
+        if (readRecord(directory + "/" + journalSegmentName(segments[i]), 0, record)) firsts[i] = record.sequence;
+    }
+
+    uint64_t last = 0;
+    std::vector<JournalRecord> chunk(maxBatch);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        uint64_t first = firsts[i];
+        if (first == 0) continue;
+        if (last != 0 && first != last + 1) return last;
+        size_t next = i + 1;
+        while (next < segments.size() && firsts[next] == 0) ++next;
+        // firsts[next] - 1, not afterSequence + 1: start() reads with
+        // afterSequence = UINT64_MAX
+        if (next < segments.size() && firsts[next] > first && firsts[next] - 1 <= afterSequence) {
+            last = firsts[next] - 1;
+            continue;
+        }
+
+        std::string path = directory + "/" + journalSegmentName(segments[i]);
+        // Records in a segment are consecutive, so the last one not wanted
+        // sits at a known offset; if it checks out, start right after it
+        size_t startRecord = 0;
+        if (afterSequence >= first) {
+            JournalRecord record;
+            size_t position = static_cast<size_t>(afterSequence - first);
+            if (readRecord(path, position, record) && record.sequence == afterSequence) {
+                startRecord = position + 1;
+                last = afterSequence;
+            }
+        }
+
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) break;
+        if (std::fseek(file, static_cast<long>(startRecord * Journal::recordSize), SEEK_SET) != 0) {
+            std::fclose(file);
+            break;
+        }
+        bool segmentEnded = false;
+        while (!segmentEnded) {
+            size_t n = std::fread(chunk.data(), Journal::recordSize, chunk.size(), file);
+            if (n == 0) break;
+            for (size_t j = 0; j < n; ++j) {
+                const JournalRecord& record = chunk[j];
+                // Zeroed preallocation or a torn write ends the segment
+                if (!record.isValid()) {
+                    segmentEnded = true;
+                    break;
+                }
+                if (last != 0 && record.sequence != last + 1) {
+                    std::fclose(file);
+                    return last;
+                }
+                last = record.sequence;
+                if (last > afterSequence) apply(last, record.command());
+            }
+        }
+        std::fclose(file);
+    }
+    return last;
+}
+
+uint64_t lastJournalSequence(const std::string& directory) {
+    std::vector<uint32_t> segments = listSegments(directory);
+    for (size_t i = segments.size(); i-- > 0;) {
+        std::string path = directory + "/" + journalSegmentName(segments[i]);
+        JournalRecord record;
+        if (!readRecord(path, 0, record)) continue;
+        uint64_t first = record.sequence;
+        std::error_code error;
+        size_t records = static_cast<size_t>(std::filesystem::file_size(path, error) / Journal::recordSize);
+        // Record low is known good; find the last one that is
+        size_t low = 0;
+        size_t high = error ? 1 : std::max<size_t>(records, 1);
+        while (high - low > 1) {
+            size_t middle = low + (high - low) / 2;
+            if (readRecord(path, middle, record) && record.sequence == first + middle) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        return first + low;
+    }
+    return 0;
+}
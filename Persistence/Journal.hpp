@@ -0,0 +1,174 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include "../Matching_Engine/SPSCQueue.hpp"
+#include "../Matching_Engine/WaitStrategy.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// When appended commands are forced to disk
+enum class Durability {
+    None,     // written to the OS, never synced: survives a process crash only
+    Async,    // synced at most every sync interval and whenever the writer idles
+    PerBatch  // every batch synced before it counts as durable (group commit)
+};
+
+// One command on disk: 40 bytes in host byte order. Sequence numbers start
+// at 1, so the zeroed, preallocated end of a segment reads as end of log.
+struct JournalRecord {
+    uint64_t sequence;
+    uint8_t type;
+    uint8_t buyOrSell;
+    uint16_t reserved;
+    int32_t symbolId;
+    int32_t orderId;
+    int32_t shares;
+    int32_t limitPrice;
+    int32_t stopPrice;
+    uint32_t padding;
+    uint32_t checksum;  // CRC-32C of the bytes before it
+
+    static JournalRecord make(uint64_t sequence, const OrderCommand& command);
+    bool isValid() const;
+    OrderCommand command() const;
+};
+static_assert(sizeof(JournalRecord) == 40, "journal records are 40 bytes on disk");
+
+// Write-ahead journal of inbound commands.
+//
+// The matching thread appends each command before applying it. An append
+// only copies the command into an SPSC ring, so disks never stall matching.
+// A writer thread takes everything queued as one batch, writes it with one
+// pwrite and, depending on durability, syncs it with one fdatasync.
+// Commands that arrive while a sync is in flight make up the next batch,
+// so under load one sync covers many commands (group commit).
+//
+// Records go to segment files journal-NNNNNN.wal in one directory. Each
+// segment is preallocated to its full size when created, and the next one
+// is created while the current one is half full, so steady-state writes
+// never extend a file. A journal started on a directory that already has
+// segments carries on after the last valid record, in a new segment.
+class Journal {
+public:
+    static constexpr size_t recordSize = sizeof(JournalRecord);
+
+    explicit Journal(std::string directory, Durability durability = Durability::PerBatch,
+                     size_t segmentBytes = 64 << 20, size_t capacity = 1 << 16,
+                     WaitStrategy wait = WaitStrategy::Backoff);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Opens the directory (creating it if needed) and starts the writer.
+    // Throws std::runtime_error if the directory or a segment cannot be used.
+    void start();
+    // Writes and syncs everything appended, then joins the writer
+    void stop();
+
+    // Async mode: longest time written records may go unsynced. Call before start().
+    void setSyncInterval(std::chrono::microseconds interval) { syncInterval = interval; }
+
+    // Single producer (the matching thread). Returns the command's sequence
+    // number, or 0 if the writer has failed. Waits only if the writer is a
+    // whole ring behind.
+    uint64_t append(const OrderCommand& command) {
+        // Nothing appended after a failure would ever be written
+        if (failed.load(std::memory_order_relaxed)) return 0;
+        while (!queue.tryPush(command)) {
+            if (failed.load(std::memory_order_relaxed)) return 0;
+            waitForRoom();
+        }
+        return ++appended;
+    }
+
+    // Any thread: highest sequence handed to the OS, and highest that is
+    // durable under the journal's mode (synced, or written for None)
+    uint64_t getWrittenSequence() const { return written.load(std::memory_order_acquire); }
+    uint64_t getDurableSequence() const { return durable.load(std::memory_order_acquire); }
+    // Any thread: block until sequence is durable. False if the writer hit
+    // an I/O error first.
+    bool waitDurable(uint64_t sequence) const;
+    bool hasFailed() const { return failed.load(std::memory_order_acquire); }
+
+    // Sequence of the last record already on disk at start()
+    uint64_t getStartSequence() const { return startSequence; }
+    // Producer side
+    uint64_t getAppendedSequence() const { return appended; }
+    uint64_t getFullWaits() const { return fullWaits; }
+    // Writer statistics, safe to read once stopped
+    uint64_t getBatchCount() const { return batches; }
+    uint64_t getSyncCount() const { return syncs; }
+    size_t getLargestBatch() const { return largestBatch; }
+    uint32_t getSegmentCount() const { return segmentsCreated; }
+
+private:
+    std::string directory;
+    Durability durability;
+    size_t segmentRecords;
+    WaitStrategy wait;
+    std::chrono::microseconds syncInterval{10000};
+    SPSCQueue<OrderCommand> queue;
+
+    // Producer side
+    uint64_t appended = 0;
+    uint64_t fullWaits = 0;
+
+    // Writer side
+    std::thread writer;
+    std::atomic<bool> running{false};
+    std::vector<JournalRecord> buffer;
+    uint64_t startSequence = 0;
+    uint64_t nextSequence = 1;
+    uint32_t segmentIndex = 0;
+    int fd = -1;
+    int nextFd = -1;
+    size_t segmentOffset = 0;  // records in the current segment
+    uint64_t batches = 0;
+    uint64_t syncs = 0;
+    size_t largestBatch = 0;
+    uint32_t segmentsCreated = 0;
+
+    alignas(64) std::atomic<uint64_t> written{0};
+    alignas(64) std::atomic<uint64_t> durable{0};
+    mutable std::atomic<uint32_t> waiters{0};
+    std::atomic<bool> failed{false};
+    // Bumped with every durable advance (and on failure) for waitDurable()
+    mutable std::atomic<uint32_t> progress{0};
+
+    void run();
+    bool writeBatch(size_t count);
+    bool sync();
+    bool advanceSegment();
+    int createSegment(uint32_t index);
+    void publishDurable(uint64_t sequence);
+    void waitForRoom();
+};
+
+// Segment file name for an index, e.g. journal-000001.wal
+std::string journalSegmentName(uint32_t index);
+
+// Read the journal in directory segment by segment, calling apply for every
+// record with sequence > afterSequence. A segment ends at its first zeroed,
+// torn or corrupt record; reading stops where sequences do not continue.
+// Records up to afterSequence are skipped without being read where
+// possible: whole segments that end before it, and the start of the
+// segment that holds it. Returns the sequence of the last valid record
+// (0 if none).
+uint64_t readJournal(const std::string& directory, uint64_t afterSequence,
+                     const std::function<void(uint64_t sequence, const OrderCommand& command)>& apply);
+
+// Sequence of the last record in the journal's newest segment that has one
+// (0 if none), found with a few reads instead of a scan: records in a
+// segment are consecutive and the unwritten rest of it is zeroed.
+uint64_t lastJournalSequence(const std::string& directory);
+
+#endif
@@ -0,0 +1,92 @@
+#include "Journal.hpp"
+#include "../Generate_Orders/GenerateOrders.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Matching latency with and without the write-ahead journal.
+// Usage: JournalBench [commands] [directory]
+//
+// Matches one generated single-symbol log on this thread, journaling each
+// command before applying it, once without a journal and once per
+// durability mode. Prints percentiles of the time per command (append plus
+// match) and what the writer did: batches, syncs and the largest group
+// committed by one sync. The journal directory is emptied before each run.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Mode {
+        const char* name;
+        bool journaled;
+        Durability durability;
+    };
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 1000000;
+    std::string directory = argc > 2 ? argv[2] : "journal_bench";
+
+    std::vector<OrderCommand> log = generateCommandLog(1, count, 42);
+    std::vector<double> latencies(count);
+    std::cout << count << " commands, journal in " << directory << std::endl;
+
+    const Mode modes[] = {
+        {"off", false, Durability::None},
+        {"none", true, Durability::None},
+        {"async", true, Durability::Async},
+        {"batch", true, Durability::PerBatch},
+    };
+    for (const Mode& mode : modes) {
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+        std::unique_ptr<Journal> journal;
+        if (mode.journaled) {
+            journal = std::make_unique<Journal>(directory, mode.durability);
+            journal->start();
+        }
+
+        Book book;
+        auto start = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            auto before = Clock::now();
+            if (journal) journal->append(log[i]);
+            try {
+                applyOrderCommand(book, log[i]);
+            } catch (const std::exception&) {}
+            latencies[i] = std::chrono::duration<double, std::nano>(Clock::now() - before).count();
+        }
+        double matching = std::chrono::duration<double>(Clock::now() - start).count();
+        // How long after matching finished until the last command was durable
+        double tail = 0;
+        if (journal) {
+            journal->waitDurable(count);
+            tail = std::chrono::duration<double, std::milli>(Clock::now() - start).count() - matching * 1e3;
+            journal->stop();
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << std::left << std::setw(6) << mode.name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(10) << count / matching << " cmd/s  p50 " << std::setw(5) << latencies[count / 2]
+                  << "ns  p99 " << std::setw(6) << latencies[count * 99 / 100] << "ns  p99.9 " << std::setw(7)
+                  << latencies[count * 999 / 1000] << "ns  max " << std::setw(9) << latencies.back() << "ns";
+        if (journal) {
+            std::cout << "  | " << journal->getBatchCount() << " batches, " << journal->getSyncCount() << " syncs, largest "
+                      << journal->getLargestBatch() << ", " << journal->getFullWaits() << " full waits, durable "
+                      << std::setprecision(1) << tail << "ms after";
+        }
+        std::cout << std::endl;
+    }
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return 0;
+}
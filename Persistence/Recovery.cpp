@@ -0,0 +1,199 @@
+#include "Recovery.hpp"
+#include "BookSnapshot.hpp"
+#include "Journal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <sstream>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    uint64_t mix(uint64_t hash, uint64_t value) {
+        hash = (hash ^ value) * 0xFF51AFD7ED558CCDull;
+        return hash ^ (hash >> 32);
+    }
+
+    // Fold what one command did into the rolling hash
+    uint64_t foldCommand(uint64_t hash, uint64_t sequence, bool applied, const Book* book) {
+        hash = mix(hash, sequence << 1 | static_cast<uint64_t>(applied));
+        if (!book) return hash;
+        for (const Fill& fill : book->getFills()) {
+            hash = mix(hash, static_cast<uint64_t>(static_cast<uint32_t>(fill.makerId)) << 32
+                                 | static_cast<uint32_t>(fill.takerId));
+            hash = mix(hash, static_cast<uint64_t>(static_cast<uint32_t>(fill.price)) << 32
+                                 | static_cast<uint32_t>(fill.shares) << 1 | static_cast<uint64_t>(fill.takerBuys));
+        }
+        return mix(hash, static_cast<uint64_t>(static_cast<uint32_t>(book->getBestBidPrice())) << 32
+                             | static_cast<uint32_t>(book->getBestAskPrice()));
+    }
+
+    // State hash of every book, indexed by symbol; symbols without a book
+    // hash as an empty one
+    std::vector<uint64_t> hashBooks(const std::vector<std::unique_ptr<Book>>& books) {
+        Book empty;
+        uint64_t emptyHash = bookStateHash(empty);
+        std::vector<uint64_t> hashes(books.size(), emptyHash);
+        for (size_t symbol = 0; symbol < books.size(); ++symbol) {
+            if (books[symbol]) hashes[symbol] = bookStateHash(*books[symbol]);
+        }
+        return hashes;
+    }
+
+    // First symbol whose hashes differ, or -1
+    int firstDifference(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+        Book empty;
+        uint64_t emptyHash = bookStateHash(empty);
+        for (size_t symbol = 0; symbol < std::max(a.size(), b.size()); ++symbol) {
+            uint64_t left = symbol < a.size() ? a[symbol] : emptyHash;
+            uint64_t right = symbol < b.size() ? b[symbol] : emptyHash;
+            if (left != right) return static_cast<int>(symbol);
+        }
+        return -1;
+    }
+}
+
+bool applyToBooks(std::vector<std::unique_ptr<Book>>& books, const OrderCommand& command) {
+    if (command.symbolId < 0) return false;
+    size_t index = static_cast<size_t>(command.symbolId);
+    if (index >= books.size()) books.resize(index + 1);
+    if (!books[index]) books[index] = std::make_unique<Book>();
+    try {
+        applyOrderCommand(*books[index], command);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+BookRecovery::BookRecovery(std::string _snapshotDirectory, std::string _journalDirectory)
+    : snapshotDirectory(std::move(_snapshotDirectory)), journalDirectory(std::move(_journalDirectory)) {}
+
+BookRecovery::~BookRecovery() {
+    if (verifier.joinable()) verifier.join();
+}
+
+uint64_t BookRecovery::run(bool verify) {
+    auto start = Clock::now();
+    // Newest first; a set that does not read back whole is passed over
+    uint64_t journalEnd = lastJournalSequence(journalDirectory);
+    std::vector<uint64_t> sets = listSnapshotSets(snapshotDirectory);
+    for (size_t i = sets.size(); i-- > 0;) {
+        // Holds commands the journal never got to write. Without any journal
+        // (snapshots only) there is nothing to be ahead of.
+        if (journalEnd > 0 && sets[i] > journalEnd) {
+            ++aheadSnapshots;
+            continue;
+        }
+        std::string path = snapshotDirectory + "/" + snapshotSetName(sets[i]);
+        uint64_t sequence = 0;
+        if (readSnapshotSet(path, books, sequence)) {
+            snapshotSequence = sequence;
+            break;
+        }
+        ++skippedSnapshots;
+    }
+    restoreSeconds = secondsSince(start);
+
+    verifying = verify;
+    if (verifying) {
+        recovered.snapshotHashes = hashBooks(books);
+        verifier = std::thread(&BookRecovery::verify, this);
+    }
+
+    start = Clock::now();
+    uint64_t digest = 0;
+    uint64_t last = readJournal(journalDirectory, snapshotSequence, [&](uint64_t sequence, const OrderCommand& command) {
+        bool applied = applyToBooks(books, command);
+        ++replayed;
+        if (!applied) ++errors;
+        if (verifying) {
+            digest = foldCommand(digest, sequence, applied, applied ? books[command.symbolId].get() : nullptr);
+            if (sequence % digestInterval == 0) recovered.digests.emplace_back(sequence, digest);
+        }
+    });
+    lastSequence = std::max(last, snapshotSequence);
+    replaySeconds = secondsSince(start);
+
+    if (verifying) {
+        if (lastSequence % digestInterval != 0) recovered.digests.emplace_back(lastSequence, digest);
+        recovered.finalHashes = hashBooks(books);
+        recovered.lastSequence = lastSequence;
+    }
+    return lastSequence;
+}
+
+void BookRecovery::verify() {
+    auto start = Clock::now();
+    std::vector<std::unique_ptr<Book>> replayBooks;
+    uint64_t digest = 0;
+    bool atSnapshot = snapshotSequence == 0;
+    if (atSnapshot) replica.snapshotHashes = hashBooks(replayBooks);
+
+    uint64_t last = readJournal(journalDirectory, 0, [&](uint64_t sequence, const OrderCommand& command) {
+        if (!atSnapshot && sequence > snapshotSequence) {
+            replica.snapshotHashes = hashBooks(replayBooks);
+            atSnapshot = true;
+        }
+        bool applied = applyToBooks(replayBooks, command);
+        if (sequence > snapshotSequence) {
+            digest = foldCommand(digest, sequence, applied, applied ? replayBooks[command.symbolId].get() : nullptr);
+            if (sequence % digestInterval == 0) replica.digests.emplace_back(sequence, digest);
+        }
+    });
+    if (!atSnapshot && last == snapshotSequence) {
+        replica.snapshotHashes = hashBooks(replayBooks);
+        atSnapshot = true;
+    }
+    uint64_t end = std::max(last, snapshotSequence);
+    if (end % digestInterval != 0) replica.digests.emplace_back(end, digest);
+    replica.finalHashes = hashBooks(replayBooks);
+    replica.lastSequence = last;
+    verifySeconds = secondsSince(start);
+}
+
+bool BookRecovery::waitVerified() {
+    if (!verifying) return true;
+    if (verifier.joinable()) {
+        verifier.join();
+        mismatch = compareTraces();
+    }
+    return mismatch.empty();
+}
+
+std::string BookRecovery::compareTraces() const {
+    std::ostringstream difference;
+    if (replica.lastSequence < snapshotSequence) {
+        difference << "journal ends at " << replica.lastSequence << ", before the snapshot at " << snapshotSequence;
+        return difference.str();
+    }
+    int symbol = firstDifference(recovered.snapshotHashes, replica.snapshotHashes);
+    if (symbol >= 0) {
+        difference << "snapshot at " << snapshotSequence << " differs from the replayed journal for symbol " << symbol;
+        return difference.str();
+    }
+    uint64_t previous = snapshotSequence;
+    for (size_t i = 0; i < std::min(recovered.digests.size(), replica.digests.size()); ++i) {
+        if (recovered.digests[i] != replica.digests[i]) {
+            difference << "replays diverge between sequences " << previous + 1 << " and "
+                       << std::max(recovered.digests[i].first, replica.digests[i].first);
+            return difference.str();
+        }
+        previous = recovered.digests[i].first;
+    }
+    if (recovered.digests.size() != replica.digests.size() || recovered.lastSequence != replica.lastSequence) {
+        difference << "replays end at " << recovered.lastSequence << " and " << replica.lastSequence;
+        return difference.str();
+    }
+    symbol = firstDifference(recovered.finalHashes, replica.finalHashes);
+    if (symbol >= 0) {
+        difference << "final book of symbol " << symbol << " differs";
+        return difference.str();
+    }
+    return {};
+}
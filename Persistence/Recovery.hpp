@@ -0,0 +1,116 @@
+#ifndef RECOVERY_HPP
+#define RECOVERY_HPP
+
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Rebuilds a matching thread's books after a restart.
+//
+// run() restores the newest snapshot set in the snapshot directory that
+// reads back whole (older ones are tried if the newest is damaged), then
+// applies every journal command after the set's sequence, exactly as
+// MatchingThread::apply would. With no usable snapshot it replays the
+// whole journal.
+//
+// Sets tagged past the journal's last record are passed over (and counted)
+// instead: they hold commands the journal lost, and a journal restarted on
+// the directory numbers new commands from that last record. So run()
+// returns where the journal ends, and the journal carries on from there.
+// Nothing is renamed or removed; such sets must be cleared away before the
+// new journal reaches their sequence. An empty journal (snapshots only)
+// leaves every set eligible.
+//
+// With verify, a second thread meanwhile replays the whole journal from
+// the start into books of its own, and the two runs are compared:
+// - at the snapshot's sequence, the snapshot books against the replayed
+//   ones (bookStateHash of each symbol);
+// - through the tail, a rolling hash of what every command did (rejected
+//   or not, each fill, the top of book after it), checkpointed every
+//   digestInterval commands, so a divergence is located to one interval;
+// - at the end, every book's bookStateHash.
+// waitVerified() waits for that thread and reports the first difference.
+class BookRecovery {
+public:
+    static constexpr uint64_t digestInterval = 4096;
+
+    BookRecovery(std::string snapshotDirectory, std::string journalDirectory);
+    ~BookRecovery();
+
+    BookRecovery(const BookRecovery&) = delete;
+    BookRecovery& operator=(const BookRecovery&) = delete;
+
+    // Restore and replay. Returns the sequence of the last command applied
+    // (0 if there is nothing to recover). Call once.
+    uint64_t run(bool verify = false);
+
+    // Recovered books, indexed by symbol id (null where a symbol has none).
+    // Hand them on (MatchingThread::restoreBooks) only after waitVerified()
+    // when verifying, since the final check hashes them.
+    std::vector<std::unique_ptr<Book>>& getBooks() { return books; }
+
+    // Block until verification is done. True if every check matched (and
+    // trivially if run() did not verify); otherwise getMismatch() says where.
+    bool waitVerified();
+    const std::string& getMismatch() const { return mismatch; }
+
+    // Sequence of the snapshot restored (0 if none) and how many newer,
+    // unreadable snapshot sets were passed over
+    uint64_t getSnapshotSequence() const { return snapshotSequence; }
+    uint32_t getSkippedSnapshots() const { return skippedSnapshots; }
+    // Sets passed over for being ahead of the journal
+    uint32_t getAheadSnapshots() const { return aheadSnapshots; }
+    uint64_t getLastSequence() const { return lastSequence; }
+    // Journal commands applied after the snapshot, and how many of those the
+    // books rejected (as MatchingThread::getErrorCount counts them)
+    uint64_t getReplayedCount() const { return replayed; }
+    uint64_t getErrorCount() const { return errors; }
+    double getRestoreSeconds() const { return restoreSeconds; }
+    double getReplaySeconds() const { return replaySeconds; }
+    // Wall time of the full replay on the verifying thread
+    double getVerifySeconds() const { return verifySeconds; }
+
+private:
+    // One side's record of a replay, compared after both finish
+    struct Trace {
+        std::vector<uint64_t> snapshotHashes;  // by symbol, at the snapshot
+        std::vector<std::pair<uint64_t, uint64_t>> digests;  // (sequence, rolling hash)
+        std::vector<uint64_t> finalHashes;  // by symbol, at the end
+        uint64_t lastSequence = 0;
+    };
+
+    std::string snapshotDirectory;
+    std::string journalDirectory;
+    std::vector<std::unique_ptr<Book>> books;
+    uint64_t snapshotSequence = 0;
+    uint32_t skippedSnapshots = 0;
+    uint32_t aheadSnapshots = 0;
+    uint64_t lastSequence = 0;
+    uint64_t replayed = 0;
+    uint64_t errors = 0;
+    double restoreSeconds = 0;
+    double replaySeconds = 0;
+    double verifySeconds = 0;
+
+    bool verifying = false;
+    std::thread verifier;
+    Trace recovered;
+    Trace replica;
+    std::string mismatch;
+
+    void verify();
+    std::string compareTraces() const;
+};
+
+// Apply one journaled command to the book of its symbol, creating the book
+// on first use, as the matching thread does. Returns false if the book
+// rejected the command.
+bool applyToBooks(std::vector<std::unique_ptr<Book>>& books, const OrderCommand& command);
+
+#endif
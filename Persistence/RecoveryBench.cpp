@@ -0,0 +1,91 @@
+#include "BookSnapshot.hpp"
+#include "Journal.hpp"
+#include "Recovery.hpp"
+#include "../Generate_Orders/GenerateOrders.hpp"
+#include "../Matching_Engine/MatchingThread.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Recovery time from a snapshot plus the journal tail, against replaying
+// the whole journal, and the cost of verifying the result.
+// Usage: RecoveryBench [commands] [symbols] [directory]
+//
+// A matching thread journals a generated log and writes a snapshot set
+// after 90% of it. Recovery then runs three ways: snapshot and tail,
+// whole journal (no snapshot), and snapshot and tail with the full replay
+// verifying it on a second thread. Everything is written under directory,
+// which is removed at the end.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 2000000;
+    int symbols = argc > 2 ? std::atoi(argv[2]) : 4;
+    std::string directory = argc > 3 ? argv[3] : "recovery_bench";
+    std::string journalDirectory = directory + "/journal";
+    std::string snapshotDirectory = directory + "/snapshots";
+    std::string emptyDirectory = directory + "/none";
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+
+    std::vector<OrderCommand> log = generateCommandLog(symbols, count, 42);
+    size_t snapshotAt = count * 9 / 10;
+    {
+        Journal journal(journalDirectory, Durability::None);
+        journal.start();
+        MatchingThread matcher;
+        matcher.setJournal(&journal);
+        matcher.start();
+        matcher.submitBatch(log.data(), snapshotAt);
+        matcher.drain();
+        auto start = Clock::now();
+        if (!matcher.writeSnapshot(snapshotDirectory)) {
+            std::cerr << "cannot write a snapshot to " << snapshotDirectory << std::endl;
+            return 1;
+        }
+        std::cout << count << " commands on " << symbols << " symbols, snapshot at " << snapshotAt << " written in "
+                  << std::fixed << std::setprecision(1) << secondsSince(start) * 1e3 << "ms" << std::endl;
+        matcher.submitBatch(log.data() + snapshotAt, count - snapshotAt);
+        matcher.drain();
+        matcher.stop();
+        journal.stop();
+    }
+
+    {
+        BookRecovery recovery(snapshotDirectory, journalDirectory);
+        recovery.run();
+        std::cout << "snapshot + tail: restore " << recovery.getRestoreSeconds() * 1e3 << "ms, replay "
+                  << recovery.getReplayedCount() << " commands " << recovery.getReplaySeconds() * 1e3 << "ms"
+                  << std::endl;
+    }
+    {
+        BookRecovery recovery(emptyDirectory, journalDirectory);
+        recovery.run();
+        std::cout << "whole journal:   replay " << recovery.getReplayedCount() << " commands "
+                  << recovery.getReplaySeconds() * 1e3 << "ms" << std::endl;
+    }
+    {
+        auto start = Clock::now();
+        BookRecovery recovery(snapshotDirectory, journalDirectory);
+        recovery.run(true);
+        double recovered = secondsSince(start);
+        bool verified = recovery.waitVerified();
+        std::cout << "verified:        recovered in " << recovered * 1e3 << "ms, verified after "
+                  << secondsSince(start) * 1e3 << "ms (full replay " << recovery.getVerifySeconds() * 1e3 << "ms) "
+                  << (verified ? "match" : recovery.getMismatch()) << std::endl;
+        if (!verified) return 1;
+    }
+    std::filesystem::remove_all(directory, error);
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "BookSnapshot.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Market_Data/L3FeedHandler.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+// Snapshot size and save/restore time of a deep book.
+// Usage: SnapshotBench [orders] [path]
+//
+// Builds a book of `orders` resting orders (1% of them stops and
+// stop-limits) spread over 2000 price levels per side, then times encoding
+// it, writing it to path (synced), reading it back and restoring it in
+// bulk, and compares that with rebuilding the same book one order at a time
+// through insertRestingOrder. The restored book is checked against the
+// source and the file removed.
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double millisecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void buildBook(Book& book, size_t orders, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> percent(0, 99);
+        std::uniform_int_distribution<> depth(0, 1999);
+        std::uniform_int_distribution<> shares(1, 500);
+        const int mid = 100000;
+        for (size_t i = 1; i <= orders; ++i) {
+            int id = static_cast<int>(i);
+            bool buy = percent(gen) < 50;
+            int offset = depth(gen) + 1;
+            if (percent(gen) == 0) {
+                // Stops far beyond the book, so none trigger
+                int stopPrice = buy ? mid + 5000 + offset : mid - 5000 - offset;
+                if (percent(gen) < 50) book.addStopOrder(id, buy, shares(gen), stopPrice);
+                else book.addStopLimitOrder(id, buy, shares(gen), buy ? stopPrice + 5 : stopPrice - 5, stopPrice);
+            } else {
+                book.insertRestingOrder(id, buy, shares(gen), buy ? mid - offset : mid + offset);
+            }
+        }
+    }
+
+    // The per-order alternative: every order through the normal insert path
+    void rebuildOrderByOrder(const Book& source, Book& book) {
+        for (const auto* limits : {&source.getBuyLimits(), &source.getSellLimits()}) {
+            for (const Limit* level : *limits) {
+                for (const Order* order = level->getHeadOrder(); order; order = order->nextOrder) {
+                    book.insertRestingOrder(order->getOrderId(), order->getBuyOrSell(), order->getShares(),
+                                            level->getLimitPrice());
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t orders = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 10000000;
+    std::string path = argc > 2 ? argv[2] : "book.snap";
+
+    auto start = Clock::now();
+    Book book;
+    buildBook(book, orders, 42);
+    std::cout << orders << " orders, " << book.getBuyLimits().size() + book.getSellLimits().size() << " levels, "
+              << book.getStopBuyLimits().size() + book.getStopSellLimits().size() << " stop levels, built in "
+              << std::fixed << std::setprecision(0) << millisecondsSince(start) << "ms" << std::endl;
+
+    start = Clock::now();
+    std::string image;
+    encodeBookSnapshot(book, orders, image);
+    double encodeTime = millisecondsSince(start);
+    start = Clock::now();
+    bool written = writeBookSnapshot(book, orders, path);
+    double writeTime = millisecondsSince(start);
+    if (!written) {
+        std::cerr << "cannot write " << path << std::endl;
+        return 1;
+    }
+    std::cout << std::setprecision(1) << "snapshot " << image.size() / 1e6 << "MB ("
+              << static_cast<double>(image.size()) / orders << " bytes/order), encode " << encodeTime
+              << "ms, encode+write+sync " << writeTime << "ms" << std::endl;
+
+    // Bulk restore straight from memory, then from the file
+    auto restored = std::make_unique<Book>();
+    uint64_t sequence = 0;
+    start = Clock::now();
+    bool decoded = decodeBookSnapshot(image, *restored, sequence);
+    double decodeTime = millisecondsSince(start);
+    restored.reset();
+    restored = std::make_unique<Book>();
+    start = Clock::now();
+    bool read = readBookSnapshot(path, *restored, sequence);
+    double readTime = millisecondsSince(start);
+    std::cout << "restore " << decodeTime << "ms from memory, " << readTime << "ms from file" << std::endl;
+    std::string difference = compareBooks(book, *restored);
+    if (!decoded || !read || sequence != orders || !difference.empty()) {
+        std::cerr << "restore failed " << difference << std::endl;
+        return 1;
+    }
+    restored.reset();
+
+    Book perOrder;
+    start = Clock::now();
+    rebuildOrderByOrder(book, perOrder);
+    std::cout << "order by order (no stops) " << millisecondsSince(start) << "ms" << std::endl;
+
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "OrderCommand.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+
+#include <charconv>
+
+namespace {
+    struct CommandFormat {
+        std::string_view name;
+        OrderCommand::Type type;
+        bool hasSide;
+        bool hasShares;
+        bool hasLimit;
+        bool hasStop;
+    };
+
+    // Field order on a line: orderId [buyOrSell] [shares] [limitPrice] [stopPrice]
+    constexpr CommandFormat formats[] = {
+        {"Market",          OrderCommand::Market,          true,  true,  false, false},
+        {"AddLimit",        OrderCommand::AddLimit,        true,  true,  true,  false},
+        {"AddMarketLimit",  OrderCommand::AddLimit,        true,  true,  true,  false},
+        {"CancelLimit",     OrderCommand::CancelLimit,     false, false, false, false},
+        {"ModifyLimit",     OrderCommand::ModifyLimit,     false, true,  true,  false},
+        {"AddStop",         OrderCommand::AddStop,         true,  true,  false, true},
+        {"CancelStop",      OrderCommand::CancelStop,      false, false, false, false},
+        {"ModifyStop",      OrderCommand::ModifyStop,      false, true,  false, true},
+        {"AddStopLimit",    OrderCommand::AddStopLimit,    true,  true,  true,  true},
+        {"CancelStopLimit", OrderCommand::CancelStopLimit, false, false, false, false},
+        {"ModifyStopLimit", OrderCommand::ModifyStopLimit, false, true,  true,  true},
+    };
+
+    const CommandFormat* findFormat(std::string_view name) {
+        for (const CommandFormat& format : formats) {
+            if (format.name == name) return &format;
+        }
+        return nullptr;
+    }
+
+    const CommandFormat& formatFor(OrderCommand::Type type) {
+        for (const CommandFormat& format : formats) {
+            if (format.type == type) return format;
+        }
+        return formats[0];
+    }
+
+    void appendInt(std::string& output, int value) {
+        char buffer[16];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        output.push_back(' ');
+        output.append(buffer, result.ptr);
+    }
+
+    std::string_view nextToken(std::string_view& line) {
+        size_t start = line.find_first_not_of(" \t\r\n");
+        if (start == std::string_view::npos) {
+            line = {};
+            return {};
+        }
+        size_t end = line.find_first_of(" \t\r\n", start);
+        if (end == std::string_view::npos) end = line.size();
+        std::string_view token = line.substr(start, end - start);
+        line.remove_prefix(end);
+        return token;
+    }
+
+    bool nextInt(std::string_view& line, int& value) {
+        std::string_view token = nextToken(line);
+        auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+        return !token.empty() && result.ec == std::errc() && result.ptr == token.data() + token.size();
+    }
+}
+
+bool parseOrderCommand(std::string_view line, OrderCommand& command, std::string_view& symbol)
+{
+    symbol = {};
+    std::string_view token = nextToken(line);
+    const CommandFormat* format = findFormat(token);
+    if (!format) {
+        // Not a type, so it is the symbol of a multi-instrument log
+        symbol = token;
+        format = findFormat(nextToken(line));
+        if (!format) return false;
+    }
+
+    command = OrderCommand{};
+    command.type = format->type;
+    if (!nextInt(line, command.orderId)) return false;
+    if (format->hasSide) {
+        int side = 0;
+        if (!nextInt(line, side)) return false;
+        command.buyOrSell = side != 0;
+    }
+    if (format->hasShares && !nextInt(line, command.shares)) return false;
+    if (format->hasLimit && !nextInt(line, command.limitPrice)) return false;
+    if (format->hasStop && !nextInt(line, command.stopPrice)) return false;
+    return true;
+}
+
+void formatOrderCommand(const OrderCommand& command, std::string_view symbol, std::string& output)
+{
+    const CommandFormat& format = formatFor(command.type);
+    if (!symbol.empty()) {
+        output.append(symbol);
+        output.push_back(' ');
+    }
+    output.append(format.name);
+    appendInt(output, command.orderId);
+    if (format.hasSide) appendInt(output, command.buyOrSell ? 1 : 0);
+    if (format.hasShares) appendInt(output, command.shares);
+    if (format.hasLimit) appendInt(output, command.limitPrice);
+    if (format.hasStop) appendInt(output, command.stopPrice);
+    output.push_back('\n');
+}
+
+void applyOrderCommand(Book& book, const OrderCommand& command)
+{
+    switch (command.type) {
+        case OrderCommand::Market:
+            book.marketOrder(command.orderId, command.buyOrSell, command.shares);
+            break;
+        case OrderCommand::AddLimit:
+            book.addLimitOrder(command.orderId, command.buyOrSell, command.shares, command.limitPrice);
+            break;
+        case OrderCommand::CancelLimit:
+            book.cancelLimitOrder(command.orderId);
+            break;
+        case OrderCommand::ModifyLimit:
+            book.modifyLimitOrder(command.orderId, command.shares, command.limitPrice);
+            break;
+        case OrderCommand::AddStop:
+            book.addStopOrder(command.orderId, command.buyOrSell, command.shares, command.stopPrice);
+            break;
+        case OrderCommand::CancelStop:
+            book.cancelStopOrder(command.orderId);
+            break;
+        case OrderCommand::ModifyStop:
+            book.modifyStopOrder(command.orderId, command.shares, command.stopPrice);
+            break;
+        case OrderCommand::AddStopLimit:
+            book.addStopLimitOrder(command.orderId, command.buyOrSell, command.shares,
+                                   command.limitPrice, command.stopPrice);
+            break;
+        case OrderCommand::CancelStopLimit:
+            book.cancelStopLimitOrder(command.orderId);
+            break;
+        case OrderCommand::ModifyStopLimit:
+            book.modifyStopLimitOrder(command.orderId, command.shares,
+                                      command.limitPrice, command.stopPrice);
+            break;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef ORDERCOMMAND_HPP
+#define ORDERCOMMAND_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class Book;
+
+// One book operation in a compact, copyable form, so that it can be parsed
+// on one thread and queued to whichever thread owns the book
+struct OrderCommand {
+    enum Type : uint8_t {
+        Market,
+        AddLimit,
+        CancelLimit,
+        ModifyLimit,
+        AddStop,
+        CancelStop,
+        ModifyStop,
+        AddStopLimit,
+        CancelStopLimit,
+        ModifyStopLimit
+    };
+
+    Type type = Market;
+    bool buyOrSell = false;
+    int symbolId = 0;
+    int orderId = 0;
+    int shares = 0;
+    int limitPrice = 0;
+    int stopPrice = 0;
+};
+
+// Parse one order log line: "[SYMBOL] Type orderId args...", e.g.
+// "AddLimit 7 1 100 301" or "MSFT CancelLimit 7". The symbol, if present, is
+// returned in symbol (empty otherwise); symbolId is left for the caller.
+// Returns false for unknown types and malformed lines.
+bool parseOrderCommand(std::string_view line, OrderCommand& command, std::string_view& symbol);
+
+// Append command as one log line (with a trailing newline) that
+// parseOrderCommand reads back; the symbol is written first if not empty
+void formatOrderCommand(const OrderCommand& command, std::string_view symbol, std::string& output);
+
+// Run the command against book
+void applyOrderCommand(Book& book, const OrderCommand& command);
+
+#endif
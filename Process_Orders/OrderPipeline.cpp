@@ -1,27 +1,26 @@
 #include "OrderPipeline.hpp"
+#include "OrderCommand.hpp"
 #include "../Limit_Order_Book/Book.hpp"
+#include "../Limit_Order_Book/BookManager.hpp"
+#include "../Matching_Engine/MatchingThread.hpp"
+#include "../Matching_Engine/ShardedEngine.hpp"
+#include "../Matching_Engine/WorkStealingPool.hpp"
+#include <algorithm>
+#include <exception>
+#include <numeric>
+#include <vector>
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <string>
-#include <random>
 #include <chrono>
 
-OrderPipeline::OrderPipeline(Book* book) : book(book) {
-    orderFunctions = {
-        {"Market", &OrderPipeline::processMarketOrder},
-        {"AddLimit", &OrderPipeline::processAddLimitOrder},
-        {"AddMarketLimit", &OrderPipeline::processAddLimitOrder},
-        {"CancelLimit", &OrderPipeline::processCancelLimitOrder},
-        {"ModifyLimit", &OrderPipeline::processModifyLimitOrder},
-        {"AddStop", &OrderPipeline::processAddStopOrder},
-        {"CancelStop", &OrderPipeline::processCancelStopOrder},
-        {"ModifyStop", &OrderPipeline::processModifyStopOrder},
-        {"AddStopLimit", &OrderPipeline::processAddStopLimitOrder},
-        {"CancelStopLimit", &OrderPipeline::processCancelStopLimitOrder},
-        {"ModifyStopLimit", &OrderPipeline::processModifyStopLimitOrder}
-    };
-}
+OrderPipeline::OrderPipeline(Book* book) : book(book) {}
+
+OrderPipeline::OrderPipeline(ShardedEngine* engine) : engine(engine) {}
+
+OrderPipeline::OrderPipeline(MatchingThread* matcher) : matcher(matcher) {}
+
+OrderPipeline::OrderPipeline(BookManager* books, WorkStealingPool* pool) : books(books), pool(pool) {}
 
 void OrderPipeline::processOrdersFromFile(const std::string& filename) 
 {
@@ -31,6 +30,20 @@ void OrderPipeline::processOrdersFromFile(const std::string& filename)
         return;
     }
 
+    if (engine) {
+        processIntoShards(file);
+    } else if (matcher) {
+        processIntoMatchingThread(file);
+    } else if (pool) {
+        processInParallel(file);
+    } else {
+        processIntoBook(file);
+    }
+    file.close();
+}
+
+void OrderPipeline::processIntoBook(std::ifstream& file)
+{
     std::ofstream csvFile("./Process_Orders/order_processing_times.csv", std::ios::trunc);
     if (!csvFile.is_open()) {
         std::cerr << "Error opening CSV file for writing." << std::endl;
@@ -38,94 +51,149 @@ void OrderPipeline::processOrdersFromFile(const std::string& filename)
     }
 
     std::string line;
+    OrderCommand command;
+    std::string_view symbol;
     while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string orderType;
-        iss >> orderType;
-
-        auto it = orderFunctions.find(orderType);
-        if (it != orderFunctions.end()) {
-            auto start = std::chrono::steady_clock::now();
-
-            (this->*(it->second))(iss);
-
-            auto end = std::chrono::steady_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-                
-            if (orderType == "AddLimit") {
-                csvFile << orderType << "," << duration.count() << "," << 0 << "," << 0 << std::endl;
-            } else {
-                csvFile << orderType << "," << duration.count() << "," << book->executedOrdersCount << "," << 0 << std::endl;
-            }
+        auto start = std::chrono::steady_clock::now();
+
+        if (!parseOrderCommand(line, command, symbol)) {
+            std::cerr << "Unknown order: " << line << std::endl;
+            continue;
+        }
+        applyOrderCommand(*book, command);
+
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+
+        // Type as written in the log (AddMarketLimit is reported separately)
+        std::string_view orderType = line;
+        if (!symbol.empty()) orderType.remove_prefix(symbol.data() + symbol.size() - line.data());
+        orderType.remove_prefix(std::min(orderType.find_first_not_of(' '), orderType.size()));
+        orderType = orderType.substr(0, orderType.find(' '));
+        if (orderType == "AddLimit") {
+            csvFile << orderType << "," << duration.count() << "," << 0 << "," << 0 << std::endl;
         } else {
-            std::cerr << "Unknown order type: " << orderType << std::endl;
+            csvFile << orderType << "," << duration.count() << "," << book->executedOrdersCount << "," << 0 << std::endl;
         }
     }
-    file.close();
     csvFile.close();
 }
 
-// All process* methods remain the same — no changes needed
-void OrderPipeline::processMarketOrder(std::istringstream& iss) {
-    int orderId, shares;
-    bool buyOrSell;
-    iss >> orderId >> buyOrSell >> shares;
-    book->marketOrder(orderId, buyOrSell, shares);
-}
-
-void OrderPipeline::processAddLimitOrder(std::istringstream& iss) {
-    int orderId, shares, limitPrice;
-    bool buyOrSell;
-    iss >> orderId >> buyOrSell >> shares >> limitPrice;
-    book->addLimitOrder(orderId, buyOrSell, shares, limitPrice);
-}
-
-void OrderPipeline::processCancelLimitOrder(std::istringstream& iss) {
-    int orderId;
-    iss >> orderId;
-    book->cancelLimitOrder(orderId);
-}
-
-void OrderPipeline::processModifyLimitOrder(std::istringstream& iss) {
-    int orderId, newShares, newLimit;
-    iss >> orderId >> newShares >> newLimit;
-    book->modifyLimitOrder(orderId, newShares, newLimit);
-}
-
-void OrderPipeline::processAddStopOrder(std::istringstream& iss) {
-    int orderId, shares, stopPrice;
-    bool buyOrSell;
-    iss >> orderId >> buyOrSell >> shares >> stopPrice;
-    book->addStopOrder(orderId, buyOrSell, shares, stopPrice);
+// Parsing and routing stay on this thread; matching runs on the shards
+void OrderPipeline::processIntoShards(std::ifstream& file)
+{
+    std::string line;
+    OrderCommand command;
+    std::string_view symbol;
+    while (std::getline(file, line)) {
+        if (!parseOrderCommand(line, command, symbol)) {
+            std::cerr << "Unknown order: " << line << std::endl;
+            continue;
+        }
+        command.symbolId = engine->internSymbol(symbol);
+        if (command.symbolId < 0) {
+            std::cerr << "Missing symbol: " << line << std::endl;
+            continue;
+        }
+        engine->submit(command);
+    }
+    engine->drain();
 }
 
-void OrderPipeline::processCancelStopOrder(std::istringstream& iss) {
-    int orderId;
-    iss >> orderId;
-    book->cancelStopOrder(orderId);
+void OrderPipeline::processIntoMatchingThread(std::ifstream& file)
+{
+    std::string line;
+    OrderCommand command;
+    std::string_view symbol;
+    while (std::getline(file, line)) {
+        if (!parseOrderCommand(line, command, symbol)) {
+            std::cerr << "Unknown order: " << line << std::endl;
+            continue;
+        }
+        matcher->submit(command);
+    }
+    matcher->drain();
 }
 
-void OrderPipeline::processModifyStopOrder(std::istringstream& iss) {
-    int orderId, newShares, newStopPrice;
-    iss >> orderId >> newShares >> newStopPrice;
-    book->modifyStopOrder(orderId, newShares, newStopPrice);
-}
+void OrderPipeline::processInParallel(std::ifstream& file)
+{
+    using Clock = std::chrono::steady_clock;
+    replayStats = ReplayStats{};
+    auto start = Clock::now();
 
-void OrderPipeline::processAddStopLimitOrder(std::istringstream& iss) {
-    int orderId, shares, limitPrice, stopPrice;
-    bool buyOrSell;
-    iss >> orderId >> buyOrSell >> shares >> limitPrice >> stopPrice;
-    book->addStopLimitOrder(orderId, buyOrSell, shares, limitPrice, stopPrice);
-}
+    // Pass 1: parse everything once, splitting the log into per-symbol streams
+    std::vector<std::vector<OrderCommand>> streams;
+    std::string line;
+    OrderCommand command;
+    std::string_view symbol;
+    while (std::getline(file, line)) {
+        ++replayStats.lines;
+        if (!parseOrderCommand(line, command, symbol)) {
+            std::cerr << "Unknown order: " << line << std::endl;
+            ++replayStats.rejectedLines;
+            continue;
+        }
+        command.symbolId = books->internSymbol(symbol);
+        if (command.symbolId < 0) {
+            std::cerr << "Missing symbol: " << line << std::endl;
+            ++replayStats.rejectedLines;
+            continue;
+        }
+        if (static_cast<size_t>(command.symbolId) >= streams.size()) streams.resize(command.symbolId + 1);
+        streams[command.symbolId].push_back(command);
+    }
 
-void OrderPipeline::processCancelStopLimitOrder(std::istringstream& iss) {
-    int orderId;
-    iss >> orderId;
-    book->cancelStopLimitOrder(orderId);
+    // Books are created here because BookManager itself is not thread safe
+    for (size_t id = 0; id < streams.size(); ++id) {
+        if (!streams[id].empty()) books->getBook(static_cast<int>(id));
+    }
+    replayStats.perSymbol.resize(streams.size());
+    auto partitioned = Clock::now();
+    replayStats.partitionSeconds = std::chrono::duration<double>(partitioned - start).count();
+
+    // Pass 2: longest streams first, so stealing only has to even out the tail
+    std::vector<size_t> order(streams.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return streams[a].size() > streams[b].size();
+    });
+    for (size_t id : order) {
+        if (streams[id].empty()) continue;
+        Book* symbolBook = books->findBook(static_cast<int>(id));
+        const std::vector<OrderCommand>* stream = &streams[id];
+        SymbolReplayStats* stats = &replayStats.perSymbol[id];
+        pool->submit([symbolBook, stream, stats] {
+            // Accumulate locally: neighbouring symbols' stats share cache lines
+            SymbolReplayStats local;
+            auto symbolStart = Clock::now();
+            for (const OrderCommand& next : *stream) {
+                try {
+                    applyOrderCommand(*symbolBook, next);
+                } catch (const std::exception&) {
+                    ++local.errors;
+                    continue;
+                }
+                for (const Fill& fill : symbolBook->getFills()) {
+                    local.sharesTraded += static_cast<uint64_t>(fill.shares);
+                }
+                local.fills += symbolBook->getFills().size();
+            }
+            local.commands = stream->size();
+            local.bestBid = symbolBook->getBestBidPrice();
+            local.bestAsk = symbolBook->getBestAskPrice();
+            local.seconds = std::chrono::duration<double>(Clock::now() - symbolStart).count();
+            *stats = local;
+        });
+    }
+    pool->wait();
+    replayStats.replaySeconds = std::chrono::duration<double>(Clock::now() - partitioned).count();
+
+    // Merge on this thread once every task is done
+    for (const SymbolReplayStats& stats : replayStats.perSymbol) {
+        replayStats.commands += stats.commands;
+        replayStats.fills += stats.fills;
+        replayStats.sharesTraded += stats.sharesTraded;
+        replayStats.errors += stats.errors;
+        replayStats.longestSymbolSeconds = std::max(replayStats.longestSymbolSeconds, stats.seconds);
+    }
 }
-
-void OrderPipeline::processModifyStopLimitOrder(std::istringstream& iss) {
-    int orderId, newShares, newLimitPrice, newStopPrice;
-    iss >> orderId >> newShares >> newLimitPrice >> newStopPrice;
-    book->modifyStopLimitOrder(orderId, newShares, newLimitPrice, newStopPrice);
-}
\ No newline at end of file
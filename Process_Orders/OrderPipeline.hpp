@@ -1,34 +1,79 @@
 #ifndef ORDERPIPELINE_HPP
 #define ORDERPIPELINE_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
-#include <unordered_map>
-#include <string_view>
-#include <sstream>
+#include <vector>
 
 class Book;
+class BookManager;
+class MatchingThread;
+class ShardedEngine;
+class WorkStealingPool;
+
+// Per-symbol results of a parallel replay
+struct SymbolReplayStats {
+    size_t commands = 0;
+    size_t fills = 0;
+    uint64_t sharesTraded = 0;
+    uint64_t errors = 0;
+    int bestBid = 0;
+    int bestAsk = 0;
+    double seconds = 0.0;  // time spent replaying this symbol
+};
+
+// Totals of a parallel replay, merged from the per-symbol stats
+struct ReplayStats {
+    size_t lines = 0;
+    size_t rejectedLines = 0;  // unparsable or without a symbol
+    size_t commands = 0;
+    size_t fills = 0;
+    uint64_t sharesTraded = 0;
+    uint64_t errors = 0;
+    double partitionSeconds = 0.0;
+    double replaySeconds = 0.0;
+    double longestSymbolSeconds = 0.0;  // lower bound on replaySeconds
+    std::vector<SymbolReplayStats> perSymbol;  // indexed by symbol id
+
+    // Wall clock throughput, partitioning included
+    double commandsPerSecond() const {
+        double seconds = partitionSeconds + replaySeconds;
+        return seconds > 0.0 ? static_cast<double>(commands) / seconds : 0.0;
+    }
+};
 
 class OrderPipeline {
 private:
-    Book* book;
-
-    using OrderFunction = void(OrderPipeline::*)(std::istringstream&);
-    std::unordered_map<std::string_view, OrderFunction> orderFunctions;
-
-    void processMarketOrder(std::istringstream& iss);
-    void processAddLimitOrder(std::istringstream& iss);
-    void processCancelLimitOrder(std::istringstream& iss);
-    void processModifyLimitOrder(std::istringstream& iss);
-    void processAddStopOrder(std::istringstream& iss);
-    void processCancelStopOrder(std::istringstream& iss);
-    void processModifyStopOrder(std::istringstream& iss);
-    void processAddStopLimitOrder(std::istringstream& iss);
-    void processCancelStopLimitOrder(std::istringstream& iss);
-    void processModifyStopLimitOrder(std::istringstream& iss);
+    Book* book = nullptr;
+    ShardedEngine* engine = nullptr;
+    MatchingThread* matcher = nullptr;
+    BookManager* books = nullptr;
+    WorkStealingPool* pool = nullptr;
+    ReplayStats replayStats;
+
+    void processIntoBook(std::ifstream& file);
+    void processIntoShards(std::ifstream& file);
+    void processIntoMatchingThread(std::ifstream& file);
+    void processInParallel(std::ifstream& file);
 
 public:
     OrderPipeline(Book* book);
+    // Parse on the calling thread and match on matcher's thread (book 0)
+    OrderPipeline(MatchingThread* matcher);
+    // Multi-instrument logs: every line starts with a symbol and is routed to
+    // that symbol's shard
+    OrderPipeline(ShardedEngine* engine);
+    // Back-testing replay of a multi-instrument log: one pass splits the log
+    // into per-symbol streams, then each symbol is replayed into its own book
+    // in books as one task on pool. Symbols are independent, so they need no
+    // ordering between them; each book is only ever touched by one task.
+    OrderPipeline(BookManager* books, WorkStealingPool* pool);
     void processOrdersFromFile(const std::string& filename);
+
+    // Results of the last parallel replay
+    const ReplayStats& getReplayStats() const { return replayStats; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,433 @@
+#include "../FIX_Protocol/FIXMessage.hpp"
+#include "../FIX_Protocol/FIXEngine.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Limit_Order_Book/BookManager.hpp"
+#include "../Limit_Order_Book/InlineStringMap.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct FIXProtocolTests: public ::testing::Test
+{
+    Book* book;
+    FIXEngine* engine;
+
+    virtual void SetUp() override{
+        book = new Book();
+        engine = new FIXEngine(book);
+    }
+
+    virtual void TearDown() override{
+        delete engine;
+        delete book;
+    }
+
+    std::string cancelOrder(const std::string& clOrdID, const std::string& origClOrdID) {
+        FIXMessage msg;
+        msg.setMsgType(FIXMessage::OrderCancelRequest);
+        msg.setField(FIXMessage::ClOrdID, clOrdID);
+        msg.setField(FIXMessage::OrigClOrdID, origClOrdID);
+        msg.setField(FIXMessage::Symbol, "AAPL");
+        return msg.encode();
+    }
+
+    std::string marketOrder(const std::string& clOrdID, char side, int qty) {
+        FIXMessage msg;
+        msg.setMsgType(FIXMessage::NewOrderSingle);
+        msg.setField(FIXMessage::ClOrdID, clOrdID);
+        msg.setField(FIXMessage::Side, side);
+        msg.setField(FIXMessage::OrderQty, qty);
+        msg.setField(FIXMessage::OrdType, FIXMessage::Market);
+        msg.setField(FIXMessage::Symbol, "AAPL");
+        return msg.encode();
+    }
+
+    // Split a response holding several reports into messages
+    std::vector<FIXMessage> splitReports(std::string_view output) {
+        std::vector<FIXMessage> reports;
+        size_t length;
+        while ((length = FIXMessage::frameLength(output)) != 0 && length != std::string::npos) {
+            reports.emplace_back(std::string(output.substr(0, length)));
+            output.remove_prefix(length);
+        }
+        return reports;
+    }
+
+    std::string limitOrder(const std::string& clOrdID, char side, int qty, double price) {
+        FIXMessage msg;
+        msg.setMsgType(FIXMessage::NewOrderSingle);
+        msg.setField(FIXMessage::ClOrdID, clOrdID);
+        msg.setField(FIXMessage::Side, side);
+        msg.setField(FIXMessage::OrderQty, qty);
+        msg.setField(FIXMessage::OrdType, FIXMessage::Limit);
+        msg.setField(FIXMessage::Price, price);
+        msg.setField(FIXMessage::Symbol, "AAPL");
+        return msg.encode();
+    }
+};
+
+// Framing tests
+TEST_F(FIXProtocolTests, TestFrameLengthOfCompleteMessage) {
+    std::string order = limitOrder("1", FIXMessage::Buy, 10, 100.0);
+    EXPECT_EQ(FIXMessage::frameLength(order), order.size());
+    EXPECT_EQ(FIXMessage::frameLength(order + limitOrder("2", FIXMessage::Sell, 5, 101.0)), order.size());
+}
+
+TEST_F(FIXProtocolTests, TestFrameLengthNeedsMoreBytes) {
+    std::string order = limitOrder("1", FIXMessage::Buy, 10, 100.0);
+    for (size_t cut = 0; cut < order.size(); ++cut) {
+        EXPECT_EQ(FIXMessage::frameLength(std::string_view(order).substr(0, cut)), 0u);
+    }
+}
+
+TEST_F(FIXProtocolTests, TestFrameLengthRejectsGarbage) {
+    EXPECT_EQ(FIXMessage::frameLength("hello world"), std::string::npos);
+    EXPECT_EQ(FIXMessage::frameLength("8=FIX.4.2\x01" "9=abc\x01"), std::string::npos);
+    EXPECT_EQ(FIXMessage::frameLength("8=FIX.4.2\x01" "9=5\x01" "35=D\x01" "XX=000\x01"), std::string::npos);
+}
+
+// Engine tests
+TEST_F(FIXProtocolTests, TestProcessDecodedMessage) {
+    FIXMessage report(engine->processMessage(FIXMessage(limitOrder("7", FIXMessage::Buy, 10, 100.0))));
+
+    EXPECT_EQ(report.getMsgType(), FIXMessage::ExecutionReport);
+    EXPECT_EQ(report.getField(FIXMessage::ClOrdID), "7");
+    EXPECT_EQ(book->getBestBidPrice(), 100);
+}
+
+// Batch processing tests
+TEST_F(FIXProtocolTests, TestBatchProcessesMessagesInOrder) {
+    std::string input = limitOrder("1", FIXMessage::Sell, 10, 101.0)
+                      + limitOrder("2", FIXMessage::Buy, 5, 99.0)
+                      + limitOrder("3", FIXMessage::Sell, 7, 102.0);
+    std::string output;
+
+    EXPECT_EQ(engine->processBatch(input, output), input.size());
+
+    std::string_view reports(output);
+    std::string ids;
+    while (!reports.empty()) {
+        size_t length = FIXMessage::frameLength(reports);
+        ASSERT_NE(length, 0u);
+        ASSERT_NE(length, std::string::npos);
+        FIXMessage report{std::string(reports.substr(0, length))};
+        ids += report.getField(FIXMessage::ClOrdID);
+        reports.remove_prefix(length);
+    }
+    EXPECT_EQ(ids, "123");
+    EXPECT_EQ(book->getBestAskPrice(), 101);
+    EXPECT_EQ(book->getBestBidPrice(), 99);
+}
+
+TEST_F(FIXProtocolTests, TestBatchLeavesPartialMessage) {
+    std::string second = limitOrder("2", FIXMessage::Buy, 5, 99.0);
+    std::string input = limitOrder("1", FIXMessage::Sell, 10, 101.0) + second.substr(0, 20);
+    std::string output;
+
+    size_t consumed = engine->processBatch(input, output);
+
+    EXPECT_EQ(consumed, input.size() - 20);
+    EXPECT_EQ(book->getBestBidPrice(), 0);
+}
+
+TEST_F(FIXProtocolTests, TestBatchRejectsUnframedInput) {
+    std::string output;
+
+    EXPECT_EQ(engine->processBatch("garbage", output), std::string::npos);
+    EXPECT_EQ(FIXMessage(output).getMsgType(), FIXMessage::Reject);
+}
+
+TEST_F(FIXProtocolTests, TestEncodeMatchesParse) {
+    FIXMessage msg;
+    msg.setMsgType(FIXMessage::NewOrderSingle);
+    msg.setField(FIXMessage::ClOrdID, "abc");
+    msg.setField(FIXMessage::Price, 12.5);
+    std::string encoded = msg.encode();
+
+    FIXMessage parsed(encoded);
+    EXPECT_EQ(parsed.getField(FIXMessage::ClOrdID), "abc");
+    EXPECT_EQ(parsed.getField(FIXMessage::Price), "12.50");
+    EXPECT_EQ(parsed.encode(), encoded);
+}
+
+// ClOrdID mapping tests
+TEST_F(FIXProtocolTests, TestInlineStringMapInsertFindErase) {
+    InlineStringMap map;
+    EXPECT_EQ(map.find("a"), nullptr);
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(map.insert("ord-" + std::to_string(i), i));
+    }
+    EXPECT_FALSE(map.insert("ord-5", 99));
+    EXPECT_FALSE(map.insert(std::string(InlineStringMap::maxKeyLength + 1, 'x'), 1));
+    EXPECT_EQ(map.size(), 1000u);
+
+    for (int i = 0; i < 1000; i += 2) {
+        EXPECT_TRUE(map.erase("ord-" + std::to_string(i)));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        const int* value = map.find("ord-" + std::to_string(i));
+        if (i % 2 == 0) {
+            EXPECT_EQ(value, nullptr);
+        } else {
+            ASSERT_NE(value, nullptr);
+            EXPECT_EQ(*value, i);
+        }
+    }
+}
+
+TEST_F(FIXProtocolTests, TestNonNumericClOrdID) {
+    FIXMessage report(engine->processMessage(limitOrder("ABC-001", FIXMessage::Buy, 10, 100.0)));
+
+    EXPECT_EQ(report.getMsgType(), FIXMessage::ExecutionReport);
+    EXPECT_EQ(report.getField(FIXMessage::ClOrdID), "ABC-001");
+    EXPECT_EQ(engine->lookupOrderID(0, "ABC-001"), report.getFieldAsInt(FIXMessage::OrderID));
+}
+
+TEST_F(FIXProtocolTests, TestSessionsDoNotCollide) {
+    engine->processMessage(limitOrder("1", FIXMessage::Buy, 10, 100.0), 0);
+    engine->processMessage(limitOrder("1", FIXMessage::Buy, 20, 99.0), 1);
+
+    int first = engine->lookupOrderID(0, "1");
+    int second = engine->lookupOrderID(1, "1");
+    EXPECT_NE(first, second);
+    EXPECT_EQ(book->searchOrderMap(first)->getShares(), 10);
+    EXPECT_EQ(book->searchOrderMap(second)->getShares(), 20);
+
+    // Cancelling on session 1 leaves session 0's order alone
+    FIXMessage report(engine->processMessage(cancelOrder("2", "1"), 1));
+    EXPECT_EQ(report.getFieldAsChar(FIXMessage::ExecType), FIXMessage::Canceled);
+    EXPECT_EQ(book->searchOrderMap(second), nullptr);
+    EXPECT_NE(book->searchOrderMap(first), nullptr);
+}
+
+TEST_F(FIXProtocolTests, TestResetSessionForgetsClosedSession) {
+    std::vector<int> routedTo;
+    engine->setReportSink([&](int sessionId, std::string_view) { routedTo.push_back(sessionId); });
+    engine->processMessage(limitOrder("1", FIXMessage::Sell, 10, 100.0), 3);
+    engine->resetSession(3);
+
+    // The id's next session starts with no ClOrdIDs of its own
+    EXPECT_EQ(engine->lookupOrderID(3, "1"), -1);
+    FIXMessage report(engine->processMessage(limitOrder("1", FIXMessage::Sell, 5, 101.0), 3));
+    EXPECT_EQ(report.getFieldAsChar(FIXMessage::ExecType), FIXMessage::New);
+
+    // The old order still trades, but its fill is not sent to the new session
+    std::vector<FIXMessage> reports = splitReports(engine->processMessage(limitOrder("B", FIXMessage::Buy, 10, 100.0), 1));
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_EQ(reports[1].getField(FIXMessage::ClOrdID), "B");
+    EXPECT_TRUE(routedTo.empty());
+    EXPECT_EQ(book->getBestAskPrice(), 101);
+}
+
+TEST_F(FIXProtocolTests, TestDuplicateAndUnknownClOrdIDRejected) {
+    engine->processMessage(limitOrder("X", FIXMessage::Buy, 10, 100.0));
+
+    EXPECT_EQ(FIXMessage(engine->processMessage(limitOrder("X", FIXMessage::Buy, 5, 100.0))).getMsgType(),
+              FIXMessage::Reject);
+    EXPECT_EQ(FIXMessage(engine->processMessage(cancelOrder("Y", "nope"))).getMsgType(),
+              FIXMessage::Reject);
+}
+
+// Fill report tests
+TEST_F(FIXProtocolTests, TestBookRecordsFills) {
+    book->addLimitOrder(1, false, 10, 100);
+    book->addLimitOrder(2, false, 10, 101);
+    book->addLimitOrder(3, true, 15, 101);
+
+    const std::vector<Fill>& fills = book->getFills();
+    ASSERT_EQ(fills.size(), 2u);
+    EXPECT_EQ(fills[0].makerId, 1);
+    EXPECT_EQ(fills[0].takerId, 3);
+    EXPECT_EQ(fills[0].price, 100);
+    EXPECT_EQ(fills[0].shares, 10);
+    EXPECT_EQ(fills[1].makerId, 2);
+    EXPECT_EQ(fills[1].price, 101);
+    EXPECT_EQ(fills[1].shares, 5);
+}
+
+TEST_F(FIXProtocolTests, TestPartialFillReportsBothSides) {
+    engine->processMessage(limitOrder("S1", FIXMessage::Sell, 10, 100.0));
+    std::vector<FIXMessage> reports = splitReports(engine->processMessage(limitOrder("B1", FIXMessage::Buy, 4, 100.0)));
+
+    ASSERT_EQ(reports.size(), 3u);
+    EXPECT_EQ(reports[0].getFieldAsChar(FIXMessage::ExecType), FIXMessage::New);
+
+    EXPECT_EQ(reports[1].getField(FIXMessage::ClOrdID), "B1");
+    EXPECT_EQ(reports[1].getFieldAsChar(FIXMessage::ExecType), FIXMessage::Fill);
+    EXPECT_EQ(reports[1].getFieldAsInt(FIXMessage::LastShares), 4);
+    EXPECT_DOUBLE_EQ(reports[1].getFieldAsDouble(FIXMessage::LastPx), 100.0);
+    EXPECT_EQ(reports[1].getFieldAsInt(FIXMessage::LeavesQty), 0);
+
+    EXPECT_EQ(reports[2].getField(FIXMessage::ClOrdID), "S1");
+    EXPECT_EQ(reports[2].getFieldAsChar(FIXMessage::ExecType), FIXMessage::PartialFill);
+    EXPECT_EQ(reports[2].getFieldAsInt(FIXMessage::CumQty), 4);
+    EXPECT_EQ(reports[2].getFieldAsInt(FIXMessage::LeavesQty), 6);
+}
+
+TEST_F(FIXProtocolTests, TestMarketRemainderCanceled) {
+    engine->processMessage(limitOrder("S1", FIXMessage::Sell, 10, 100.0));
+    engine->processMessage(limitOrder("S2", FIXMessage::Sell, 10, 102.0));
+    std::vector<FIXMessage> reports = splitReports(engine->processMessage(marketOrder("M1", FIXMessage::Buy, 25)));
+
+    // New, two taker/maker fill pairs, then the unfilled 5 shares
+    ASSERT_EQ(reports.size(), 6u);
+    EXPECT_EQ(reports[3].getFieldAsChar(FIXMessage::ExecType), FIXMessage::PartialFill);
+    EXPECT_EQ(reports[3].getFieldAsInt(FIXMessage::CumQty), 20);
+    EXPECT_DOUBLE_EQ(reports[3].getFieldAsDouble(FIXMessage::AvgPx), 101.0);
+
+    const FIXMessage& remainder = reports[5];
+    EXPECT_EQ(remainder.getField(FIXMessage::ClOrdID), "M1");
+    EXPECT_EQ(remainder.getFieldAsChar(FIXMessage::ExecType), FIXMessage::Canceled);
+    EXPECT_EQ(remainder.getFieldAsInt(FIXMessage::CumQty), 20);
+    EXPECT_EQ(remainder.getFieldAsInt(FIXMessage::LeavesQty), 0);
+}
+
+TEST_F(FIXProtocolTests, TestMakerReportRoutedToOwningSession) {
+    std::vector<std::pair<int, std::string>> routed;
+    engine->setReportSink([&](int sessionId, std::string_view report) {
+        routed.emplace_back(sessionId, std::string(report));
+    });
+
+    engine->processMessage(limitOrder("S1", FIXMessage::Sell, 10, 100.0), 3);
+    std::vector<FIXMessage> reports = splitReports(engine->processMessage(limitOrder("B1", FIXMessage::Buy, 10, 100.0), 1));
+
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_EQ(reports[1].getField(FIXMessage::ClOrdID), "B1");
+
+    ASSERT_EQ(routed.size(), 1u);
+    EXPECT_EQ(routed[0].first, 3);
+    FIXMessage maker(routed[0].second);
+    EXPECT_EQ(maker.getField(FIXMessage::ClOrdID), "S1");
+    EXPECT_EQ(maker.getFieldAsChar(FIXMessage::ExecType), FIXMessage::Fill);
+}
+
+// Hardened decoding tests
+TEST_F(FIXProtocolTests, TestMalformedNumbersReadAsZero) {
+    FIXMessage msg;
+    msg.setField(FIXMessage::OrderQty, std::string_view("12abc"));
+    msg.setField(FIXMessage::Price, std::string_view("nan"));
+    msg.setField(FIXMessage::StopPx, std::string_view("1e999"));
+    msg.setField(FIXMessage::MsgSeqNum, std::string_view("99999999999"));
+
+    EXPECT_EQ(msg.getFieldAsInt(FIXMessage::OrderQty), 0);
+    EXPECT_EQ(msg.getFieldAsDouble(FIXMessage::Price), 0.0);
+    EXPECT_EQ(msg.getFieldAsDouble(FIXMessage::StopPx), 0.0);
+    EXPECT_EQ(msg.getFieldAsInt(FIXMessage::MsgSeqNum), 0);
+    EXPECT_FALSE(msg.parse("-5=x\x01"));
+}
+
+TEST_F(FIXProtocolTests, TestOutOfRangePriceRejected) {
+    FIXMessage order(limitOrder("1", FIXMessage::Buy, 10, 100.0));
+    order.setField(FIXMessage::Price, std::string_view("5000000000"));
+
+    EXPECT_EQ(FIXMessage(engine->processMessage(order.encode())).getMsgType(), FIXMessage::Reject);
+    EXPECT_EQ(book->getBestBidPrice(), 0);
+}
+
+// Multi-instrument tests
+TEST_F(FIXProtocolTests, TestBookManagerCreatesBooksLazily) {
+    BookManager manager;
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(manager.internSymbol("SYM" + std::to_string(i)), i);
+    }
+    EXPECT_EQ(manager.internSymbol("SYM42"), 42);
+    EXPECT_EQ(manager.findSymbol("NOPE"), -1);
+    EXPECT_EQ(manager.internSymbol(""), -1);
+    EXPECT_EQ(manager.getSymbol(7), "SYM7");
+
+    EXPECT_EQ(manager.getActiveBookCount(), 0u);
+    EXPECT_EQ(manager.findBook(42), nullptr);
+    Book* book = manager.getBook(42);
+    EXPECT_EQ(manager.getBook(42), book);
+    EXPECT_EQ(manager.findBook(42), book);
+    EXPECT_EQ(manager.getActiveBookCount(), 1u);
+}
+
+TEST_F(FIXProtocolTests, TestSymbolsTradeOnSeparateBooks) {
+    BookManager manager;
+    FIXEngine multi(&manager);
+
+    FIXMessage msft(limitOrder("S1", FIXMessage::Sell, 10, 100.0));
+    msft.setField(FIXMessage::Symbol, "MSFT");
+    multi.processMessage(msft.encode());
+
+    // Crosses MSFT's price but trades AAPL, so nothing fills
+    std::vector<FIXMessage> reports = splitReports(multi.processMessage(limitOrder("B1", FIXMessage::Buy, 10, 100.0)));
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].getFieldAsChar(FIXMessage::ExecType), FIXMessage::New);
+
+    Book* aapl = manager.findBook(manager.findSymbol("AAPL"));
+    Book* msftBook = manager.findBook(manager.findSymbol("MSFT"));
+    ASSERT_NE(aapl, nullptr);
+    ASSERT_NE(msftBook, nullptr);
+    EXPECT_EQ(aapl->getBestBidPrice(), 100);
+    EXPECT_EQ(msftBook->getBestAskPrice(), 100);
+
+    // Each book numbers its own orders, and reports keep the order's symbol
+    EXPECT_NE(aapl->searchOrderMap(1), nullptr);
+    EXPECT_NE(msftBook->searchOrderMap(1), nullptr);
+    FIXMessage cancel(multi.processMessage(cancelOrder("C1", "S1")));
+    EXPECT_EQ(cancel.getFieldAsChar(FIXMessage::ExecType), FIXMessage::Canceled);
+    EXPECT_EQ(cancel.getField(FIXMessage::Symbol), "MSFT");
+    EXPECT_EQ(msftBook->getBestAskPrice(), 0);
+    EXPECT_EQ(aapl->getBestBidPrice(), 100);
+}
+
+TEST_F(FIXProtocolTests, TestMissingSymbolRejected) {
+    BookManager manager;
+    FIXEngine multi(&manager);
+    FIXMessage order(limitOrder("1", FIXMessage::Buy, 10, 100.0));
+    order.setField(FIXMessage::Symbol, std::string_view(""));
+
+    EXPECT_EQ(FIXMessage(multi.processMessage(order.encode())).getMsgType(), FIXMessage::Reject);
+    EXPECT_EQ(manager.getSymbolCount(), 0u);
+}
+
+TEST_F(FIXProtocolTests, TestSingleBookTakesOrdersWithoutSymbol) {
+    FIXMessage order(limitOrder("1", FIXMessage::Buy, 10, 100.0));
+    order.setField(FIXMessage::Symbol, std::string_view(""));
+    FIXMessage report(engine->processMessage(order.encode()));
+    EXPECT_EQ(report.getMsgType(), FIXMessage::ExecutionReport);
+    EXPECT_EQ(report.getField(FIXMessage::Symbol), "");
+    EXPECT_EQ(book->getBestBidPrice(), 100);
+
+    // Named and unnamed orders share the one book
+    FIXMessage cancel(engine->processMessage(cancelOrder("2", "1")));
+    EXPECT_EQ(cancel.getFieldAsChar(FIXMessage::ExecType), FIXMessage::Canceled);
+    EXPECT_EQ(book->getBestBidPrice(), 0);
+}
+
+TEST_F(FIXProtocolTests, TestReplaceTriggeredStopLimitMovesRestingOrder) {
+    FIXMessage stopLimit(limitOrder("1", FIXMessage::Buy, 10, 100.0));
+    stopLimit.setField(FIXMessage::OrdType, FIXMessage::StopLimit);
+    stopLimit.setField(FIXMessage::StopPx, 101.0);
+    engine->processMessage(stopLimit.encode());
+
+    // A trade leaves 101 offered, which triggers it; its limit of 100 does
+    // not cross, so it rests as a bid
+    engine->processMessage(limitOrder("2", FIXMessage::Sell, 10, 101.0));
+    engine->processMessage(limitOrder("3", FIXMessage::Buy, 5, 101.0));
+    ASSERT_EQ(book->getBestBidPrice(), 100);
+    EXPECT_TRUE(book->getStopBuyLimits().empty());
+
+    FIXMessage replace;
+    replace.setMsgType(FIXMessage::OrderCancelReplaceRequest);
+    replace.setField(FIXMessage::ClOrdID, "4");
+    replace.setField(FIXMessage::OrigClOrdID, "1");
+    replace.setField(FIXMessage::Side, FIXMessage::Buy);
+    replace.setField(FIXMessage::OrderQty, 7);
+    replace.setField(FIXMessage::Price, 99.0);
+    replace.setField(FIXMessage::Symbol, "AAPL");
+    FIXMessage report(engine->processMessage(replace.encode()));
+    EXPECT_EQ(report.getFieldAsChar(FIXMessage::ExecType), FIXMessage::Replaced);
+
+    // Still a visible bid, not sent back to the stop ladder
+    EXPECT_EQ(book->getBestBidPrice(), 99);
+    EXPECT_TRUE(book->getStopBuyLimits().empty());
+    ASSERT_EQ(book->getBuyLimits().size(), 1u);
+    EXPECT_EQ(book->getBuyLimits()[0]->getTotalVolume(), 7);
+}
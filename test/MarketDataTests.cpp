@@ -0,0 +1,739 @@
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Market_Data/BBOTicker.hpp"
+#include "../Market_Data/DepthCodec.hpp"
+#include "../Market_Data/L2Feed.hpp"
+#include "../Market_Data/L3Feed.hpp"
+#include "../Market_Data/L3FeedHandler.hpp"
+#include "../Market_Data/TradeTape.hpp"
+#include "../Matching_Engine/DepthSnapshot.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+    // Mixed flow on one book: limits in overlapping bands, cancels, modifies,
+    // market orders and the odd stop
+    std::vector<OrderCommand> randomFlow(int count, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> percent(0, 99);
+        std::uniform_int_distribution<> offset(0, 14);
+        std::uniform_int_distribution<> shares(1, 60);
+        std::vector<OrderCommand> flow;
+        for (int n = 0; n < count; ++n) {
+            OrderCommand command;
+            command.orderId = n + 1;
+            command.buyOrSell = percent(gen) < 50;
+            command.shares = shares(gen);
+            command.limitPrice = command.buyOrSell ? 90 + offset(gen) : 96 + offset(gen);
+            int roll = percent(gen);
+            if (roll < 55) {
+                command.type = OrderCommand::AddLimit;
+            } else if (roll < 75 && n > 0) {
+                command.type = OrderCommand::CancelLimit;
+                command.orderId = std::uniform_int_distribution<>(1, n)(gen);
+            } else if (roll < 85 && n > 0) {
+                command.type = OrderCommand::ModifyLimit;
+                command.orderId = std::uniform_int_distribution<>(1, n)(gen);
+            } else if (roll < 95) {
+                command.type = OrderCommand::Market;
+            } else {
+                command.type = OrderCommand::AddStop;
+                command.stopPrice = command.buyOrSell ? 106 : 94;
+            }
+            flow.push_back(command);
+        }
+        return flow;
+    }
+
+    // Price -> (volume, order count) per side, as a feed consumer keeps it
+    using Ladder = std::map<int, std::pair<int, int>>;
+
+    bool ladderMatches(const Ladder& ladder, const std::vector<Limit*>& limits) {
+        if (ladder.size() != limits.size()) return false;
+        for (const Limit* limit : limits) {
+            auto it = ladder.find(limit->getLimitPrice());
+            if (it == ladder.end() || it->second != std::make_pair(limit->getTotalVolume(), limit->getSize())) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST(MarketDataTests, TestL2FeedSendsOneUpdatePerSweptLevel) {
+    Book book;
+    L2FeedBuilder feed(book);
+    int id = 1;
+    for (int price = 101; price <= 120; ++price) {
+        book.addLimitOrder(id++, false, 10, price);
+        book.addLimitOrder(id++, false, 5, price);
+    }
+    book.addLimitOrder(id++, true, 10, 95);
+
+    // Sweep all 20 ask levels and rest the remainder as a new bid level
+    book.addLimitOrder(id++, true, 320, 120);
+    const std::vector<LevelUpdate>& updates = feed.onEvent();
+    ASSERT_EQ(updates.size(), 21u);
+    EXPECT_EQ(updates[0], (LevelUpdate{true, 120, 20, 1}));
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(updates[i + 1], (LevelUpdate{false, 101 + i, 0, 0}));
+    }
+    EXPECT_EQ(feed.getSequence(), 1u);
+
+    // Partial fill of the new bid level only
+    book.marketOrder(id++, false, 5);
+    ASSERT_EQ(feed.onEvent().size(), 1u);
+    EXPECT_EQ(feed.getUpdates()[0], (LevelUpdate{true, 120, 15, 1}));
+
+    // Cancelling a resting stop changes no visible level
+    book.addStopOrder(id, true, 10, 130);
+    EXPECT_TRUE(feed.onEvent().empty());
+    book.cancelStopOrder(id);
+    EXPECT_TRUE(feed.onEvent().empty());
+    EXPECT_EQ(feed.getSequence(), 2u);
+    EXPECT_EQ(feed.getUpdateCount(), 22u);
+}
+
+TEST(MarketDataTests, TestL2FeedRebuildsLaddersAlongsideDepthSnapshots) {
+    Book book;
+    // The snapshot publisher clears the book's touched levels on every
+    // publication; the feed must not depend on them
+    DepthSnapshotPublisher snapshots(book, 3);
+    L2FeedBuilder feed(book);
+
+    Ladder bids;
+    Ladder asks;
+    for (const OrderCommand& command : randomFlow(5000, 7)) {
+        try {
+            applyOrderCommand(book, command);
+        } catch (const std::exception&) {}
+        snapshots.onEvent();
+
+        std::set<std::pair<bool, int>> seen;
+        for (const LevelUpdate& update : feed.onEvent()) {
+            ASSERT_TRUE(seen.insert({update.buySide, update.price}).second) << "level sent twice in one message";
+            Ladder& ladder = update.buySide ? bids : asks;
+            if (update.volume == 0) {
+                ladder.erase(update.price);
+            } else {
+                ladder[update.price] = {update.volume, update.orderCount};
+            }
+        }
+        ASSERT_TRUE(ladderMatches(bids, book.getBuyLimits()));
+        ASSERT_TRUE(ladderMatches(asks, book.getSellLimits()));
+    }
+    EXPECT_GT(feed.getSequence(), 1000u);
+}
+
+namespace {
+    // Orders rebuilt from an L3 stream: per price level, the queue in time
+    // priority, as a downstream consumer would keep it
+    struct L3Mirror {
+        struct Resting {
+            bool buySide;
+            int price;
+            int shares;
+        };
+        std::unordered_map<int, Resting> orders;
+        std::map<std::pair<bool, int>, std::list<int>> queues;
+        uint64_t lastSequence = 0;
+
+        void remove(int orderId) {
+            const Resting& order = orders.at(orderId);
+            auto queue = queues.find({order.buySide, order.price});
+            queue->second.remove(orderId);
+            if (queue->second.empty()) queues.erase(queue);
+            orders.erase(orderId);
+        }
+
+        void apply(const L3Message& message) {
+            switch (message.type) {
+                case L3Message::Add:
+                    orders[message.orderId] = Resting{message.buySide, message.price, message.shares};
+                    queues[{message.buySide, message.price}].push_back(message.orderId);
+                    break;
+                case L3Message::Execute: {
+                    Resting& order = orders.at(message.orderId);
+                    ASSERT_EQ(order.price, message.price);
+                    order.shares -= message.shares;
+                    if (order.shares == 0) remove(message.orderId);
+                    break;
+                }
+                case L3Message::Delete:
+                    remove(message.orderId);
+                    break;
+                case L3Message::Replace: {
+                    bool buySide = orders.at(message.orderId).buySide;
+                    remove(message.orderId);
+                    orders[message.orderId] = Resting{buySide, message.price, message.shares};
+                    queues[{buySide, message.price}].push_back(message.orderId);
+                    break;
+                }
+            }
+        }
+
+        // Read every length-prefixed record in stream
+        void applyStream(std::string_view stream) {
+            size_t offset = 0;
+            while (offset < stream.size()) {
+                ASSERT_LE(offset + 2, stream.size());
+                size_t length = (static_cast<unsigned char>(stream[offset]) << 8) | static_cast<unsigned char>(stream[offset + 1]);
+                L3Message message;
+                ASSERT_TRUE(message.decode(stream.substr(offset + 2, length)));
+                ASSERT_EQ(message.sequence, lastSequence + 1);
+                lastSequence = message.sequence;
+                apply(message);
+                offset += 2 + length;
+            }
+        }
+
+        bool sideMatches(bool buySide, const std::vector<Limit*>& limits) const {
+            size_t levels = 0;
+            for (const auto& [key, queue] : queues) levels += key.first == buySide ? 1 : 0;
+            if (levels != limits.size()) return false;
+            for (const Limit* limit : limits) {
+                auto queue = queues.find({buySide, limit->getLimitPrice()});
+                if (queue == queues.end()) return false;
+                auto id = queue->second.begin();
+                for (const Order* order = limit->getHeadOrder(); order; order = order->nextOrder, ++id) {
+                    if (id == queue->second.end() || *id != order->getOrderId()) return false;
+                    if (orders.at(*id).shares != order->getShares()) return false;
+                }
+                if (id != queue->second.end()) return false;
+            }
+            return true;
+        }
+    };
+}
+
+TEST(MarketDataTests, TestL3RecordsRoundTrip) {
+    L3Message add;
+    add.type = L3Message::Add;
+    add.locate = 7;
+    add.sequence = 0x0102030405060708ULL;
+    add.timestamp = 1700000000123456789ULL;
+    add.orderId = 123456;
+    add.buySide = true;
+    add.shares = 300;
+    add.price = 10150;
+    L3Message execute = add;
+    execute.type = L3Message::Execute;
+    execute.buySide = false;
+    execute.takerId = 99;
+    L3Message remove = add;
+    remove.type = L3Message::Delete;
+    remove.buySide = false;
+    remove.shares = 0;
+    remove.price = 0;
+    L3Message replace = remove;
+    replace.type = L3Message::Replace;
+    replace.shares = 50;
+    replace.price = 10149;
+
+    for (const L3Message& message : {add, execute, remove, replace}) {
+        char record[L3Message::maxLength];
+        size_t length = message.encode(record);
+        EXPECT_EQ(length, L3Message::length(message.type));
+        EXPECT_EQ(record[0], message.type);
+
+        L3Message decoded;
+        ASSERT_TRUE(decoded.decode(std::string_view(record, length)));
+        EXPECT_EQ(decoded.locate, message.locate);
+        EXPECT_EQ(decoded.sequence, message.sequence);
+        EXPECT_EQ(decoded.timestamp, message.timestamp);
+        EXPECT_EQ(decoded.orderId, message.orderId);
+        EXPECT_EQ(decoded.buySide, message.buySide);
+        EXPECT_EQ(decoded.shares, message.shares);
+        EXPECT_EQ(decoded.price, message.price);
+        EXPECT_EQ(decoded.takerId, message.takerId);
+        EXPECT_FALSE(decoded.decode(std::string_view(record, length - 1)));
+    }
+    // Big-endian, as ITCH
+    char record[L3Message::maxLength];
+    add.encode(record);
+    EXPECT_EQ(record[3], 0x01);
+    EXPECT_EQ(record[10], 0x08);
+}
+
+TEST(MarketDataTests, TestL3StreamRebuildsOrdersInTimePriority) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lob_l3_test.itch";
+    uint64_t records = 0;
+    {
+        Book book;
+        L3FileSink file(path.string().c_str());
+        ASSERT_TRUE(file.isOpen());
+        // Flushed by hand below, so every record is seen before it leaves
+        L3FeedBuilder feed(book, 3, &file, SIZE_MAX);
+
+        L3Mirror mirror;
+        size_t consumed = 0;
+        uint64_t timestamp = 1000;
+        for (const OrderCommand& command : randomFlow(5000, 11)) {
+            try {
+                applyOrderCommand(book, command);
+            } catch (const std::exception&) {}
+            feed.onEvent(++timestamp);
+
+            const std::string& output = feed.getOutput();
+            mirror.applyStream(std::string_view(output).substr(consumed));
+            consumed = output.size();
+            if (consumed >= 4096) {
+                ASSERT_TRUE(feed.flush());
+                consumed = 0;
+            }
+            ASSERT_TRUE(mirror.sideMatches(true, book.getBuyLimits()));
+            ASSERT_TRUE(mirror.sideMatches(false, book.getSellLimits()));
+        }
+        records = feed.getSequence();
+        EXPECT_GT(records, 3000u);
+    }
+
+    // The file holds the whole stream, every record stamped by its message
+    std::ifstream in(path, std::ios::binary);
+    std::string stream((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    L3Mirror fromFile;
+    fromFile.applyStream(stream);
+    EXPECT_EQ(fromFile.lastSequence, records);
+    std::filesystem::remove(path);
+}
+
+TEST(MarketDataTests, TestL3MulticastSinkDeliversOnLoopback) {
+    const char* group = "239.255.42.99";
+    const uint16_t port = 31999;
+
+    int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(receiver, 0);
+    int reuse = 1;
+    setsockopt(receiver, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    ip_mreq membership{};
+    inet_pton(AF_INET, group, &membership.imr_multiaddr);
+    inet_pton(AF_INET, "127.0.0.1", &membership.imr_interface);
+    timeval timeout{1, 0};
+    setsockopt(receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (bind(receiver, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0
+        || setsockopt(receiver, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+        close(receiver);
+        GTEST_SKIP() << "multicast on loopback is not available here";
+    }
+
+    L3MulticastSink sink(group, port);
+    ASSERT_TRUE(sink.isOpen());
+    Book book;
+    L3FeedBuilder feed(book, 1, &sink);
+    // Enough records for several packets: 200 adds, then one sweep
+    for (int i = 1; i <= 200; ++i) {
+        book.addLimitOrder(i, false, 10, 100 + i % 20);
+        feed.onEvent();
+    }
+    book.marketOrder(201, true, 2000);
+    feed.onEvent();
+    ASSERT_TRUE(feed.flush());
+    EXPECT_GT(sink.getPacketsSent(), 1u);
+
+    L3Mirror mirror;
+    char packet[L3MulticastSink::maxPacketLength];
+    while (mirror.lastSequence < feed.getSequence()) {
+        ssize_t received = recv(receiver, packet, sizeof(packet), 0);
+        if (received <= 0) {
+            close(receiver);
+            GTEST_SKIP() << "multicast datagrams were not looped back";
+        }
+        ASSERT_GE(static_cast<size_t>(received), L3MulticastSink::packetHeaderLength);
+        EXPECT_EQ(std::string_view(packet, 3), "LOB");
+        mirror.applyStream(std::string_view(packet + L3MulticastSink::packetHeaderLength,
+                                            received - L3MulticastSink::packetHeaderLength));
+    }
+    close(receiver);
+    EXPECT_EQ(mirror.lastSequence, 400u);
+    EXPECT_TRUE(mirror.orders.empty());
+}
+
+TEST(MarketDataTests, TestBBOTickerConflatesPerConsumerInterval) {
+    Book book;
+    BBOTicker ticker(book);
+    BBOTicker::Consumer& every = ticker.subscribe(std::chrono::microseconds(0));
+    BBOTicker::Consumer& throttled = ticker.subscribe(std::chrono::microseconds(100));
+
+    // One order call every 10us
+    std::vector<OrderCommand> flow = randomFlow(20000, 11);
+    uint64_t now = 0;
+    uint64_t lastThrottled = 0;
+    TopOfBook quote;
+    for (const OrderCommand& command : flow) {
+        try {
+            applyOrderCommand(book, command);
+        } catch (const std::exception&) {}
+        now += 10000;
+        uint64_t changes = ticker.getChangeCount();
+        ticker.onEvent(now);
+
+        TopOfBook expected;
+        if (!book.getBuyLimits().empty()) {
+            const Limit* bid = book.getBuyLimits().front();
+            expected.bidPrice = bid->getLimitPrice();
+            expected.bidVolume = bid->getTotalVolume();
+            expected.bidOrders = bid->getSize();
+        }
+        if (!book.getSellLimits().empty()) {
+            const Limit* ask = book.getSellLimits().front();
+            expected.askPrice = ask->getLimitPrice();
+            expected.askVolume = ask->getTotalVolume();
+            expected.askOrders = ask->getSize();
+        }
+        ASSERT_TRUE(ticker.getQuote().sameQuote(expected));
+
+        // The unthrottled consumer sees every change, and only changes
+        if (ticker.getChangeCount() != changes) {
+            ASSERT_TRUE(every.poll(quote));
+            ASSERT_EQ(quote.sequence, ticker.getChangeCount());
+        } else {
+            ASSERT_FALSE(every.poll(quote));
+        }
+        ASSERT_EQ(every.getConflatedCount(), 0u);
+        if (throttled.poll(quote)) {
+            ASSERT_GE(quote.timestamp, lastThrottled);
+            lastThrottled = quote.timestamp;
+        }
+    }
+    EXPECT_GT(ticker.getChangeCount(), 5000u);
+    EXPECT_EQ(every.getPublishCount(), ticker.getChangeCount());
+    EXPECT_EQ(every.getConflatedCount(), 0u);
+
+    // At most one quote per 100us, none of them stale for longer than that
+    EXPECT_LE(throttled.getPublishCount(), now / 100000 + 1);
+    EXPECT_GT(throttled.getPublishCount(), now / 100000 / 2);
+    ticker.publishDue(now + 100000);
+    throttled.poll(quote);
+    EXPECT_EQ(quote.sequence, ticker.getChangeCount());
+    EXPECT_TRUE(quote.sameQuote(ticker.getQuote()));
+    EXPECT_EQ(throttled.getConflatedCount() + throttled.getPublishCount(), ticker.getChangeCount());
+}
+
+TEST(MarketDataTests, TestBBOTickerNeverWaitsForSlowConsumer) {
+    Book book;
+    BBOTicker ticker(book);
+    BBOTicker::Consumer& fast = ticker.subscribe(std::chrono::microseconds(0));
+    BBOTicker::Consumer& slow = ticker.subscribe(std::chrono::microseconds(50));
+    std::vector<OrderCommand> flow = randomFlow(100000, 12);
+
+    std::atomic<bool> matching{true};
+    std::atomic<uint64_t> errors{0};
+    auto consume = [&](BBOTicker::Consumer& consumer, std::chrono::microseconds pause) {
+        TopOfBook quote;
+        uint64_t last = 0;
+        while (matching.load()) {
+            if (consumer.poll(quote)) {
+                if (quote.sequence <= last) errors.fetch_add(1);
+                last = quote.sequence;
+            }
+            std::this_thread::sleep_for(pause);
+        }
+    };
+    std::thread fastReader(consume, std::ref(fast), std::chrono::microseconds(0));
+    std::thread slowReader(consume, std::ref(slow), std::chrono::microseconds(2000));
+
+    for (const OrderCommand& command : flow) {
+        try {
+            applyOrderCommand(book, command);
+        } catch (const std::exception&) {}
+        ticker.onEvent();
+    }
+    ticker.publishDue(UINT64_MAX);
+    matching.store(false);
+    fastReader.join();
+    slowReader.join();
+
+    EXPECT_EQ(errors.load(), 0u);
+    EXPECT_EQ(fast.getPublishCount(), ticker.getChangeCount());
+    EXPECT_LT(slow.getPublishCount(), ticker.getChangeCount());
+    // The final quote reached both slots
+    EXPECT_EQ(fast.read().sequence, ticker.getChangeCount());
+    EXPECT_EQ(slow.read().sequence, ticker.getChangeCount());
+    EXPECT_GT(slow.getConflatedCount(), 0u);
+}
+
+TEST(MarketDataTests, TestL3FeedHandlerRebuildsBookInLockstep) {
+    Book source;
+    Book rebuilt;
+    L3FeedBuilder feed(source, 5, nullptr, SIZE_MAX);
+    L3FeedHandler handler(rebuilt, 5);
+
+    // Includes stops that trigger and stops made visible by a modify
+    std::vector<OrderCommand> flow = randomFlow(20000, 21);
+    for (size_t n = 0; n < flow.size(); ++n) {
+        try {
+            applyOrderCommand(source, flow[n]);
+        } catch (const std::exception&) {}
+        feed.onEvent();
+        ASSERT_EQ(handler.onData(feed.getOutput()), feed.getOutput().size());
+        feed.clearOutput();
+        ASSERT_EQ(compareBooks(source, rebuilt), "") << "after command " << n;
+    }
+    EXPECT_EQ(handler.getSequence(), feed.getSequence());
+    EXPECT_EQ(handler.getErrorCount(), 0u);
+    EXPECT_EQ(handler.getGapCount(), 0u);
+    EXPECT_FALSE(rebuilt.getBuyLimits().empty());
+
+    // A rebuilt book that drifts is caught
+    const Order* front = rebuilt.getSellLimits().front()->getHeadOrder();
+    rebuilt.cancelLimitOrder(front->getOrderId());
+    EXPECT_NE(compareBooks(source, rebuilt), "");
+}
+
+TEST(MarketDataTests, TestL3FeedHandlerHandlesSplitDuplicateAndMissingRecords) {
+    Book source;
+    L3FeedBuilder feed(source, 1, nullptr, SIZE_MAX);
+    // Records for another symbol on the same stream are ignored
+    Book other;
+    L3FeedBuilder otherFeed(other, 2, nullptr, SIZE_MAX);
+    for (const OrderCommand& command : randomFlow(5000, 22)) {
+        try {
+            applyOrderCommand(source, command);
+            applyOrderCommand(other, command);
+        } catch (const std::exception&) {}
+        feed.onEvent(1);
+        otherFeed.onEvent(1);
+    }
+    const std::string& stream = feed.getOutput();
+
+    // Arbitrary chunks, each possibly ending inside a record, with the odd
+    // chunk delivered twice
+    Book rebuilt;
+    L3FeedHandler handler(rebuilt, 1);
+    std::mt19937 gen(23);
+    std::string pending;
+    size_t offset = 0;
+    while (offset < stream.size()) {
+        size_t length = std::min<size_t>(std::uniform_int_distribution<size_t>(1, 300)(gen), stream.size() - offset);
+        std::string chunk = stream.substr(offset, length);
+        offset += length;
+        pending += chunk;
+        size_t used = handler.onData(pending);
+        if (used > 0 && gen() % 8 == 0) handler.onData(std::string_view(pending).substr(0, used));
+        pending.erase(0, used);
+    }
+    EXPECT_TRUE(pending.empty());
+    handler.onData(otherFeed.getOutput());
+    EXPECT_EQ(compareBooks(source, rebuilt), "");
+    EXPECT_GT(handler.getDuplicateCount(), 0u);
+    EXPECT_EQ(handler.getMessageCount(), feed.getSequence());
+    EXPECT_EQ(handler.getErrorCount(), 0u);
+
+    // A record lost in transit shows up as a gap
+    Book lossy;
+    L3FeedHandler lossyHandler(lossy, 1);
+    size_t first = 2 + L3Message::length(stream[2]);
+    lossyHandler.onData(std::string_view(stream).substr(0, first));
+    size_t second = 2 + L3Message::length(stream[first + 2]);
+    lossyHandler.onData(std::string_view(stream).substr(first + second));
+    EXPECT_EQ(lossyHandler.getGapCount(), 1u);
+    EXPECT_EQ(lossyHandler.getMessageCount(), feed.getSequence() - 1);
+}
+
+TEST(MarketDataTests, TestDepthSnapshotRoundTripsEveryLevel) {
+    Book book;
+    std::string image;
+    DepthSnapshot decoded;
+    std::vector<OrderCommand> flow = randomFlow(5000, 31);
+    for (size_t n = 0; n < flow.size(); ++n) {
+        try {
+            applyOrderCommand(book, flow[n]);
+        } catch (const std::exception&) {}
+        if (n % 50 != 0) continue;
+
+        image.clear();
+        encodeDepthSnapshot(book, n, image);
+        ASSERT_TRUE(decodeDepthSnapshot(image, decoded));
+        EXPECT_EQ(decoded.version, n);
+        ASSERT_EQ(decoded.bids.size(), book.getBuyLimits().size());
+        ASSERT_EQ(decoded.asks.size(), book.getSellLimits().size());
+        Ladder bids;
+        Ladder asks;
+        for (const DepthLevel& level : decoded.bids) bids[level.price] = {level.volume, level.orderCount};
+        for (const DepthLevel& level : decoded.asks) asks[level.price] = {level.volume, level.orderCount};
+        ASSERT_TRUE(ladderMatches(bids, book.getBuyLimits()));
+        ASSERT_TRUE(ladderMatches(asks, book.getSellLimits()));
+
+        // A published snapshot encodes to the same bytes
+        DepthSnapshot copy;
+        copy.bids = decoded.bids;
+        copy.asks = decoded.asks;
+        std::string again;
+        encodeDepthSnapshot(copy, n, again);
+        EXPECT_EQ(again, image);
+    }
+
+    // Negative and far apart prices survive, and nothing truncated decodes
+    Book wide;
+    wide.addLimitOrder(1, true, 5, -20);
+    wide.addLimitOrder(2, true, 7, -3000000);
+    wide.addLimitOrder(3, false, 1000000, 2000000000);
+    image.clear();
+    encodeDepthSnapshot(wide, UINT64_MAX, image);
+    ASSERT_TRUE(decodeDepthSnapshot(image, decoded));
+    EXPECT_EQ(decoded.version, UINT64_MAX);
+    ASSERT_EQ(decoded.bids.size(), 2u);
+    EXPECT_EQ(decoded.bids[1].price, -3000000);
+    EXPECT_EQ(decoded.asks[0].price, 2000000000);
+    EXPECT_EQ(decoded.asks[0].volume, 1000000);
+    for (size_t length = 0; length < image.size(); ++length) {
+        EXPECT_FALSE(decodeDepthSnapshot(std::string_view(image).substr(0, length), decoded)) << length;
+    }
+}
+
+TEST(MarketDataTests, TestDepthSnapshotOfDenseBookIsAFewBytesPerLevel) {
+    // 1000 levels a side, one tick apart, a few orders each
+    Book book;
+    int orderId = 1;
+    for (int level = 0; level < 1000; ++level) {
+        for (int n = 0; n <= level % 3; ++n) {
+            book.addLimitOrder(orderId++, true, 100 + level % 7, 10000 - level);
+            book.addLimitOrder(orderId++, false, 100 + level % 5, 10001 + level);
+        }
+    }
+    std::string image;
+    size_t bytes = encodeDepthSnapshot(book, 1, image);
+    // One byte of price, two of volume and one of count per level
+    EXPECT_LE(bytes, 2000u * 4 + 16);
+
+    DepthSnapshot decoded;
+    ASSERT_TRUE(decodeDepthSnapshot(image, decoded));
+    ASSERT_EQ(decoded.bids.size(), 1000u);
+    EXPECT_EQ(decoded.bids.back().price, 9001);
+    EXPECT_EQ(decoded.asks.back().price, 11000);
+    EXPECT_EQ(decoded.asks[3].orderCount, 1);
+}
+
+TEST(MarketDataTests, TestTradeTapeRecordsAggressorSide) {
+    Book book;
+    TradeTape tape(book, 8);
+    book.addLimitOrder(1, false, 10, 101);
+    book.addLimitOrder(2, false, 10, 102);
+    EXPECT_EQ(tape.onEvent(1000), 0u);
+    book.marketOrder(3, true, 15);
+    EXPECT_EQ(tape.onEvent(2000), 2u);
+    book.addLimitOrder(4, true, 5, 100);
+    tape.onEvent(3000);
+    book.addLimitOrder(5, false, 8, 99);
+    EXPECT_EQ(tape.onEvent(4000), 1u);
+
+    ASSERT_EQ(tape.getTradeCount(), 3u);
+    const Trade& first = tape.getTrade(1);
+    EXPECT_EQ(first.price, 101);
+    EXPECT_EQ(first.shares, 10);
+    EXPECT_TRUE(first.takerBuys);
+    EXPECT_EQ(first.makerId, 1);
+    EXPECT_EQ(first.takerId, 3);
+    EXPECT_EQ(tape.getTrade(2).price, 102);
+    EXPECT_EQ(tape.getTrade(2).shares, 5);
+    const Trade& last = tape.getLastTrade();
+    EXPECT_FALSE(last.takerBuys);
+    EXPECT_EQ(last.price, 100);
+    EXPECT_EQ(last.timestamp, 4000u);
+    EXPECT_EQ(last.sequence, 3u);
+}
+
+TEST(MarketDataTests, TestTradeTapeBarsMatchRecomputedTrades) {
+    Book book;
+    TradeTape tape(book, 1000);
+    const uint64_t ms = 1000000;
+    BarSeries& fast = tape.addBars(100 * ms, 16);
+    BarSeries& slow = tape.addBars(1000 * ms);
+
+    // One order call per millisecond, every trade also kept here
+    std::vector<Trade> all;
+    uint64_t now = 0;
+    for (const OrderCommand& command : randomFlow(20000, 41)) {
+        try {
+            applyOrderCommand(book, command);
+        } catch (const std::exception&) {}
+        now += ms;
+        tape.onEvent(now);
+        for (const Fill& fill : book.getFills()) {
+            all.push_back(Trade{all.size() + 1, now, fill.price, fill.shares, fill.takerBuys, fill.makerId, fill.takerId});
+        }
+    }
+    ASSERT_EQ(tape.getTradeCount(), all.size());
+    ASSERT_GT(all.size(), 2000u);
+
+    // The ring holds the last 1024 trades
+    EXPECT_EQ(tape.getOldestSequence(), all.size() - 1023);
+    for (uint64_t sequence = tape.getOldestSequence(); sequence <= tape.getTradeCount(); ++sequence) {
+        const Trade& trade = tape.getTrade(sequence);
+        const Trade& expected = all[sequence - 1];
+        ASSERT_EQ(trade.sequence, sequence);
+        ASSERT_EQ(trade.timestamp, expected.timestamp);
+        ASSERT_EQ(trade.price, expected.price);
+        ASSERT_EQ(trade.shares, expected.shares);
+        ASSERT_EQ(trade.takerBuys, expected.takerBuys);
+    }
+
+    // Every bar equals a bar recomputed from scratch
+    for (BarSeries* series : {&fast, &slow}) {
+        std::map<uint64_t, Bar> recomputed;
+        int64_t volume = 0;
+        int64_t notional = 0;
+        for (const Trade& trade : all) {
+            uint64_t start = trade.timestamp / series->getInterval() * series->getInterval();
+            auto [it, inserted] = recomputed.try_emplace(start);
+            Bar& bar = it->second;
+            if (inserted) {
+                bar.start = start;
+                bar.open = bar.high = bar.low = trade.price;
+            }
+            bar.high = std::max(bar.high, trade.price);
+            bar.low = std::min(bar.low, trade.price);
+            bar.close = trade.price;
+            bar.volume += trade.shares;
+            bar.notional += static_cast<int64_t>(trade.price) * trade.shares;
+            ++bar.tradeCount;
+            volume += trade.shares;
+            notional += static_cast<int64_t>(trade.price) * trade.shares;
+        }
+        ASSERT_EQ(series->getBarCount(), recomputed.size());
+        ASSERT_EQ(series->size(), std::min<size_t>(recomputed.size(), series == &fast ? 16 : 1024));
+        auto expected = recomputed.rbegin();
+        for (size_t ago = 0; ago < series->size(); ++ago, ++expected) {
+            const Bar& bar = series->getBar(ago);
+            ASSERT_EQ(bar.start, expected->second.start);
+            ASSERT_EQ(bar.open, expected->second.open);
+            ASSERT_EQ(bar.high, expected->second.high);
+            ASSERT_EQ(bar.low, expected->second.low);
+            ASSERT_EQ(bar.close, expected->second.close);
+            ASSERT_EQ(bar.volume, expected->second.volume);
+            ASSERT_EQ(bar.tradeCount, expected->second.tradeCount);
+            ASSERT_DOUBLE_EQ(bar.vwap(), expected->second.vwap());
+        }
+        EXPECT_EQ(series->getVolume(), volume);
+        EXPECT_DOUBLE_EQ(series->vwap(), static_cast<double>(notional) / static_cast<double>(volume));
+    }
+}
@@ -0,0 +1,983 @@
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Limit_Order_Book/BookDepth.hpp"
+#include "../Limit_Order_Book/BookManager.hpp"
+#include "../Limit_Order_Book/ObjectPool.hpp"
+#include "../Matching_Engine/AsyncEngine.hpp"
+#include "../Matching_Engine/DepthSnapshot.hpp"
+#include "../Matching_Engine/MPSCQueue.hpp"
+#include "../Matching_Engine/MatchingThread.hpp"
+#include "../Matching_Engine/SPSCQueue.hpp"
+#include "../Matching_Engine/Seqlock.hpp"
+#include "../Matching_Engine/SequencedPipeline.hpp"
+#include "../Matching_Engine/ShardedEngine.hpp"
+#include "../Matching_Engine/ThreadUtils.hpp"
+#include "../Matching_Engine/WorkStealingPool.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+#include "../Process_Orders/OrderPipeline.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Order log parsing tests
+TEST(MatchingEngineTests, TestParseOrderCommand) {
+    OrderCommand command;
+    std::string_view symbol;
+
+    ASSERT_TRUE(parseOrderCommand("AddStopLimit 7 1 100 301 299", command, symbol));
+    EXPECT_TRUE(symbol.empty());
+    EXPECT_EQ(command.type, OrderCommand::AddStopLimit);
+    EXPECT_EQ(command.orderId, 7);
+    EXPECT_TRUE(command.buyOrSell);
+    EXPECT_EQ(command.shares, 100);
+    EXPECT_EQ(command.limitPrice, 301);
+    EXPECT_EQ(command.stopPrice, 299);
+
+    ASSERT_TRUE(parseOrderCommand("MSFT ModifyLimit 3 50 120", command, symbol));
+    EXPECT_EQ(symbol, "MSFT");
+    EXPECT_EQ(command.type, OrderCommand::ModifyLimit);
+    EXPECT_EQ(command.shares, 50);
+    EXPECT_EQ(command.limitPrice, 120);
+
+    EXPECT_FALSE(parseOrderCommand("AddLimit 7 1", command, symbol));
+    EXPECT_FALSE(parseOrderCommand("MSFT Teleport 7", command, symbol));
+    EXPECT_FALSE(parseOrderCommand("", command, symbol));
+}
+
+TEST(MatchingEngineTests, TestMPSCQueueMultipleProducers) {
+    MPSCQueue<int> queue(1024);
+    constexpr int perProducer = 10000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 3; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < perProducer; ++i) {
+                while (!queue.tryPush(p * perProducer + i)) std::this_thread::yield();
+            }
+        });
+    }
+
+    // Each producer's values arrive in the order it pushed them
+    std::vector<int> last(3, -1);
+    int received = 0;
+    int value;
+    while (received < 3 * perProducer) {
+        if (!queue.tryPop(value)) continue;
+        int producer = value / perProducer;
+        EXPECT_GT(value % perProducer, last[producer]);
+        last[producer] = value % perProducer;
+        ++received;
+    }
+    for (auto& producer : producers) producer.join();
+}
+
+TEST(MatchingEngineTests, TestSPSCQueueBatchesWrapAround) {
+    SPSCQueue<int> queue(8);
+    int items[6] = {0, 1, 2, 3, 4, 5};
+    int next = 0;
+
+    for (int round = 0; round < 10; ++round) {
+        EXPECT_EQ(queue.tryPushBatch(items, 6), 6u);
+        EXPECT_EQ(queue.tryPushBatch(items, 6), 2u);  // only 8 slots
+        EXPECT_FALSE(queue.tryPush(7));
+
+        size_t consumed = queue.consume([&next](int value) {
+            EXPECT_EQ(value, next % 6);
+            ++next;
+        }, 6);
+        EXPECT_EQ(consumed, 6u);
+
+        int value;
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(value, 1);
+        EXPECT_TRUE(queue.empty());
+        next = 0;
+    }
+}
+
+TEST(MatchingEngineTests, TestParkedConsumerWakesOnPublish) {
+    SPSCQueue<int> queue(16);
+    std::atomic<bool> running{true};
+    std::atomic<int> sum{0};
+
+    std::thread consumer([&]() {
+        while (running.load()) {
+            if (queue.consume([&sum](int value) { sum += value; }) == 0) {
+                queue.park([&running]() { return running.load(); });
+            }
+        }
+    });
+    for (int i = 1; i <= 1000; ++i) {
+        while (!queue.tryPush(i)) std::this_thread::yield();
+        if (i % 100 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    while (!queue.empty()) std::this_thread::yield();
+    running.store(false);
+    queue.wake();
+    consumer.join();
+    EXPECT_EQ(sum.load(), 500500);
+}
+
+TEST(MatchingEngineTests, TestMatchingThreadAppliesInOrder) {
+    for (WaitStrategy wait : {WaitStrategy::BusySpin, WaitStrategy::Yield, WaitStrategy::Backoff, WaitStrategy::Park}) {
+        MatchingThread matcher(64, wait);
+        Book reference;
+        matcher.start();
+
+        std::vector<OrderCommand> batch;
+        for (int n = 0; n < 3000; ++n) {
+            OrderCommand command;
+            command.orderId = n + 1;
+            command.type = (n % 4 == 3) ? OrderCommand::Market : OrderCommand::AddLimit;
+            command.buyOrSell = n % 2;
+            command.shares = 5 + n % 9;
+            command.limitPrice = 100 + (n * 5) % 13;
+            applyOrderCommand(reference, command);
+            if (n < 2000) {
+                matcher.submit(command);
+            } else {
+                batch.push_back(command);
+            }
+        }
+        matcher.submitBatch(batch.data(), batch.size());
+        matcher.drain();
+
+        const Book* book = matcher.findBook(0);
+        ASSERT_NE(book, nullptr);
+        EXPECT_EQ(book->getBestBidPrice(), reference.getBestBidPrice());
+        EXPECT_EQ(book->getBestAskPrice(), reference.getBestAskPrice());
+        EXPECT_EQ(book->getSellLimits().size(), reference.getSellLimits().size());
+        EXPECT_EQ(matcher.getCommandsProcessed(), 3000u);
+        matcher.stop();
+    }
+}
+
+// Sharded matching tests
+TEST(MatchingEngineTests, TestShardedEngineMatchesSequentialReplay) {
+    ShardedEngine engine(3, 64, false);
+    std::vector<int> ids;
+    for (int i = 0; i < 8; ++i) {
+        ids.push_back(engine.internSymbol("SYM" + std::to_string(i)));
+    }
+    EXPECT_EQ(engine.internSymbol("SYM3"), ids[3]);
+    EXPECT_EQ(engine.shardFor(ids[3]), engine.shardFor(ids[3]));
+
+    std::vector<Book> reference(ids.size());
+    engine.start();
+    for (int n = 0; n < 4000; ++n) {
+        OrderCommand command;
+        command.symbolId = ids[n % ids.size()];
+        command.orderId = n / static_cast<int>(ids.size()) + 1;
+        command.type = (n % 5 == 4) ? OrderCommand::Market : OrderCommand::AddLimit;
+        command.buyOrSell = (n / 3) % 2;
+        command.shares = 10 + n % 7;
+        command.limitPrice = 100 + (n * 7) % 11;
+        engine.submit(command);
+        applyOrderCommand(reference[command.symbolId], command);
+    }
+    engine.drain();
+
+    for (int id : ids) {
+        const Book* book = engine.findBook(id);
+        ASSERT_NE(book, nullptr);
+        EXPECT_EQ(book->getBestBidPrice(), reference[id].getBestBidPrice());
+        EXPECT_EQ(book->getBestAskPrice(), reference[id].getBestAskPrice());
+        EXPECT_EQ(book->getBuyLimits().size(), reference[id].getBuyLimits().size());
+        EXPECT_EQ(book->getSellLimits().size(), reference[id].getSellLimits().size());
+    }
+    engine.stop();
+
+    size_t total = 0;
+    for (size_t shard = 0; shard < engine.getShardCount(); ++shard) {
+        total += engine.getCommandsProcessed(shard);
+    }
+    EXPECT_EQ(total, 4000u);
+    EXPECT_EQ(engine.getErrorCount(), 0u);
+}
+
+// Sequenced pipeline tests
+TEST(MatchingEngineTests, TestSequencedPipelineStagesSeeEveryEvent) {
+    for (WaitStrategy wait : {WaitStrategy::BusySpin, WaitStrategy::Yield, WaitStrategy::Backoff, WaitStrategy::Park}) {
+        std::vector<int> journaled;
+        std::vector<int64_t> published;
+        size_t batchEnds = 0;
+        int fillShares = 0;
+        int lastBestAsk = -1;
+        std::atomic<int64_t> journaledUpTo{-1};
+        size_t reportedBeforeJournaled = 0;
+
+        SequencedPipeline::Stages stages;
+        stages.journal = [&](const PipelineEvent& event, bool endOfBatch) {
+            journaled.push_back(event.command.orderId);
+            if (endOfBatch) ++batchEnds;
+            journaledUpTo.store(event.sequence);
+        };
+        stages.marketData = [&](const PipelineEvent& event, bool) {
+            published.push_back(event.sequence);
+            lastBestAsk = event.bestAsk;
+        };
+        stages.reports = [&](const PipelineEvent& event, bool) {
+            for (const Fill& fill : event.fills) fillShares += fill.shares;
+            if (event.sequence > journaledUpTo.load()) ++reportedBeforeJournaled;
+        };
+
+        // A small ring makes the producer wrap and wait on the slowest stage
+        SequencedPipeline pipeline(std::move(stages), 64, wait);
+        Book reference;
+        int expectedShares = 0;
+        pipeline.start();
+
+        std::vector<OrderCommand> batch;
+        for (int n = 0; n < 3000; ++n) {
+            OrderCommand command;
+            command.orderId = n + 1;
+            command.type = (n % 4 == 3) ? OrderCommand::Market : OrderCommand::AddLimit;
+            command.buyOrSell = n % 2;
+            command.shares = 5 + n % 9;
+            command.limitPrice = 100 + (n * 5) % 13;
+            applyOrderCommand(reference, command);
+            for (const Fill& fill : reference.getFills()) expectedShares += fill.shares;
+            if (n < 2000) {
+                pipeline.publish(command);
+            } else {
+                batch.push_back(command);
+            }
+        }
+        pipeline.publishBatch(batch.data(), batch.size());
+        pipeline.drain();
+
+        // Every stage has caught up with the producer, in order
+        ASSERT_EQ(journaled.size(), 3000u);
+        ASSERT_EQ(published.size(), 3000u);
+        for (int n = 0; n < 3000; ++n) {
+            EXPECT_EQ(journaled[n], n + 1);
+            EXPECT_EQ(published[n], n);
+        }
+        EXPECT_GT(batchEnds, 0u);
+
+        // Stages behind the matcher see its results, and reports only go out
+        // for journaled commands
+        EXPECT_EQ(fillShares, expectedShares);
+        EXPECT_EQ(reportedBeforeJournaled, 0u);
+        EXPECT_EQ(lastBestAsk, reference.getBestAskPrice());
+
+        const Book* book = pipeline.findBook(0);
+        ASSERT_NE(book, nullptr);
+        EXPECT_EQ(book->getBestBidPrice(), reference.getBestBidPrice());
+        EXPECT_EQ(book->getSellLimits().size(), reference.getSellLimits().size());
+        EXPECT_EQ(pipeline.getErrorCount(), 0u);
+        pipeline.stop();
+    }
+}
+
+TEST(MatchingEngineTests, TestSequencedPipelineEndsLastBatchBeforeStopping) {
+    for (int run = 0; run < 20; ++run) {
+        // A journal stage that only flushes at the end of a batch
+        std::vector<int> pending;
+        std::vector<int> flushed;
+        SequencedPipeline::Stages stages;
+        stages.journal = [&](const PipelineEvent& event, bool endOfBatch) {
+            pending.push_back(event.command.orderId);
+            if (endOfBatch) {
+                flushed.insert(flushed.end(), pending.begin(), pending.end());
+                pending.clear();
+            }
+        };
+        SequencedPipeline pipeline(std::move(stages), 64, WaitStrategy::Park);
+        pipeline.start();
+        std::vector<OrderCommand> batch(40);
+        for (int n = 0; n < 40; ++n) {
+            batch[n].type = OrderCommand::AddLimit;
+            batch[n].orderId = n + 1;
+            batch[n].buyOrSell = true;
+            batch[n].shares = 10;
+            batch[n].limitPrice = 100;
+        }
+        // Stopping straight away usually puts the halt in the same batch
+        pipeline.publishBatch(batch.data(), batch.size());
+        pipeline.stop();
+        ASSERT_EQ(flushed.size(), 40u) << "run " << run;
+        EXPECT_TRUE(pending.empty());
+    }
+}
+
+TEST(MatchingEngineTests, TestSequencedPipelineWithoutOptionalStages) {
+    SequencedPipeline pipeline(SequencedPipeline::Stages{}, 8, WaitStrategy::Park);
+    pipeline.start();
+    for (int n = 0; n < 100; ++n) {
+        OrderCommand command;
+        command.type = OrderCommand::AddLimit;
+        command.symbolId = n % 3;
+        command.orderId = n / 3 + 1;
+        command.buyOrSell = true;
+        command.shares = 10;
+        command.limitPrice = 100 + n % 5;
+        pipeline.publish(command);
+    }
+    pipeline.drain();
+    EXPECT_EQ(pipeline.getPublishedSequence(), 99);
+    ASSERT_NE(pipeline.findBook(2), nullptr);
+    EXPECT_EQ(pipeline.findBook(2)->getBestBidPrice(), 104);
+    EXPECT_EQ(pipeline.findBook(3), nullptr);
+    pipeline.stop();
+}
+
+// Work-stealing replay tests
+TEST(MatchingEngineTests, TestFormatOrderCommandRoundTrips) {
+    std::string text;
+    OrderCommand command;
+    command.type = OrderCommand::AddStopLimit;
+    command.orderId = 12;
+    command.buyOrSell = true;
+    command.shares = 40;
+    command.limitPrice = 305;
+    command.stopPrice = 301;
+    formatOrderCommand(command, "MSFT", text);
+    EXPECT_EQ(text, "MSFT AddStopLimit 12 1 40 305 301\n");
+
+    OrderCommand parsed;
+    std::string_view symbol;
+    ASSERT_TRUE(parseOrderCommand(text, parsed, symbol));
+    EXPECT_EQ(symbol, "MSFT");
+    EXPECT_EQ(parsed.type, command.type);
+    EXPECT_EQ(parsed.stopPrice, 301);
+
+    text.clear();
+    command.type = OrderCommand::CancelLimit;
+    formatOrderCommand(command, "", text);
+    EXPECT_EQ(text, "CancelLimit 12\n");
+}
+
+TEST(MatchingEngineTests, TestWorkStealingPoolRunsEveryTask) {
+    WorkStealingPool pool(3);
+    std::atomic<int> total{0};
+    // Everything lands on worker 0 through nested submits, so the others
+    // can only get work by stealing it
+    pool.submit([&] {
+        for (int n = 1; n <= 200; ++n) {
+            pool.submit([&total, n] {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                total.fetch_add(n);
+            });
+        }
+    });
+    pool.wait();
+    EXPECT_EQ(total.load(), 200 * 201 / 2);
+
+    uint64_t executed = 0;
+    for (size_t worker = 0; worker < pool.getThreadCount(); ++worker) {
+        executed += pool.getTasksExecuted(worker);
+    }
+    EXPECT_EQ(executed, 201u);
+
+    // The pool can be reused after wait()
+    pool.submit([&] { total.store(-1); });
+    pool.wait();
+    EXPECT_EQ(total.load(), -1);
+}
+
+TEST(MatchingEngineTests, TestParallelReplayMatchesSequentialReplay) {
+    const char* names[] = {"AAA", "BBB", "CCC", "DDD", "EEE"};
+    std::vector<Book> reference(5);
+    std::string text;
+    for (int n = 0; n < 5000; ++n) {
+        int symbol = (n % 8 < 4) ? 0 : n % 5;  // uneven stream sizes
+        OrderCommand command;
+        command.orderId = n + 1;
+        command.type = (n % 6 == 5) ? OrderCommand::Market : OrderCommand::AddLimit;
+        command.buyOrSell = (n / 2) % 2;
+        command.shares = 3 + n % 11;
+        command.limitPrice = 100 + (n * 3) % 9;
+        formatOrderCommand(command, names[symbol], text);
+        applyOrderCommand(reference[symbol], command);
+    }
+    text += "NotACommand\nAddLimit 1 1 10 100\n";
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "lob_parallel_replay_test.txt";
+    std::ofstream(path) << text;
+
+    BookManager books;
+    WorkStealingPool pool(4);
+    OrderPipeline pipeline(&books, &pool);
+    pipeline.processOrdersFromFile(path.string());
+    std::filesystem::remove(path);
+
+    const ReplayStats& stats = pipeline.getReplayStats();
+    EXPECT_EQ(stats.lines, 5002u);
+    EXPECT_EQ(stats.rejectedLines, 2u);
+    EXPECT_EQ(stats.commands, 5000u);
+    EXPECT_EQ(stats.errors, 0u);
+    EXPECT_GT(stats.commandsPerSecond(), 0.0);
+
+    size_t fills = 0;
+    for (int i = 0; i < 5; ++i) {
+        int id = books.findSymbol(names[i]);
+        ASSERT_GE(id, 0);
+        const Book* book = books.findBook(id);
+        ASSERT_NE(book, nullptr);
+        EXPECT_EQ(book->getBestBidPrice(), reference[i].getBestBidPrice());
+        EXPECT_EQ(book->getBestAskPrice(), reference[i].getBestAskPrice());
+        EXPECT_EQ(book->getBuyLimits().size(), reference[i].getBuyLimits().size());
+        EXPECT_EQ(stats.perSymbol[id].bestAsk, reference[i].getBestAskPrice());
+        fills += stats.perSymbol[id].fills;
+    }
+    EXPECT_EQ(fills, stats.fills);
+    EXPECT_GT(stats.fills, 0u);
+}
+
+// Published depth tests
+TEST(MatchingEngineTests, TestSeqlockReadersNeverSeeTornValues) {
+    struct Wide {
+        uint64_t values[16];
+    };
+    Seqlock<Wide> lock;
+    std::atomic<bool> writing{true};
+    std::atomic<uint64_t> torn{0};
+
+    std::thread reader([&]() {
+        uint64_t last = 0;
+        while (writing.load()) {
+            Wide copy = lock.load();
+            for (uint64_t value : copy.values) {
+                if (value != copy.values[0]) torn.fetch_add(1);
+            }
+            // Versions only move forward
+            if (copy.values[0] < last) torn.fetch_add(1);
+            last = copy.values[0];
+        }
+    });
+    Wide value;
+    for (uint64_t n = 1; n <= 200000; ++n) {
+        std::fill(std::begin(value.values), std::end(value.values), n);
+        lock.store(value);
+    }
+    writing.store(false);
+    reader.join();
+
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_EQ(lock.load().values[15], 200000u);
+    EXPECT_EQ(lock.getVersion(), 200001u);
+}
+
+TEST(MatchingEngineTests, TestMatchingThreadPublishesDepth) {
+    MatchingThread matcher(64, WaitStrategy::Yield);
+    matcher.publishDepth(2, 3);
+    matcher.start();
+
+    BookDepth depth;
+    ASSERT_TRUE(matcher.readDepth(1, depth));
+    EXPECT_EQ(depth.bidLevels, 0);
+    EXPECT_FALSE(matcher.readDepth(2, depth));
+
+    // Four bid levels on symbol 1; two orders at 101
+    int prices[] = {100, 101, 102, 103, 101};
+    for (int n = 0; n < 5; ++n) {
+        OrderCommand command;
+        command.type = OrderCommand::AddLimit;
+        command.symbolId = 1;
+        command.orderId = n + 1;
+        command.buyOrSell = true;
+        command.shares = 10 + n;
+        command.limitPrice = prices[n];
+        matcher.submit(command);
+    }
+    OrderCommand sell;
+    sell.type = OrderCommand::AddLimit;
+    sell.symbolId = 1;
+    sell.orderId = 6;
+    sell.shares = 5;
+    sell.limitPrice = 110;
+    matcher.submit(sell);
+    // A cancel of an unknown order changes nothing and publishes nothing
+    OrderCommand cancel;
+    cancel.type = OrderCommand::CancelLimit;
+    cancel.symbolId = 1;
+    cancel.orderId = 99;
+    matcher.submit(cancel);
+    matcher.drain();
+
+    ASSERT_TRUE(matcher.readDepth(1, depth));
+    ASSERT_EQ(depth.bidLevels, 3);
+    EXPECT_EQ(depth.bids[0].price, 103);
+    EXPECT_EQ(depth.bids[2].price, 101);
+    EXPECT_EQ(depth.bids[2].volume, 11 + 14);
+    EXPECT_EQ(depth.bids[2].orderCount, 2);
+    ASSERT_EQ(depth.askLevels, 1);
+    EXPECT_EQ(depth.asks[0].price, 110);
+    EXPECT_EQ(matcher.getDepthVersion(1), 6u);
+    EXPECT_EQ(matcher.getDepthVersion(0), 0u);
+
+    BookDepth direct;
+    captureDepth(*matcher.findBook(1), direct, 3);
+    EXPECT_TRUE(direct == depth);
+    matcher.stop();
+}
+
+// Full-depth snapshot tests
+namespace {
+    bool snapshotMatchesBook(const DepthSnapshot& snapshot, const Book& book) {
+        auto sameSide = [](const std::vector<DepthLevel>& levels, const std::vector<Limit*>& limits) {
+            if (levels.size() != limits.size()) return false;
+            for (size_t i = 0; i < levels.size(); ++i) {
+                if (levels[i].price != limits[i]->getLimitPrice() || levels[i].volume != limits[i]->getTotalVolume()
+                    || levels[i].orderCount != limits[i]->getSize()) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        return sameSide(snapshot.bids, book.getBuyLimits()) && sameSide(snapshot.asks, book.getSellLimits());
+    }
+
+    OrderCommand randomCommand(int n) {
+        OrderCommand command;
+        command.orderId = n + 1;
+        int kind = (n * 7) % 10;
+        if (kind < 6) {
+            command.type = OrderCommand::AddLimit;
+        } else if (kind < 8) {
+            command.type = OrderCommand::CancelLimit;
+            command.orderId = (n * 13) % (n + 1) + 1;
+        } else if (kind < 9) {
+            command.type = OrderCommand::ModifyLimit;
+            command.orderId = (n * 5) % (n + 1) + 1;
+        } else {
+            command.type = OrderCommand::Market;
+        }
+        command.buyOrSell = (n / 3) % 2;
+        command.shares = 1 + (n * 11) % 40;
+        // Buys rest around 80-104 and sells around 96-120, so they overlap
+        command.limitPrice = command.buyOrSell ? 80 + (n * 17) % 25 : 96 + (n * 19) % 25;
+        return command;
+    }
+}
+
+TEST(MatchingEngineTests, TestDepthSnapshotFollowsBookIncrementally) {
+    Book book;
+    DepthSnapshotPublisher publisher(book, 1);
+    uint64_t fullCopies = 0;
+    for (int n = 0; n < 3000; ++n) {
+        applyOrderCommand(book, randomCommand(n));
+        fullCopies += book.getBuyLimits().size() + book.getSellLimits().size();
+        publisher.onEvent();
+        ASSERT_TRUE(snapshotMatchesBook(*publisher.read(), book)) << "after command " << n;
+    }
+    EXPECT_GT(book.getBuyLimits().size() + book.getSellLimits().size(), 10u);
+    EXPECT_GT(publisher.getPublishCount(), 1000u);
+    EXPECT_EQ(publisher.read()->version, publisher.getPublishCount());
+    // Only touched levels are copied, not the whole book every time
+    EXPECT_LT(publisher.getLevelsCopied() * 4, fullCopies);
+}
+
+TEST(MatchingEngineTests, TestDepthSnapshotNeverRewritesHeldBuffer) {
+    Book book;
+    DepthSnapshotPublisher publisher(book, 1000);
+    book.addLimitOrder(1, true, 10, 100);
+    ASSERT_TRUE(publisher.publish());
+
+    {
+        DepthSnapshotPublisher::Reader held = publisher.read();
+        ASSERT_EQ(held->bids.size(), 1u);
+
+        // The next publication goes to the other buffer
+        book.addLimitOrder(2, true, 10, 99);
+        EXPECT_TRUE(publisher.publish());
+        // The one after that would need the held buffer, so it is skipped
+        book.addLimitOrder(3, true, 10, 98);
+        EXPECT_FALSE(publisher.publish());
+        EXPECT_EQ(publisher.getSkippedCount(), 1u);
+        EXPECT_TRUE(publisher.hasUnpublishedChanges());
+
+        EXPECT_EQ(held->bids.size(), 1u);
+        EXPECT_EQ(held->version, 1u);
+        EXPECT_EQ(publisher.read()->bids.size(), 2u);
+    }
+
+    // Once the reader has gone the pending change goes out
+    EXPECT_TRUE(publisher.publish());
+    EXPECT_FALSE(publisher.hasUnpublishedChanges());
+    EXPECT_TRUE(snapshotMatchesBook(*publisher.read(), book));
+    EXPECT_EQ(publisher.read()->version, 3u);
+}
+
+TEST(MatchingEngineTests, TestMatchingThreadPublishesFullDepthToReaders) {
+    MatchingThread matcher(256, WaitStrategy::Yield);
+    matcher.publishFullDepth(0, 16);
+    const DepthSnapshotPublisher* publisher = matcher.getFullDepth(0);
+    ASSERT_NE(publisher, nullptr);
+    EXPECT_EQ(matcher.getFullDepth(1), nullptr);
+    matcher.start();
+
+    // A reader checking every snapshot it sees is sorted and internally sane
+    std::atomic<bool> reading{true};
+    std::atomic<uint64_t> bad{0};
+    std::thread reader([&]() {
+        while (reading.load()) {
+            DepthSnapshotPublisher::Reader snapshot = publisher->read();
+            for (size_t i = 1; i < snapshot->bids.size(); ++i) {
+                if (snapshot->bids[i].price >= snapshot->bids[i - 1].price) bad.fetch_add(1);
+            }
+            for (size_t i = 1; i < snapshot->asks.size(); ++i) {
+                if (snapshot->asks[i].price <= snapshot->asks[i - 1].price) bad.fetch_add(1);
+            }
+            for (const DepthLevel& level : snapshot->bids) {
+                if (level.volume <= 0 || level.orderCount <= 0) bad.fetch_add(1);
+            }
+        }
+    });
+
+    for (int n = 0; n < 5000; ++n) {
+        matcher.submit(randomCommand(n));
+    }
+    matcher.drain();
+    // The idle pass publishes whatever the last interval left behind
+    for (int attempt = 0; attempt < 1000 && !snapshotMatchesBook(*publisher->read(), *matcher.findBook(0)); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    reading.store(false);
+    reader.join();
+
+    EXPECT_EQ(bad.load(), 0u);
+    EXPECT_TRUE(snapshotMatchesBook(*publisher->read(), *matcher.findBook(0)));
+    matcher.stop();
+}
+
+// Memory placement tests
+TEST(MatchingEngineTests, TestObjectPoolReusesFreedObjects) {
+    ObjectPool<Order> pool(4);
+    Order* first = pool.create(1, true, 10, 100);
+    Order* second = pool.create(2, false, 20, 101);
+    EXPECT_EQ(pool.size(), 2u);
+    EXPECT_EQ(pool.capacity(), 4u);
+    EXPECT_EQ(second->getShares(), 20);
+
+    pool.destroy(first);
+    Order* third = pool.create(3, true, 30, 102);
+    EXPECT_EQ(third, first);  // most recently freed slot first
+    EXPECT_EQ(third->getOrderId(), 3);
+
+    // Slabs are added as needed and objects never move
+    std::vector<Order*> more;
+    for (int n = 0; n < 10; ++n) more.push_back(pool.create(10 + n, true, 1, 100));
+    EXPECT_EQ(pool.size(), 12u);
+    EXPECT_EQ(pool.capacity(), 12u);
+    EXPECT_EQ(second->getOrderId(), 2);
+
+    pool.reserve(5);
+    EXPECT_GE(pool.capacity() - pool.size(), 5u);
+    EXPECT_NE(pool.firstSlab(), nullptr);
+}
+
+TEST(MatchingEngineTests, TestObjectPoolGrowsFromSmallSlabs) {
+    // An idle book's pools stay small; slabs double up to the regular size
+    ObjectPool<Order> pool(64);
+    EXPECT_EQ(pool.capacity(), 0u);
+    EXPECT_EQ(pool.firstSlab(), nullptr);
+    std::vector<Order*> orders;
+    orders.push_back(pool.create(1, true, 1, 100));
+    EXPECT_EQ(pool.capacity(), 4u);
+    for (int n = 2; n <= 300; ++n) orders.push_back(pool.create(n, true, 1, 100));
+    EXPECT_EQ(pool.capacity(), 4u + 8 + 16 + 32 + 64 + 64 + 64 + 64);
+    for (size_t n = 0; n < orders.size(); ++n) EXPECT_EQ(orders[n]->getOrderId(), static_cast<int>(n + 1));
+
+    // Freed objects are reused before the rest of a slab is carved out
+    pool.destroy(orders[10]);
+    EXPECT_EQ(pool.create(400, true, 1, 100), orders[10]);
+    for (Order* order : orders) pool.destroy(order);
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST(MatchingEngineTests, TestReservedBookMatchesUnreservedBook) {
+    Book reserved;
+    reserved.reserve(4000, 64);
+    EXPECT_NE(reserved.getOrderStorage(), nullptr);
+    Book plain;
+    for (int n = 0; n < 3000; ++n) {
+        OrderCommand command = randomCommand(n);
+        applyOrderCommand(reserved, command);
+        applyOrderCommand(plain, command);
+    }
+    EXPECT_EQ(reserved.getBestBidPrice(), plain.getBestBidPrice());
+    EXPECT_EQ(reserved.getBestAskPrice(), plain.getBestAskPrice());
+    EXPECT_EQ(reserved.getBuyLimits().size(), plain.getBuyLimits().size());
+    EXPECT_EQ(reserved.getSellLimits().size(), plain.getSellLimits().size());
+}
+
+TEST(MatchingEngineTests, TestBookRejectsOrderIdsOutsideItsIndex) {
+    Book book;
+    book.setOrderIdLimit(1000);
+    for (int orderId : {-1, -3, 1001, 2000000000}) {
+        EXPECT_THROW(book.addLimitOrder(orderId, true, 10, 100), std::invalid_argument) << orderId;
+        EXPECT_THROW(book.addStopOrder(orderId, true, 10, 200), std::invalid_argument) << orderId;
+        EXPECT_THROW(book.addStopLimitOrder(orderId, true, 10, 205, 200), std::invalid_argument) << orderId;
+        EXPECT_THROW(book.marketOrder(orderId, true, 10), std::invalid_argument) << orderId;
+        EXPECT_FALSE(book.insertRestingOrder(orderId, true, 10, 100)) << orderId;
+        RestingOrder resting{orderId, 10, 0};
+        EXPECT_FALSE(book.appendLevel(false, true, 100, &resting, 1)) << orderId;
+    }
+    EXPECT_TRUE(book.getBuyLimits().empty());
+    EXPECT_TRUE(book.getStopBuyLimits().empty());
+    book.addLimitOrder(1000, true, 10, 100);
+    EXPECT_NE(book.searchOrderMap(1000), nullptr);
+
+    // The matching thread counts them as rejected commands
+    MatchingThread matcher;
+    matcher.start();
+    OrderCommand command;
+    command.type = OrderCommand::AddLimit;
+    command.orderId = -1;
+    command.shares = 10;
+    command.limitPrice = 100;
+    matcher.submit(command);
+    command.orderId = Book::defaultOrderIdLimit + 1;
+    matcher.submit(command);
+    matcher.drain();
+    EXPECT_EQ(matcher.getErrorCount(), 2u);
+    matcher.stop();
+}
+
+TEST(MatchingEngineTests, TestRejectedOrderCallLeavesNoStaleEvents) {
+    Book book;
+    book.setTrackEventLevels(true);
+    book.setTrackOrderEvents(true);
+    book.addLimitOrder(1, false, 10, 100);
+    book.addLimitOrder(2, true, 5, 100);
+    ASSERT_EQ(book.getFills().size(), 1u);
+    book.addLimitOrder(3, true, 5, 90);
+    book.addLimitOrder(4, false, 100, 101);
+
+    std::vector<std::function<void()>> rejected = {
+        [&] { book.addLimitOrder(3, false, 5, 100); },
+        [&] { book.addStopOrder(3, true, 5, 120); },
+        [&] { book.addStopLimitOrder(-1, true, 5, 125, 120); },
+        [&] { book.marketOrder(-1, true, 5); },
+        [&] { book.modifyLimitOrder(1, 0, 100); },
+        [&] { book.modifyStopOrder(1, -1, 100); },
+        [&] { book.modifyStopLimitOrder(1, 0, 100, 100); },
+    };
+    for (size_t i = 0; i < rejected.size(); ++i) {
+        // Each rejection follows a call that filled and recorded events
+        book.marketOrder(10 + static_cast<int>(i), true, 1);
+        ASSERT_FALSE(book.getFills().empty());
+        EXPECT_THROW(rejected[i](), std::invalid_argument) << i;
+        EXPECT_TRUE(book.getFills().empty()) << i;
+        EXPECT_TRUE(book.getOrderEvents().empty()) << i;
+        EXPECT_TRUE(book.getEventLevels().empty()) << i;
+        EXPECT_EQ(book.executedOrdersCount, 0) << i;
+    }
+}
+
+TEST(MatchingEngineTests, TestShardedEngineReportsPlacement) {
+    for (MemoryPlacement placement : {MemoryPlacement::Local, MemoryPlacement::Interleaved}) {
+        ShardedEngine engine(2, 64, false);
+        int first = engine.internSymbol("AAA");
+        int second = engine.internSymbol("BBB");
+        engine.setMemoryPlacement(placement, 100);
+        engine.start();
+        for (int n = 0; n < 200; ++n) {
+            OrderCommand command = randomCommand(n);
+            command.symbolId = n % 2 ? first : second;
+            engine.submit(command);
+        }
+        engine.drain();
+
+        std::ostringstream report;
+        engine.printPlacement(report);
+        EXPECT_NE(report.str().find("shard 0: cpu -1, node "), std::string::npos);
+        EXPECT_NE(report.str().find("shard 1: "), std::string::npos);
+        EXPECT_NE(report.str().find(" x1"), std::string::npos);
+        ASSERT_NE(engine.findBook(first), nullptr);
+        EXPECT_NE(engine.findBook(first)->getOrderStorage(), nullptr);
+        EXPECT_EQ(engine.getErrorCount(), 0u);
+        engine.stop();
+    }
+    EXPECT_GE(numaNodeCount(), 1);
+}
+
+// Run loop tests
+TEST(MatchingEngineTests, TestBackoffSleepsLongerWhenIdle) {
+    IdleStrategy idle(WaitStrategy::Backoff);
+    auto timeIdle = [&idle]() {
+        auto start = std::chrono::steady_clock::now();
+        idle.idle();
+        return std::chrono::steady_clock::now() - start;
+    };
+    for (uint32_t i = 0; i < IdleStrategy::spinPolls + IdleStrategy::yieldPolls; ++i) idle.idle();
+    for (int i = 0; i < 9; ++i) idle.idle();
+    // The next poll sleeps 1us << 9 (about half a millisecond)
+    EXPECT_EQ(idle.nextSleepNanos(), 512000);
+    EXPECT_GE(timeIdle(), std::chrono::microseconds(500));
+    EXPECT_EQ(idle.nextSleepNanos(), 1000000);
+
+    // Work resets it to spinning
+    idle.reset();
+    EXPECT_EQ(idle.getPolls(), 0u);
+    EXPECT_EQ(idle.nextSleepNanos(), 0);
+    for (uint32_t i = 0; i < IdleStrategy::spinPolls + IdleStrategy::yieldPolls; ++i) idle.idle();
+    EXPECT_EQ(idle.nextSleepNanos(), 1000);
+
+    int parked = 0;
+    IdleStrategy parking(WaitStrategy::Park);
+    for (uint32_t i = 0; i < IdleStrategy::spinPolls + 3; ++i) parking.idle([&parked]() { ++parked; });
+    EXPECT_EQ(parked, 3);
+}
+
+TEST(MatchingEngineTests, TestMatchingThreadCountsBusyAndIdlePolls) {
+    MatchingThread matcher(64, WaitStrategy::Backoff);
+    // Without CAP_SYS_NICE this quietly keeps the normal scheduler
+    matcher.setRealtimePriority(1);
+    matcher.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    for (int n = 0; n < 100; ++n) {
+        OrderCommand command;
+        command.type = OrderCommand::AddLimit;
+        command.orderId = n + 1;
+        command.buyOrSell = true;
+        command.shares = 1;
+        command.limitPrice = 100;
+        matcher.submit(command);
+    }
+    matcher.drain();
+    EXPECT_GE(matcher.getBusyPolls(), 1u);
+    EXPECT_LE(matcher.getBusyPolls(), 100u);
+    EXPECT_GT(matcher.getIdlePolls(), 0u);
+    matcher.stop();
+    EXPECT_EQ(matcher.getCommandsProcessed(), 100u);
+}
+
+namespace {
+    // Submits randomCommand(0..count) on its own symbol, one at a time
+    AsyncTask asyncClient(AsyncEngine& engine, int symbolId, int count, long long& filledShares,
+                          std::thread::id& resumedOn, std::atomic<int>& done) {
+        for (int n = 0; n < count; ++n) {
+            OrderCommand command = randomCommand(n);
+            command.symbolId = symbolId;
+            SubmitResult result = co_await engine.submit(command);
+            filledShares += result.filledShares;
+            resumedOn = std::this_thread::get_id();
+        }
+        done.fetch_add(1);
+    }
+}
+
+TEST(MatchingEngineTests, TestAsyncEngineReturnsFillsOnSubmittingExecutor) {
+    AsyncEngine engine;
+    engine.start();
+    ClientExecutor executor;
+
+    std::atomic<int> done{0};
+    SubmitResult resting;
+    SubmitResult crossing;
+    std::thread::id resumedOn;
+    auto trade = [&]() -> AsyncTask {
+        OrderCommand sell;
+        sell.type = OrderCommand::AddLimit;
+        sell.orderId = 1;
+        sell.shares = 30;
+        sell.limitPrice = 101;
+        resting = co_await engine.submit(sell);
+        OrderCommand buy = sell;
+        buy.orderId = 2;
+        buy.buyOrSell = true;
+        buy.shares = 50;
+        crossing = co_await engine.submit(buy);
+        resumedOn = std::this_thread::get_id();
+        done.fetch_add(1);
+    };
+    executor.spawn(trade);
+    executor.runUntil([&]() { return done.load() == 1; });
+    engine.stop();
+
+    EXPECT_EQ(resumedOn, std::this_thread::get_id());
+    EXPECT_EQ(resting.fillCount, 0u);
+    EXPECT_EQ(resting.bestAsk, 101);
+    ASSERT_EQ(crossing.fillCount, 1u);
+    EXPECT_EQ(crossing.getFills()[0].makerId, 1);
+    EXPECT_EQ(crossing.getFills()[0].takerId, 2);
+    EXPECT_EQ(crossing.getFills()[0].shares, 30);
+    EXPECT_EQ(crossing.filledShares, 30);
+    EXPECT_EQ(crossing.bestBid, 101);
+    EXPECT_EQ(engine.getCommandsProcessed(), 2u);
+}
+
+TEST(MatchingEngineTests, TestAsyncEngineClientsOnManyExecutorsMatchSequentialReplay) {
+    constexpr int executors = 3;
+    constexpr int clientsPerExecutor = 4;
+    constexpr int count = 300;
+    constexpr int clients = executors * clientsPerExecutor;
+
+    AsyncEngine engine(WaitStrategy::Yield);
+    engine.start();
+    std::vector<long long> filledShares(clients, 0);
+    std::vector<std::thread::id> resumedOn(clients);
+    std::vector<std::thread::id> executorIds(executors);
+    std::vector<std::thread> threads;
+    for (int e = 0; e < executors; ++e) {
+        threads.emplace_back([&, e]() {
+            ClientExecutor executor;
+            std::atomic<int> done{0};
+            for (int c = e * clientsPerExecutor; c < (e + 1) * clientsPerExecutor; ++c) {
+                executor.spawn([&, c]() { asyncClient(engine, c, count, filledShares[c], resumedOn[c], done); });
+            }
+            executor.runUntil([&]() { return done.load() == clientsPerExecutor; });
+            executorIds[e] = std::this_thread::get_id();
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    engine.stop();
+    EXPECT_EQ(engine.getCommandsProcessed(), static_cast<uint64_t>(clients * count));
+
+    for (int c = 0; c < clients; ++c) {
+        Book reference;
+        long long referenceShares = 0;
+        for (int n = 0; n < count; ++n) {
+            try {
+                applyOrderCommand(reference, randomCommand(n));
+            } catch (const std::exception&) {}
+            for (const Fill& fill : reference.getFills()) referenceShares += fill.shares;
+        }
+        Book* book = engine.findBook(c);
+        ASSERT_NE(book, nullptr);
+        EXPECT_EQ(book->getBestBidPrice(), reference.getBestBidPrice());
+        EXPECT_EQ(book->getBestAskPrice(), reference.getBestAskPrice());
+        EXPECT_EQ(book->getBuyLimits().size(), reference.getBuyLimits().size());
+        EXPECT_EQ(book->getSellLimits().size(), reference.getSellLimits().size());
+        EXPECT_EQ(filledShares[c], referenceShares);
+        EXPECT_EQ(resumedOn[c], executorIds[c / clientsPerExecutor]);
+    }
+}
+
+TEST(MatchingEngineTests, TestAsyncEngineSubmitsWithoutHeapAllocation) {
+    AsyncEngine engine;
+    engine.start();
+    ClientExecutor executor;
+
+    auto round = [&]() {
+        std::atomic<int> done{0};
+        long long filledShares = 0;
+        std::thread::id resumedOn;
+        for (int c = 0; c < 32; ++c) {
+            executor.spawn([&, c]() { asyncClient(engine, c % 4, 50, filledShares, resumedOn, done); });
+        }
+        executor.runUntil([&]() { return done.load() == 32; });
+    };
+    // The first round warms the frame lists; later rounds reuse them
+    round();
+    uint64_t allocations = FramePool::getHeapAllocations();
+    EXPECT_GT(allocations, 0u);
+    round();
+    round();
+    EXPECT_EQ(FramePool::getHeapAllocations(), allocations);
+    engine.stop();
+}
@@ -0,0 +1,550 @@
+#include "../Generate_Orders/GenerateOrders.hpp"
+#include "../Limit_Order_Book/Book.hpp"
+#include "../Market_Data/L3FeedHandler.hpp"
+#include "../Matching_Engine/MatchingThread.hpp"
+#include "../Persistence/BookSnapshot.hpp"
+#include "../Persistence/ForkSnapshot.hpp"
+#include "../Persistence/Journal.hpp"
+#include "../Persistence/Recovery.hpp"
+#include "../Process_Orders/OrderCommand.hpp"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    // Fresh, empty directory under the temp dir
+    std::string tempDirectory(const char* name) {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(path);
+        return path.string();
+    }
+
+    bool sameCommand(const OrderCommand& a, const OrderCommand& b) {
+        return a.type == b.type && a.buyOrSell == b.buyOrSell && a.symbolId == b.symbolId && a.orderId == b.orderId
+            && a.shares == b.shares && a.limitPrice == b.limitPrice && a.stopPrice == b.stopPrice;
+    }
+}
+
+TEST(PersistenceTests, TestJournalRecordsEveryCommandInEachMode) {
+    std::vector<OrderCommand> log = generateCommandLog(4, 20000, 51);
+    for (Durability durability : {Durability::None, Durability::Async, Durability::PerBatch}) {
+        std::string directory = tempDirectory("lob_journal_modes");
+        {
+            // 1000 records per segment, so the log spans many segments
+            Journal journal(directory, durability, 1000 * Journal::recordSize, 1024);
+            journal.start();
+            uint64_t last = 0;
+            for (const OrderCommand& command : log) last = journal.append(command);
+            EXPECT_EQ(last, log.size());
+            EXPECT_TRUE(journal.waitDurable(last));
+            EXPECT_GE(journal.getDurableSequence(), last);
+            journal.stop();
+            EXPECT_FALSE(journal.hasFailed());
+            EXPECT_GE(journal.getSegmentCount(), 20u);
+            if (durability == Durability::None) {
+                EXPECT_EQ(journal.getSyncCount(), 0u);
+            }
+            if (durability == Durability::PerBatch) {
+                EXPECT_EQ(journal.getSyncCount(), journal.getBatchCount());
+            }
+        }
+
+        size_t read = 0;
+        bool ordered = true;
+        uint64_t last = readJournal(directory, 0, [&](uint64_t sequence, const OrderCommand& command) {
+            if (sequence != read + 1 || !sameCommand(command, log[read])) ordered = false;
+            ++read;
+        });
+        EXPECT_EQ(last, log.size());
+        EXPECT_EQ(read, log.size());
+        EXPECT_TRUE(ordered);
+
+        // A tail read skips the earlier segments and starts mid-segment
+        uint64_t expected = 15501;
+        last = readJournal(directory, 15500, [&](uint64_t sequence, const OrderCommand& command) {
+            if (sequence != expected || !sameCommand(command, log[sequence - 1])) ordered = false;
+            ++expected;
+        });
+        EXPECT_EQ(last, log.size());
+        EXPECT_EQ(expected, log.size() + 1);
+        EXPECT_TRUE(ordered);
+        EXPECT_EQ(lastJournalSequence(directory), log.size());
+        // Reading past the end applies nothing and still finds the end
+        size_t applied = 0;
+        EXPECT_EQ(readJournal(directory, UINT64_MAX, [&](uint64_t, const OrderCommand&) { ++applied; }), log.size());
+        EXPECT_EQ(applied, 0u);
+        std::filesystem::remove_all(directory);
+    }
+}
+
+TEST(PersistenceTests, TestJournalResumesAfterTornTail) {
+    std::string directory = tempDirectory("lob_journal_torn");
+    std::vector<OrderCommand> log = generateCommandLog(1, 1010, 52);
+    {
+        Journal journal(directory, Durability::PerBatch);
+        journal.start();
+        for (size_t i = 0; i < 1000; ++i) journal.append(log[i]);
+        journal.stop();
+    }
+
+    // Tear the last record, as a crash in the middle of a write would
+    std::string segment = directory + "/" + journalSegmentName(1);
+    std::FILE* file = std::fopen(segment.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    std::fseek(file, static_cast<long>(999 * Journal::recordSize + 12), SEEK_SET);
+    std::fputc(0x5A, file);
+    std::fclose(file);
+    EXPECT_EQ(readJournal(directory, 0, [](uint64_t, const OrderCommand&) {}), 999u);
+
+    {
+        Journal journal(directory, Durability::PerBatch);
+        journal.start();
+        EXPECT_EQ(journal.getStartSequence(), 999u);
+        uint64_t sequence = 0;
+        for (size_t i = 999; i < log.size(); ++i) sequence = journal.append(log[i]);
+        EXPECT_EQ(sequence, log.size());
+        journal.stop();
+    }
+
+    // The torn record is replaced by its rewrite in the next segment
+    std::vector<uint64_t> sequences;
+    bool same = true;
+    uint64_t last = readJournal(directory, 990, [&](uint64_t sequence, const OrderCommand& command) {
+        sequences.push_back(sequence);
+        if (!sameCommand(command, log[sequence - 1])) same = false;
+    });
+    EXPECT_EQ(last, log.size());
+    ASSERT_EQ(sequences.size(), 20u);
+    EXPECT_EQ(sequences.front(), 991u);
+    EXPECT_TRUE(same);
+    std::filesystem::remove_all(directory);
+}
+
+TEST(PersistenceTests, TestMatchingThreadJournalReplaysToSameBooks) {
+    std::string directory = tempDirectory("lob_journal_matching");
+    const int symbols = 3;
+    std::vector<OrderCommand> log = generateCommandLog(symbols, 30000, 53);
+
+    Journal journal(directory, Durability::PerBatch);
+    journal.start();
+    MatchingThread matcher(1024);
+    matcher.setJournal(&journal);
+    matcher.start();
+    matcher.submitBatch(log.data(), log.size());
+    matcher.drain();
+    EXPECT_TRUE(journal.waitDurable(log.size()));
+
+    // Replaying the journal alone rebuilds every book
+    std::vector<Book> replayed(symbols);
+    uint64_t last = readJournal(directory, 0, [&](uint64_t, const OrderCommand& command) {
+        try {
+            applyOrderCommand(replayed[command.symbolId], command);
+        } catch (const std::exception&) {}
+    });
+    EXPECT_EQ(last, log.size());
+    for (int symbol = 0; symbol < symbols; ++symbol) {
+        ASSERT_NE(matcher.findBook(symbol), nullptr);
+        EXPECT_EQ(compareBooks(*matcher.findBook(symbol), replayed[symbol]), "") << "symbol " << symbol;
+    }
+    matcher.stop();
+    journal.stop();
+    std::filesystem::remove_all(directory);
+}
+
+TEST(PersistenceTests, TestMatchingThreadStopsMatchingWhenJournalFails) {
+    std::string directory = tempDirectory("lob_journal_failure");
+    std::vector<OrderCommand> log = generateCommandLog(1, 5000, 61);
+    Journal journal(directory, Durability::None, 1000 * Journal::recordSize, 1024);
+    journal.start();
+    // A directory where the second segment goes, so the writer fails once
+    // the first is full
+    std::filesystem::create_directories(directory + "/" + journalSegmentName(2));
+    MatchingThread matcher(1024);
+    matcher.setJournal(&journal);
+    matcher.start();
+    for (const OrderCommand& command : log) {
+        matcher.submit(command);
+        // Pace the producer so the failure shows before the log runs out
+        if (command.orderId % 256 == 0) matcher.drain();
+    }
+    matcher.drain();
+    EXPECT_TRUE(matcher.hasJournalFailed());
+    // Every command was either journaled (if not written) or refused
+    EXPECT_GT(matcher.getErrorCount(), 0u);
+    EXPECT_EQ(matcher.getErrorCount() + journal.getAppendedSequence(), log.size());
+    EXPECT_EQ(journal.append(log[0]), 0u);
+    matcher.stop();
+    journal.stop();
+    std::filesystem::remove_all(directory);
+}
+
+namespace {
+    // A matched book with resting stops and stop-limits on both sides
+    void buildSnapshotBook(Book& book, const std::vector<OrderCommand>& log, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            try {
+                applyOrderCommand(book, log[i]);
+            } catch (const std::exception&) {}
+        }
+        int id = 1000000;
+        for (int price = 0; price < 5; ++price) {
+            book.addStopOrder(id++, true, 10 + price, 400 + price);
+            book.addStopOrder(id++, false, 20, 200 - price);
+            book.addStopLimitOrder(id++, true, 30, 420, 400 + price);
+            book.addStopLimitOrder(id++, false, 40, 180, 190 - price);
+        }
+    }
+}
+
+TEST(PersistenceTests, TestBookSnapshotRestoresEveryLadderAndQueue) {
+    std::vector<OrderCommand> log = generateCommandLog(1, 40000, 54);
+    Book book;
+    buildSnapshotBook(book, log, 30000);
+    ASSERT_FALSE(book.getStopBuyLimits().empty());
+    ASSERT_FALSE(book.getStopSellLimits().empty());
+
+    std::string image;
+    size_t bytes = encodeBookSnapshot(book, 30000, image);
+    EXPECT_EQ(bytes, image.size());
+    Book restored;
+    uint64_t sequence = 0;
+    ASSERT_TRUE(decodeBookSnapshot(image, restored, sequence));
+    EXPECT_EQ(sequence, 30000u);
+    EXPECT_EQ(compareBooks(book, restored), "");
+    // Every field is in the image, so an identical re-encoding means stop
+    // ladders and stop-limit prices came back as well
+    std::string again;
+    encodeBookSnapshot(restored, 30000, again);
+    EXPECT_EQ(again, image);
+
+    // Both books carry on identically, so the order index was rebuilt too
+    for (size_t i = 30000; i < log.size(); ++i) {
+        for (Book* target : {&book, &restored}) {
+            try {
+                applyOrderCommand(*target, log[i]);
+            } catch (const std::exception&) {}
+        }
+    }
+    book.cancelStopOrder(1000000);
+    restored.cancelStopOrder(1000000);
+    book.modifyStopLimitOrder(1000002, 5, 425, 405);
+    restored.modifyStopLimitOrder(1000002, 5, 425, 405);
+    std::string left;
+    std::string right;
+    encodeBookSnapshot(book, 0, left);
+    encodeBookSnapshot(restored, 0, right);
+    EXPECT_EQ(left, right);
+}
+
+TEST(PersistenceTests, TestBookSnapshotRejectsCorruptImages) {
+    std::vector<OrderCommand> log = generateCommandLog(1, 5000, 55);
+    Book book;
+    buildSnapshotBook(book, log, log.size());
+    std::string image;
+    encodeBookSnapshot(book, 77, image);
+
+    uint64_t sequence = 0;
+    std::string flipped = image;
+    flipped[image.size() / 2] ^= 0x10;
+    Book corrupt;
+    EXPECT_FALSE(decodeBookSnapshot(flipped, corrupt, sequence));
+    EXPECT_TRUE(corrupt.getBuyLimits().empty());
+    Book truncated;
+    EXPECT_FALSE(decodeBookSnapshot(std::string_view(image).substr(0, image.size() - 1), truncated, sequence));
+    Book nonEmpty;
+    nonEmpty.addLimitOrder(1, true, 10, 100);
+    EXPECT_FALSE(decodeBookSnapshot(image, nonEmpty, sequence));
+
+    // Through a file, replacing an older snapshot
+    std::string directory = tempDirectory("lob_book_snapshot");
+    std::filesystem::create_directories(directory);
+    std::string path = directory + "/book.snap";
+    Book empty;
+    ASSERT_TRUE(writeBookSnapshot(empty, 1, path));
+    ASSERT_TRUE(writeBookSnapshot(book, 77, path));
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+    Book restored;
+    ASSERT_TRUE(readBookSnapshot(path, restored, sequence));
+    EXPECT_EQ(sequence, 77u);
+    EXPECT_EQ(compareBooks(book, restored), "");
+    EXPECT_FALSE(readBookSnapshot(directory + "/missing.snap", restored, sequence));
+    std::filesystem::remove_all(directory);
+}
+
+TEST(PersistenceTests, TestBookSnapshotRestoresStatesLeftByModifies) {
+    Book book;
+    book.addLimitOrder(1, true, 10, 100);
+    book.addLimitOrder(2, false, 10, 110);
+    book.addStopOrder(3, true, 10, 120);
+    book.addStopOrder(4, false, 10, 90);
+    book.addLimitOrder(5, true, 10, 99);
+    // Commands that used to leave orders or levels a restore rejects
+    EXPECT_THROW(book.modifyLimitOrder(1, 0, 100), std::invalid_argument);
+    EXPECT_THROW(book.modifyStopOrder(3, -5, 121), std::invalid_argument);
+    EXPECT_THROW(book.addLimitOrder(2, false, 10, 111), std::invalid_argument);
+    EXPECT_THROW(book.addStopOrder(1, true, 10, 125), std::invalid_argument);
+    // A stop modified as a limit (and a limit as a stop) leaves its old
+    // level empty, which must go
+    book.modifyLimitOrder(3, 10, 98);
+    book.modifyStopOrder(5, 10, 130);
+    EXPECT_TRUE(book.getStopBuyLimits().size() == 1 && book.getStopBuyLimits()[0]->getLimitPrice() == 130);
+    EXPECT_EQ(book.getBuyLimits().size(), 2u);
+
+    std::string image;
+    encodeBookSnapshot(book, 9, image);
+    Book restored;
+    uint64_t sequence = 0;
+    ASSERT_TRUE(decodeBookSnapshot(image, restored, sequence));
+    EXPECT_EQ(compareBooks(book, restored), "");
+    EXPECT_EQ(bookStateHash(restored), bookStateHash(book));
+}
+
+TEST(PersistenceTests, TestRecoveryRestoresSnapshotAndJournalTail) {
+    std::string journalDirectory = tempDirectory("lob_recovery_journal");
+    std::string snapshotDirectory = tempDirectory("lob_recovery_snapshots");
+    const int symbols = 3;
+    std::vector<OrderCommand> log = generateCommandLog(symbols, 30000, 56);
+    {
+        Journal journal(journalDirectory, Durability::None);
+        journal.start();
+        MatchingThread matcher(1024);
+        matcher.setJournal(&journal);
+        matcher.start();
+        matcher.submitBatch(log.data(), 20000);
+        matcher.drain();
+        ASSERT_TRUE(matcher.writeSnapshot(snapshotDirectory));
+        matcher.submitBatch(log.data() + 20000, 10000);
+        matcher.drain();
+        matcher.stop();
+        journal.stop();
+    }
+    std::vector<std::unique_ptr<Book>> expected;
+    for (const OrderCommand& command : log) applyToBooks(expected, command);
+
+    BookRecovery recovery(snapshotDirectory, journalDirectory);
+    EXPECT_EQ(recovery.run(true), log.size());
+    EXPECT_EQ(recovery.getSnapshotSequence(), 20000u);
+    EXPECT_EQ(recovery.getSkippedSnapshots(), 0u);
+    EXPECT_EQ(recovery.getReplayedCount(), 10000u);
+    EXPECT_TRUE(recovery.waitVerified()) << recovery.getMismatch();
+    std::vector<std::unique_ptr<Book>>& books = recovery.getBooks();
+    ASSERT_EQ(books.size(), static_cast<size_t>(symbols));
+    for (int symbol = 0; symbol < symbols; ++symbol) {
+        EXPECT_EQ(bookStateHash(*books[symbol]), bookStateHash(*expected[symbol])) << "symbol " << symbol;
+    }
+
+    // A new matching thread carries on from the recovered books, and the
+    // journal carries on from the recovered sequence
+    std::vector<OrderCommand> more = generateCommandLog(symbols, 2000, 57);
+    for (OrderCommand& command : more) command.orderId += 1000000;
+    Journal journal(journalDirectory, Durability::None);
+    journal.start();
+    EXPECT_EQ(journal.getStartSequence(), log.size());
+    MatchingThread matcher(1024);
+    matcher.restoreBooks(std::move(books));
+    matcher.setJournal(&journal);
+    matcher.start();
+    matcher.submitBatch(more.data(), more.size());
+    matcher.drain();
+    for (const OrderCommand& command : more) applyToBooks(expected, command);
+    for (int symbol = 0; symbol < symbols; ++symbol) {
+        ASSERT_NE(matcher.findBook(symbol), nullptr);
+        EXPECT_EQ(bookStateHash(*matcher.findBook(symbol)), bookStateHash(*expected[symbol])) << "symbol " << symbol;
+    }
+    EXPECT_EQ(journal.getAppendedSequence(), log.size() + more.size());
+    matcher.stop();
+    journal.stop();
+    std::filesystem::remove_all(journalDirectory);
+    std::filesystem::remove_all(snapshotDirectory);
+}
+
+TEST(PersistenceTests, TestRecoverySkipsDamagedSnapshotsAndCatchesDivergence) {
+    std::string journalDirectory = tempDirectory("lob_recovery_bad_journal");
+    std::string snapshotDirectory = tempDirectory("lob_recovery_bad_snapshots");
+    std::vector<OrderCommand> log = generateCommandLog(2, 12000, 58);
+    std::vector<std::unique_ptr<Book>> books;
+    {
+        Journal journal(journalDirectory, Durability::None);
+        journal.start();
+        for (size_t i = 0; i < log.size(); ++i) {
+            journal.append(log[i]);
+            applyToBooks(books, log[i]);
+            if (i + 1 == 5000) {
+                std::vector<const Book*> set{books[0].get(), books[1].get()};
+                ASSERT_TRUE(writeSnapshotSet(snapshotDirectory, 5000, set));
+            }
+        }
+        journal.stop();
+    }
+    // A newer set torn part way through is passed over
+    {
+        std::ofstream torn(snapshotDirectory + "/" + snapshotSetName(9000), std::ios::binary);
+        torn << "LOBM\x01 not a whole snapshot";
+    }
+    BookRecovery recovery(snapshotDirectory, journalDirectory);
+    EXPECT_EQ(recovery.run(true), log.size());
+    EXPECT_EQ(recovery.getSnapshotSequence(), 5000u);
+    EXPECT_EQ(recovery.getSkippedSnapshots(), 1u);
+    EXPECT_TRUE(recovery.waitVerified()) << recovery.getMismatch();
+
+    // A snapshot that does not match the journal is caught
+    std::filesystem::remove_all(snapshotDirectory);
+    Book altered;
+    altered.addLimitOrder(1, true, 10, 250);
+    std::vector<const Book*> set{books[0].get(), &altered};
+    ASSERT_TRUE(writeSnapshotSet(snapshotDirectory, 7000, set));
+    BookRecovery diverged(snapshotDirectory, journalDirectory);
+    diverged.run(true);
+    EXPECT_FALSE(diverged.waitVerified());
+    EXPECT_NE(diverged.getMismatch().find("snapshot at 7000"), std::string::npos) << diverged.getMismatch();
+
+    // Without snapshots the whole journal is replayed
+    std::filesystem::remove_all(snapshotDirectory);
+    BookRecovery fromScratch(snapshotDirectory, journalDirectory);
+    EXPECT_EQ(fromScratch.run(), log.size());
+    EXPECT_EQ(fromScratch.getReplayedCount(), log.size());
+    EXPECT_EQ(bookStateHash(*fromScratch.getBooks()[1]), bookStateHash(*books[1]));
+    std::filesystem::remove_all(journalDirectory);
+}
+
+TEST(PersistenceTests, TestRecoveryStaysInStepWithJournalAfterLostTail) {
+    std::string journalDirectory = tempDirectory("lob_recovery_lost_journal");
+    std::string snapshotDirectory = tempDirectory("lob_recovery_lost_snapshots");
+    const int symbols = 2;
+    std::vector<OrderCommand> log = generateCommandLog(symbols, 25000, 62);
+    {
+        // 1000 records per segment
+        Journal journal(journalDirectory, Durability::None, 1000 * Journal::recordSize);
+        journal.start();
+        MatchingThread matcher(1024);
+        matcher.setJournal(&journal);
+        matcher.start();
+        matcher.submitBatch(log.data(), log.size());
+        matcher.drain();
+        ASSERT_TRUE(matcher.writeSnapshot(snapshotDirectory));
+        matcher.stop();
+        journal.stop();
+    }
+    // Crash before the writer caught up: the snapshot at 25000 reached disk,
+    // the journal only up to 20000
+    for (uint32_t segment = 21; segment <= 30; ++segment) {
+        std::filesystem::remove(journalDirectory + "/" + journalSegmentName(segment));
+    }
+    ASSERT_EQ(lastJournalSequence(journalDirectory), 20000u);
+
+    std::vector<std::unique_ptr<Book>> books;
+    {
+        BookRecovery recovery(snapshotDirectory, journalDirectory);
+        EXPECT_EQ(recovery.run(true), 20000u);
+        EXPECT_EQ(recovery.getAheadSnapshots(), 1u);
+        EXPECT_EQ(recovery.getSnapshotSequence(), 0u);
+        EXPECT_TRUE(recovery.waitVerified()) << recovery.getMismatch();
+        // Passed over, not removed
+        EXPECT_EQ(listSnapshotSets(snapshotDirectory), std::vector<uint64_t>{25000});
+        books = std::move(recovery.getBooks());
+    }
+    {
+        // Without a journal the same set is simply the newest state
+        BookRecovery recovery(snapshotDirectory, tempDirectory("lob_recovery_no_journal"));
+        EXPECT_EQ(recovery.run(), 25000u);
+        EXPECT_EQ(recovery.getAheadSnapshots(), 0u);
+        EXPECT_EQ(recovery.getSnapshotSequence(), 25000u);
+    }
+    // Carry on: the journal numbers from 20001, and fewer commands than the
+    // stale snapshot held come in
+    {
+        Journal journal(journalDirectory, Durability::None, 1000 * Journal::recordSize);
+        journal.start();
+        EXPECT_EQ(journal.getStartSequence(), 20000u);
+        MatchingThread matcher(1024);
+        matcher.restoreBooks(std::move(books));
+        matcher.setJournal(&journal);
+        matcher.start();
+        matcher.submitBatch(log.data() + 20000, 3000);
+        matcher.drain();
+        matcher.stop();
+        journal.stop();
+    }
+
+    BookRecovery recovery(snapshotDirectory, journalDirectory);
+    EXPECT_EQ(recovery.run(true), 23000u);
+    EXPECT_EQ(recovery.getAheadSnapshots(), 1u);
+    EXPECT_TRUE(recovery.waitVerified()) << recovery.getMismatch();
+    std::vector<std::unique_ptr<Book>> expected;
+    for (size_t i = 0; i < 23000; ++i) applyToBooks(expected, log[i]);
+    for (int symbol = 0; symbol < symbols; ++symbol) {
+        EXPECT_EQ(bookStateHash(*recovery.getBooks()[symbol]), bookStateHash(*expected[symbol])) << symbol;
+    }
+    std::filesystem::remove_all(journalDirectory);
+    std::filesystem::remove_all(snapshotDirectory);
+}
+
+TEST(PersistenceTests, TestForkSnapshotKeepsTheBookAsItWasAtTheFork) {
+    std::string directory = tempDirectory("lob_fork_snapshot");
+    std::vector<OrderCommand> log = generateCommandLog(1, 20000, 59);
+    Book book;
+    buildSnapshotBook(book, log, log.size());
+    uint64_t before = bookStateHash(book);
+
+    ForkSnapshot snapshot;
+    std::vector<const Book*> set{&book};
+    ASSERT_TRUE(snapshot.start(directory, 42, set));
+    EXPECT_FALSE(snapshot.start(directory, 43, set) && snapshot.isRunning());
+    // The parent changes the book straight away; the child still sees it
+    // as it was
+    std::vector<Limit*> bids = book.getBuyLimits();
+    for (Limit* level : bids) book.cancelLimitOrder(level->getHeadOrder()->getOrderId());
+    book.addLimitOrder(5000000, true, 1000, 1);
+    EXPECT_TRUE(snapshot.wait());
+    EXPECT_GE(snapshot.getWrittenCount(), 1u);
+    EXPECT_GT(snapshot.getForkNanoseconds(), 0u);
+
+    std::vector<std::unique_ptr<Book>> restored;
+    uint64_t sequence = 0;
+    ASSERT_TRUE(readSnapshotSet(directory + "/" + snapshotSetName(42), restored, sequence));
+    EXPECT_EQ(sequence, 42u);
+    ASSERT_EQ(restored.size(), 1u);
+    EXPECT_EQ(bookStateHash(*restored[0]), before);
+    EXPECT_NE(bookStateHash(book), before);
+    std::filesystem::remove_all(directory);
+}
+
+TEST(PersistenceTests, TestMatchingThreadForkSnapshotRecovers) {
+    std::string journalDirectory = tempDirectory("lob_fork_recovery_journal");
+    std::string snapshotDirectory = tempDirectory("lob_fork_recovery_snapshots");
+    const int symbols = 3;
+    std::vector<OrderCommand> log = generateCommandLog(symbols, 30000, 60);
+    {
+        Journal journal(journalDirectory, Durability::None);
+        journal.start();
+        MatchingThread matcher(1024);
+        matcher.setJournal(&journal);
+        matcher.start();
+        matcher.submitBatch(log.data(), 20000);
+        EXPECT_TRUE(matcher.requestSnapshot(snapshotDirectory));
+        matcher.submitBatch(log.data() + 20000, 10000);
+        matcher.drain();
+        matcher.stop();
+        EXPECT_EQ(matcher.getSnapshotsWritten(), 1u);
+        journal.stop();
+    }
+    std::vector<uint64_t> sets = listSnapshotSets(snapshotDirectory);
+    ASSERT_EQ(sets.size(), 1u);
+    EXPECT_GE(sets[0], 20000u);
+
+    BookRecovery recovery(snapshotDirectory, journalDirectory);
+    EXPECT_EQ(recovery.run(true), log.size());
+    EXPECT_EQ(recovery.getSnapshotSequence(), sets[0]);
+    EXPECT_TRUE(recovery.waitVerified()) << recovery.getMismatch();
+    std::filesystem::remove_all(journalDirectory);
+    std::filesystem::remove_all(snapshotDirectory);
+}